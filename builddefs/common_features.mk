@@ -339,6 +339,7 @@ ifeq ($(strip $(RGBLIGHT_ENABLE)), yes)
     endif
 
     ifeq ($(strip $(RGBLIGHT_DRIVER)), WS2812)
+        OPT_DEFS += -DRGBLIGHT_WS2812
         WS2812_DRIVER_REQUIRED := yes
     endif
 
@@ -700,7 +701,12 @@ ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
         ifeq ($(strip $(SERIAL_DRIVER)), bitbang)
             QUANTUM_LIB_SRC += serial.c
         else
-            QUANTUM_LIB_SRC += serial_protocol.c
+            ifeq ($(strip $(SERIAL_STREAMING)), yes)
+                OPT_DEFS += -DSERIAL_STREAMING
+                QUANTUM_LIB_SRC += serial_stream.c
+            else
+                QUANTUM_LIB_SRC += serial_protocol.c
+            endif
             QUANTUM_LIB_SRC += serial_$(strip $(SERIAL_DRIVER)).c
         endif
     endif
@@ -5,6 +5,11 @@
 
 #    include "spi_master.h"
 #    include "qp_comms_spi.h"
+#    include "qp_draw.h"
+
+#    if QUANTUM_PAINTER_SPI_ASYNC && !defined(PROTOCOL_CHIBIOS)
+#        error "QUANTUM_PAINTER_SPI_ASYNC is only supported on ChibiOS"
+#    endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Base SPI support
@@ -31,6 +36,16 @@ bool qp_comms_spi_start(painter_device_t device) {
 }
 
 uint32_t qp_comms_spi_send_data(painter_device_t device, const void *data, uint32_t byte_count) {
+#    if QUANTUM_PAINTER_SPI_ASYNC
+    // Pixel data goes out in the background whilst the next block is prepared in the other pixdata buffer. Anything
+    // else, such as command parameters on the stack, is sent synchronously.
+    if (qp_internal_is_pixdata_buffer(data)) {
+        spi_transmit_async(data, byte_count);
+        qp_internal_pixdata_in_flight(data);
+        return byte_count;
+    }
+#    endif // QUANTUM_PAINTER_SPI_ASYNC
+
     uint32_t       bytes_remaining = byte_count;
     const uint8_t *p               = (const uint8_t *)data;
     while (bytes_remaining > 0) {
@@ -98,6 +113,10 @@ uint32_t qp_comms_spi_dc_reset_send_data(painter_device_t device, const void *da
 void qp_comms_spi_dc_reset_send_command(painter_device_t device, uint8_t cmd) {
     struct painter_driver_t *              driver       = (struct painter_driver_t *)device;
     struct qp_comms_spi_dc_reset_config_t *comms_config = (struct qp_comms_spi_dc_reset_config_t *)driver->comms_config;
+#    if QUANTUM_PAINTER_SPI_ASYNC
+    // Pixel data in flight needs to finish before D/C changes
+    spi_wait();
+#    endif // QUANTUM_PAINTER_SPI_ASYNC
     writePinLow(comms_config->dc_pin);
     spi_write(cmd);
 }
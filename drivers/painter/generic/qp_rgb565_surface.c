@@ -7,6 +7,14 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Common
 
+// A dirty region of a surface, inclusive on all sides
+typedef struct rgb565_surface_dirty_rect_t {
+    uint16_t l;
+    uint16_t t;
+    uint16_t r;
+    uint16_t b;
+} rgb565_surface_dirty_rect_t;
+
 // Device definition
 typedef struct rgb565_surface_painter_device_t {
     struct painter_driver_t base; // must be first, so it can be cast to/from the painter_device_t* type
@@ -24,18 +32,99 @@ typedef struct rgb565_surface_painter_device_t {
     uint16_t pixdata_x;
     uint16_t pixdata_y;
 
-    // Maintain a dirty region so we can stream only what we need
-    bool     is_dirty;
-    uint16_t dirty_l;
-    uint16_t dirty_t;
-    uint16_t dirty_r;
-    uint16_t dirty_b;
+    // Maintain a list of dirty regions so we can stream only what we need
+    uint8_t                     dirty_count;
+    uint8_t                     dirty_last; // the region most recently touched, checked first
+    rgb565_surface_dirty_rect_t dirty[RGB565_SURFACE_DIRTY_RECTS];
 
+    // Display that qp_flush() copies the dirty regions to, if any
+    painter_device_t flush_target;
+    uint16_t         flush_target_x;
+    uint16_t         flush_target_y;
 } rgb565_surface_painter_device_t;
 
 // Driver storage
 rgb565_surface_painter_device_t surface_drivers[RGB565_SURFACE_NUM_DEVICES] = {0};
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Dirty region tracking
+
+static inline uint32_t dirty_rect_area(uint16_t l, uint16_t t, uint16_t r, uint16_t b) {
+    return ((uint32_t)(r - l + 1)) * (b - t + 1);
+}
+
+// Checks if the two regions overlap, or are close enough that sending them together is cheaper
+static inline bool dirty_rects_near(const rgb565_surface_dirty_rect_t *a, const rgb565_surface_dirty_rect_t *b) {
+    return a->l <= b->r + RGB565_SURFACE_DIRTY_MERGE_DISTANCE && b->l <= a->r + RGB565_SURFACE_DIRTY_MERGE_DISTANCE && a->t <= b->b + RGB565_SURFACE_DIRTY_MERGE_DISTANCE && b->t <= a->b + RGB565_SURFACE_DIRTY_MERGE_DISTANCE;
+}
+
+static inline void dirty_rect_union(rgb565_surface_dirty_rect_t *target, const rgb565_surface_dirty_rect_t *other) {
+    target->l = QP_MIN(target->l, other->l);
+    target->t = QP_MIN(target->t, other->t);
+    target->r = QP_MAX(target->r, other->r);
+    target->b = QP_MAX(target->b, other->b);
+}
+
+static void mark_dirty_slow(rgb565_surface_painter_device_t *surface, uint16_t x, uint16_t y) {
+    rgb565_surface_dirty_rect_t pixel = {.l = x, .t = y, .r = x, .b = y};
+
+    // Find the region which grows the least by including this pixel
+    uint8_t  best      = 0;
+    uint32_t best_cost = UINT32_MAX;
+    for (uint8_t i = 0; i < surface->dirty_count; ++i) {
+        rgb565_surface_dirty_rect_t *rect = &surface->dirty[i];
+        uint32_t                     cost = dirty_rect_area(QP_MIN(rect->l, x), QP_MIN(rect->t, y), QP_MAX(rect->r, x), QP_MAX(rect->b, y)) - dirty_rect_area(rect->l, rect->t, rect->r, rect->b);
+        if (cost < best_cost) {
+            best      = i;
+            best_cost = cost;
+        }
+    }
+
+    // Start a new region if the pixel isn't near any existing one and there's space left
+    if (surface->dirty_count == 0 || (surface->dirty_count < RGB565_SURFACE_DIRTY_RECTS && !dirty_rects_near(&surface->dirty[best], &pixel))) {
+        surface->dirty_last                      = surface->dirty_count;
+        surface->dirty[surface->dirty_count++] = pixel;
+        return;
+    }
+
+    dirty_rect_union(&surface->dirty[best], &pixel);
+    surface->dirty_last = best;
+
+    // The grown region may now touch others, fold them in so nothing is sent twice
+    for (uint8_t i = 0; i < surface->dirty_count;) {
+        if (i != surface->dirty_last && dirty_rects_near(&surface->dirty[surface->dirty_last], &surface->dirty[i])) {
+            dirty_rect_union(&surface->dirty[surface->dirty_last], &surface->dirty[i]);
+            surface->dirty[i] = surface->dirty[--surface->dirty_count];
+            if (surface->dirty_last == surface->dirty_count) {
+                surface->dirty_last = i;
+            }
+            i = 0;
+        } else {
+            ++i;
+        }
+    }
+}
+
+static inline void mark_dirty(rgb565_surface_painter_device_t *surface, uint16_t x, uint16_t y) {
+    // Most writes land next to the previous one, so check the last region touched before anything else
+    rgb565_surface_dirty_rect_t *last = &surface->dirty[surface->dirty_last];
+    if (surface->dirty_count > 0 && x >= last->l && x <= last->r && y >= last->t && y <= last->b) {
+        return;
+    }
+    mark_dirty_slow(surface, x, y);
+}
+
+static inline void mark_all_dirty(rgb565_surface_painter_device_t *surface) {
+    surface->dirty_count = 1;
+    surface->dirty_last  = 0;
+    surface->dirty[0]    = (rgb565_surface_dirty_rect_t){.l = 0, .t = 0, .r = surface->base.panel_width - 1, .b = surface->base.panel_height - 1};
+}
+
+static inline void clear_dirty(rgb565_surface_painter_device_t *surface) {
+    surface->dirty_count = 0;
+    surface->dirty_last  = 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Helpers
 
@@ -58,22 +147,8 @@ static inline void increment_pixdata_location(rgb565_surface_painter_device_t *s
 static inline void setpixel(rgb565_surface_painter_device_t *surface, uint16_t x, uint16_t y, uint16_t rgb565) {
     // Skip messing with the dirty info if the original value already matches
     if (surface->buffer[y * surface->base.panel_width + x] != rgb565) {
-        // Maintain dirty region
-        if (surface->dirty_l > x) {
-            surface->dirty_l = x;
-        }
-        if (surface->dirty_r < x) {
-            surface->dirty_r = x;
-        }
-        if (surface->dirty_t > y) {
-            surface->dirty_t = y;
-        }
-        if (surface->dirty_b < y) {
-            surface->dirty_b = y;
-        }
-
-        // Always dirty after a setpixel
-        surface->is_dirty = true;
+        // Maintain dirty regions
+        mark_dirty(surface, x, y);
 
         // Update the pixel data in the buffer
         surface->buffer[y * surface->base.panel_width + x] = rgb565;
@@ -98,6 +173,9 @@ static bool qp_rgb565_surface_init(painter_device_t device, painter_rotation_t r
     struct painter_driver_t *        driver  = (struct painter_driver_t *)device;
     rgb565_surface_painter_device_t *surface = (rgb565_surface_painter_device_t *)driver;
     memset(surface->buffer, 0, driver->panel_width * driver->panel_height * driver->native_bits_per_pixel / 8);
+
+    // Whatever the target display shows no longer matches
+    mark_all_dirty(surface);
     return true;
 }
 
@@ -112,12 +190,17 @@ static bool qp_rgb565_surface_clear(painter_device_t device) {
     return true;
 }
 
+static bool qp_rgb565_surface_draw_dirty(rgb565_surface_painter_device_t *surface, painter_device_t display, uint16_t x, uint16_t y);
+
 static bool qp_rgb565_surface_flush(painter_device_t device) {
     struct painter_driver_t *        driver  = (struct painter_driver_t *)device;
     rgb565_surface_painter_device_t *surface = (rgb565_surface_painter_device_t *)driver;
-    surface->dirty_l = surface->dirty_t = UINT16_MAX;
-    surface->dirty_r = surface->dirty_b = 0;
-    surface->is_dirty                   = false;
+    if (surface->flush_target) {
+        if (!qp_rgb565_surface_draw_dirty(surface, surface->flush_target, surface->flush_target_x, surface->flush_target_y) || !qp_flush(surface->flush_target)) {
+            return false;
+        }
+    }
+    clear_dirty(surface);
     return true;
 }
 
@@ -233,39 +316,30 @@ painter_device_t qp_rgb565_make_surface(uint16_t panel_width, uint16_t panel_hei
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Drawing routine to copy out the dirty region and send it to another device
 
-bool qp_rgb565_surface_draw(painter_device_t surface, painter_device_t display, uint16_t x, uint16_t y) {
-    struct painter_driver_t *        surface_driver = (struct painter_driver_t *)surface;
-    rgb565_surface_painter_device_t *surface_handle = (rgb565_surface_painter_device_t *)surface_driver;
-
-    // If we're not dirty... we're done.
-    if (!surface_handle->is_dirty) {
-        return true;
-    }
-
+static bool qp_rgb565_surface_draw_rect(rgb565_surface_painter_device_t *surface, painter_device_t display, uint16_t x, uint16_t y, const rgb565_surface_dirty_rect_t *rect) {
     // Set the target drawing area
-    bool ok = qp_viewport(display, x + surface_handle->dirty_l, y + surface_handle->dirty_t, x + surface_handle->dirty_r, y + surface_handle->dirty_b);
-    if (!ok) {
+    if (!qp_viewport(display, x + rect->l, y + rect->t, x + rect->r, y + rect->b)) {
         return false;
     }
 
-    // Housekeeping of the amount of pixels to transfer
-    uint32_t  total_pixel_count = QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE / sizeof(uint16_t);
-    uint32_t  pixel_counter     = 0;
-    uint16_t *target_buffer     = (uint16_t *)qp_internal_global_pixdata_buffer;
+    // Copy each row of the region into the global pixdata area, sending it whenever it fills up
+    uint32_t total_pixel_count = QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE / sizeof(uint16_t);
+    uint32_t pixel_counter     = 0;
+    for (uint16_t row = rect->t; row <= rect->b; ++row) {
+        const uint16_t *source    = &surface->buffer[row * surface->base.panel_width + rect->l];
+        uint32_t        remaining = rect->r - rect->l + 1;
+        while (remaining > 0) {
+            uint32_t count = QP_MIN(remaining, total_pixel_count - pixel_counter);
+            memcpy(&((uint16_t *)qp_internal_global_pixdata_buffer)[pixel_counter], source, count * sizeof(uint16_t));
+            pixel_counter += count;
+            source += count;
+            remaining -= count;
 
-    // Fill the global pixdata area so that we can start transferring to the panel
-    for (uint16_t y = surface_handle->dirty_t; y <= surface_handle->dirty_b; ++y) {
-        for (uint16_t x = surface_handle->dirty_l; x <= surface_handle->dirty_r; ++x) {
-            // Update the target buffer
-            target_buffer[pixel_counter++] = surface_handle->buffer[y * surface_handle->base.panel_width + x];
-
-            // If we've accumulated enough data, send it
             if (pixel_counter == total_pixel_count) {
-                ok = qp_pixdata(display, qp_internal_global_pixdata_buffer, pixel_counter);
-                if (!ok) {
+                // The buffer may be swapped out afterwards if it's still being transmitted, so always index the global
+                if (!qp_pixdata(display, qp_internal_global_pixdata_buffer, pixel_counter)) {
                     return false;
                 }
-                // Reset the counter
                 pixel_counter = 0;
             }
         }
@@ -273,12 +347,45 @@ bool qp_rgb565_surface_draw(painter_device_t surface, painter_device_t display,
 
     // If there's any leftover data, send it
     if (pixel_counter > 0) {
-        ok = qp_pixdata(display, qp_internal_global_pixdata_buffer, pixel_counter);
-        if (!ok) {
+        return qp_pixdata(display, qp_internal_global_pixdata_buffer, pixel_counter);
+    }
+    return true;
+}
+
+static bool qp_rgb565_surface_draw_dirty(rgb565_surface_painter_device_t *surface, painter_device_t display, uint16_t x, uint16_t y) {
+    for (uint8_t i = 0; i < surface->dirty_count; ++i) {
+        if (!qp_rgb565_surface_draw_rect(surface, display, x, y, &surface->dirty[i])) {
             return false;
         }
     }
+    return true;
+}
+
+bool qp_rgb565_surface_draw(painter_device_t surface, painter_device_t display, uint16_t x, uint16_t y) {
+    struct painter_driver_t *        surface_driver = (struct painter_driver_t *)surface;
+    rgb565_surface_painter_device_t *surface_handle = (rgb565_surface_painter_device_t *)surface_driver;
+
+    if (!qp_rgb565_surface_draw_dirty(surface_handle, display, x, y)) {
+        return false;
+    }
 
     // Clear the dirty info for the surface
-    return qp_flush(surface);
+    clear_dirty(surface_handle);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Flushing directly to another device
+
+bool qp_rgb565_surface_set_flush_target(painter_device_t surface, painter_device_t display, uint16_t x, uint16_t y) {
+    struct painter_driver_t *        surface_driver = (struct painter_driver_t *)surface;
+    rgb565_surface_painter_device_t *surface_handle = (rgb565_surface_painter_device_t *)surface_driver;
+    if (display == surface) {
+        return false;
+    }
+
+    surface_handle->flush_target   = display;
+    surface_handle->flush_target_x = x;
+    surface_handle->flush_target_y = y;
+    return true;
 }
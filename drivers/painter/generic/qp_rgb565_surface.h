@@ -13,6 +13,23 @@
 #    define RGB565_SURFACE_NUM_DEVICES 1
 #endif
 
+#ifndef RGB565_SURFACE_DIRTY_RECTS
+/**
+ * @def This controls the maximum number of separate dirty regions each surface tracks. Changes further apart than
+ *      \ref RGB565_SURFACE_DIRTY_MERGE_DISTANCE start a new region until these run out, after which the region needing
+ *      the least growth absorbs them.
+ */
+#    define RGB565_SURFACE_DIRTY_RECTS 4
+#endif
+
+#ifndef RGB565_SURFACE_DIRTY_MERGE_DISTANCE
+/**
+ * @def This controls how many pixels apart two dirty regions can be before they are sent separately. Each region costs
+ *      a viewport command when transferred, so nearby regions are cheaper to send together.
+ */
+#    define RGB565_SURFACE_DIRTY_MERGE_DISTANCE 8
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Forward declarations
 
@@ -39,4 +56,15 @@ painter_device_t qp_rgb565_make_surface(uint16_t panel_width, uint16_t panel_hei
  * @return whether the draw operation completed successfully
  */
 bool qp_rgb565_surface_draw(painter_device_t surface, painter_device_t display, uint16_t x, uint16_t y);
+
+/**
+ * Sets a display that qp_flush() on the surface copies the dirty contents to, followed by a flush of the display.
+ *
+ * @param surface[in] the surface to copy from
+ * @param display[in] the display to copy into, or NULL to only reset the dirty area on flush
+ * @param x[in] the x-location of the original position of the framebuffer
+ * @param y[in] the y-location of the original position of the framebuffer
+ * @return whether the target was accepted
+ */
+bool qp_rgb565_surface_set_flush_target(painter_device_t surface, painter_device_t display, uint16_t x, uint16_t y);
 #endif // QUANTUM_PAINTER_RGB565_SURFACE_ENABLE
@@ -28,6 +28,11 @@ void soft_serial_target_init(void);
 
 bool soft_serial_transaction(int sstd_index);
 
+#ifdef SERIAL_STREAMING
+// target sends whatever changed since the last call
+void soft_serial_target_publish(void);
+#endif
+
 #ifdef SERIAL_DEBUG
 #    include <debug.h>
 #    include <print.h>
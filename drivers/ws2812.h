@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include "quantum/color.h"
 
 /*
@@ -74,3 +75,9 @@
  *         - Wait 50us to reset the LEDs
  */
 void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds);
+
+/* Returns true while the data from a previous ws2812_setleds() call is still
+ * being transferred in the background. Drivers which send synchronously always
+ * return false.
+ */
+bool ws2812_busy(void);
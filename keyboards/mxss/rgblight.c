@@ -824,39 +824,51 @@ uint8_t rgblight_get_change_flags(void) { return rgblight_status.change_flags; }
 void rgblight_clear_change_flags(void) { rgblight_status.change_flags = 0; }
 
 void rgblight_get_syncinfo(rgblight_syncinfo_t *syncinfo) {
-    syncinfo->config = rgblight_config;
-    syncinfo->status = rgblight_status;
+    syncinfo->change_flags  = rgblight_status.change_flags;
+    syncinfo->enable        = rgblight_config.enable;
+    syncinfo->mode          = rgblight_config.mode;
+    syncinfo->hue           = rgblight_config.hue;
+    syncinfo->sat           = rgblight_config.sat;
+    syncinfo->val           = rgblight_config.val;
+    syncinfo->timer_enabled = rgblight_status.timer_enabled;
+#    ifdef RGBLIGHT_USE_TIMER
+    syncinfo->anim_timer = animation_status.last_timer;
+    syncinfo->anim_pos   = animation_status.pos16;
+#    endif
+#    ifdef RGBLIGHT_LAYERS
+    syncinfo->enabled_layer_mask = rgblight_status.enabled_layer_mask;
+#    endif
 }
 
 /* for split keyboard slave side */
 void rgblight_update_sync(rgblight_syncinfo_t *syncinfo, bool write_to_eeprom) {
 #    ifdef RGBLIGHT_LAYERS
-    if (syncinfo->status.change_flags & RGBLIGHT_STATUS_CHANGE_LAYERS) {
-        rgblight_status.enabled_layer_mask = syncinfo->status.enabled_layer_mask;
+    if (syncinfo->change_flags & RGBLIGHT_STATUS_CHANGE_LAYERS) {
+        rgblight_status.enabled_layer_mask = syncinfo->enabled_layer_mask;
     }
 #    endif
-    if (syncinfo->status.change_flags & RGBLIGHT_STATUS_CHANGE_MODE) {
-        if (syncinfo->config.enable) {
+    if (syncinfo->change_flags & RGBLIGHT_STATUS_CHANGE_MODE) {
+        if (syncinfo->enable) {
             rgblight_config.enable = 1;  // == rgblight_enable_noeeprom();
-            rgblight_mode_eeprom_helper(syncinfo->config.mode, write_to_eeprom);
+            rgblight_mode_eeprom_helper(syncinfo->mode, write_to_eeprom);
         } else {
             rgblight_disable_noeeprom();
         }
     }
-    if (syncinfo->status.change_flags & RGBLIGHT_STATUS_CHANGE_HSVS) {
-        rgblight_sethsv_eeprom_helper(syncinfo->config.hue, syncinfo->config.sat, syncinfo->config.val, write_to_eeprom);
+    if (syncinfo->change_flags & RGBLIGHT_STATUS_CHANGE_HSVS) {
+        rgblight_sethsv_eeprom_helper(syncinfo->hue, syncinfo->sat, syncinfo->val, write_to_eeprom);
         // rgblight_config.speed = config->speed; // NEED???
     }
 #    ifdef RGBLIGHT_USE_TIMER
-    if (syncinfo->status.change_flags & RGBLIGHT_STATUS_CHANGE_TIMER) {
-        if (syncinfo->status.timer_enabled) {
+    if (syncinfo->change_flags & RGBLIGHT_STATUS_CHANGE_TIMER) {
+        if (syncinfo->timer_enabled) {
             rgblight_timer_enable();
         } else {
             rgblight_timer_disable();
         }
     }
 #        ifndef RGBLIGHT_SPLIT_NO_ANIMATION_SYNC
-    if (syncinfo->status.change_flags & RGBLIGHT_STATUS_ANIMATION_TICK) {
+    if (syncinfo->change_flags & RGBLIGHT_STATUS_ANIMATION_TICK) {
         animation_status.restart = true;
     }
 #        endif /* RGBLIGHT_SPLIT_NO_ANIMATION_SYNC */
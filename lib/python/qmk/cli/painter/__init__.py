@@ -1,2 +1,3 @@
 from . import convert_graphics
+from . import flash_image
 from . import make_font
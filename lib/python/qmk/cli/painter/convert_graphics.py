@@ -14,6 +14,7 @@ from PIL import Image
 @cli.argument('-o', '--output', default='', help='Specify output directory. Defaults to same directory as input.')
 @cli.argument('-f', '--format', required=True, help='Output format, valid types: %s' % (', '.join(valid_formats.keys())))
 @cli.argument('-r', '--no-rle', arg_only=True, action='store_true', help='Disables the use of RLE when encoding images.')
+@cli.argument('-z', '--no-lz', arg_only=True, action='store_true', help='Disables the use of LZ when encoding images.')
 @cli.argument('-d', '--no-deltas', arg_only=True, action='store_true', help='Disables the use of delta frames when encoding animations.')
 @cli.argument('-w', '--raw', arg_only=True, action='store_true', help='Writes out the QGF file as raw data instead of c/h combo.')
 @cli.subcommand('Converts an input image to something QMK understands')
@@ -51,9 +52,20 @@ def painter_convert_graphics(cli):
 
     # Convert the image to QGF using PIL
     out_data = BytesIO()
-    input_img.save(out_data, "QGF", use_deltas=(not cli.args.no_deltas), use_rle=(not cli.args.no_rle), qmk_format=format, verbose=cli.args.verbose)
+    stats = {}
+    input_img.save(out_data, "QGF", use_deltas=(not cli.args.no_deltas), use_rle=(not cli.args.no_rle), use_lz=(not cli.args.no_lz), qmk_format=format, verbose=cli.args.verbose, stats=stats)
     out_bytes = out_data.getvalue()
 
+    # Report how well each compression scheme did. The firmware decodes each run with a single memset() or memcpy(), so
+    # the more bytes per run, the faster the image draws.
+    raw_bytes = stats[0x00]['bytes']
+    for scheme, name in ((0x01, 'RLE'), (0x02, 'LZ')):
+        if scheme in stats:
+            scheme_bytes = stats[scheme]['bytes']
+            cli.log.info(f'{name:>4}: {scheme_bytes:>7} bytes, {raw_bytes / max(scheme_bytes, 1):5.2f}x smaller, {raw_bytes / max(stats[scheme]["runs"], 1):6.1f} bytes decoded per run')
+    chosen = ', '.join(f'{stats[scheme]["frames"]} {name}' for scheme, name in ((0x00, 'raw'), (0x01, 'RLE'), (0x02, 'LZ')) if scheme in stats and stats[scheme]['frames'] > 0)
+    cli.log.info(f'Pixel data {raw_bytes} bytes, stored in {stats["chosen_bytes"]} bytes ({raw_bytes / max(stats["chosen_bytes"], 1):.2f}x smaller) as {chosen} frames')
+
     if cli.args.raw:
         raw_file = cli.args.output / (cli.args.input.stem + ".qgf")
         with open(raw_file, 'wb') as raw:
@@ -0,0 +1,69 @@
+"""This script packs QGF and QFF files into an image for external SPI flash.
+"""
+import re
+import datetime
+from qmk.path import normpath
+from qmk.painter import render_license, render_flash_header, pack_flash_image
+from milc import cli
+
+
+@cli.argument('-o', '--output', required=True, help='Specify output flash image file.')
+@cli.argument('-a', '--align', type=int, default=256, help='Alignment of each asset within the flash, in bytes. Default 256.')
+@cli.argument('-b', '--base-address', default='0', help='Address the flash image will be written to. Default 0.')
+@cli.argument('-s', '--size', default='0', help='Size of the external flash in bytes, to check the assets fit. Default unchecked.')
+@cli.argument('inputs', nargs='+', arg_only=True, type=normpath, help='QGF and QFF files to pack, as written by the --raw option of the conversion commands.')
+@cli.subcommand('Packs QGF images and QFF fonts into an image for external flash')
+def painter_make_flash_image(cli):
+    """Packs QGF images and QFF fonts into a single binary to be written to external SPI flash.
+
+    A header is written next to the output, with the address of each asset for use with `qp_load_image_flash()` and `qp_load_font_flash()`.
+    """
+    base_address = int(cli.args.base_address, 0)
+    flash_size = int(cli.args.size, 0)
+
+    # Read in all the assets
+    assets = []
+    for input_file in cli.args.inputs:
+        if not input_file.exists():
+            cli.log.error(f'Input file {input_file} does not exist!')
+            return False
+        assets.append((input_file, input_file.read_bytes()))
+
+    try:
+        packed, layout = pack_flash_image(assets, cli.args.align, base_address)
+    except ValueError as e:
+        cli.log.error(str(e))
+        return False
+
+    if flash_size > 0 and base_address + len(packed) > flash_size:
+        cli.log.error(f'Assets need {base_address + len(packed)} bytes of flash, only {flash_size} available!')
+        return False
+
+    # One pair of defines per asset, named after the file and its type
+    defines = []
+    for input_file, address, length in layout:
+        kind = 'GFX' if input_file.suffix.lower() == '.qgf' else 'FONT'
+        sane_name = re.sub(r"[^a-zA-Z0-9]", "_", input_file.stem).upper()
+        defines.append(f'#define QP_FLASH_{kind}_{sane_name} 0x{address:08X}')
+        defines.append(f'#define QP_FLASH_{kind}_{sane_name}_LENGTH {length}')
+        cli.log.info(f'0x{address:08X} {length:>8} {input_file.name}')
+
+    output_file = normpath(cli.args.output)
+    subs = {
+        'generated_type': 'each asset',
+        'generator_command': f'qmk painter-make-flash-image -o {output_file.name} ' + ' '.join(f.name for f in cli.args.inputs),
+        'year': datetime.date.today().strftime("%Y"),
+        'defines': '\n'.join(defines),
+    }
+    subs.update({'license': render_license(subs)})
+
+    with open(output_file, 'wb') as image:
+        print(f"Writing {output_file}...")
+        image.write(packed)
+
+    header_file = output_file.with_suffix('.h')
+    with open(header_file, 'w') as header:
+        print(f"Writing {header_file}...")
+        header.write(render_flash_header(subs))
+
+    cli.log.info(f'{len(layout)} assets, {len(packed)} bytes from 0x{base_address:08X}')
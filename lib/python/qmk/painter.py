@@ -138,6 +138,55 @@ def render_bytes(bytes, newline_after=16):
     return lines.rstrip()
 
 
+flash_header_file_template = """\
+${license}
+#pragma once
+
+// Addresses of each asset within external flash, for use with qp_load_image_flash() and qp_load_font_flash()
+${defines}
+"""
+
+
+def render_flash_header(subs):
+    header_txt = Template(flash_header_file_template)
+    return header_txt.substitute(subs)
+
+
+def asset_total_size(data):
+    """Returns the total size recorded in a QGF or QFF file's descriptor, or None if it isn't one.
+    """
+    if len(data) < 17 or data[5:8] not in (b'QGF', b'QFF'):
+        return None
+    total_size = int.from_bytes(data[9:13], 'little')
+    neg_total_size = int.from_bytes(data[13:17], 'little')
+    if total_size != (~neg_total_size & 0xFFFFFFFF):
+        return None
+    return total_size
+
+
+def pack_flash_image(assets, align=256, base_address=0):
+    """Lays out QGF/QFF assets one after the other for writing to external flash.
+
+    Each asset starts on a multiple of `align` bytes from the start of the flash, with the gaps filled with 0xFF to
+    match erased flash. Returns the packed bytes and a list of (name, address, length) tuples.
+    """
+    if align <= 0 or (align & (align - 1)) != 0:
+        raise ValueError("Alignment must be a power of two.")
+    if base_address % align != 0:
+        raise ValueError("Base address must be a multiple of the alignment.")
+
+    packed = bytearray()
+    layout = []
+    for name, data in assets:
+        if asset_total_size(data) != len(data):
+            raise ValueError(f"{name} is not a valid QGF or QFF file.")
+        padding = (-len(packed)) % align
+        packed += b'\xFF' * padding
+        layout.append((name, base_address + len(packed), len(data)))
+        packed += data
+    return bytes(packed), layout
+
+
 def clean_output(str):
     str = re.sub(r'\r', '', str)
     str = re.sub(r'[\n]{3,}', r'\n\n', str)
@@ -336,3 +385,110 @@ def compress_bytes_qmk_rle(bytearray):
                 temp = []
                 repeat = False
     return output
+
+
+def compress_bytes_qmk_lz(bytearray):
+    """Compresses bytes using QMK LZ, see docs/quantum_painter_lz.md.
+
+    Greedy matching of at least 3 bytes, up to 256 bytes back -- the window the firmware keeps while decoding.
+    """
+    window = 256
+    min_match = 3
+    max_candidates = 16
+    output = []
+    chains = {}
+    literal_start = 0
+
+    def append_length(length):
+        while length >= 255:
+            output.append(255)
+            length -= 255
+        output.append(length)
+
+    def append_sequence(literal_end, match_length, offset):
+        literals = literal_end - literal_start
+        match_nibble = match_length - 2 if match_length > 0 else 0
+        output.append((min(literals, 15) << 4) | min(match_nibble, 15))
+        if literals >= 15:
+            append_length(literals - 15)
+        output.extend(bytearray[literal_start:literal_end])
+        if match_length > 0:
+            output.append(offset - 1)
+            if match_nibble >= 15:
+                append_length(match_nibble - 15)
+
+    def remember(pos):
+        chain = chains.setdefault(bytes(bytearray[pos:pos + min_match]), [])
+        chain.append(pos)
+        if len(chain) > 2 * max_candidates:
+            del chain[:-max_candidates]
+
+    n = 0
+    while n < len(bytearray):
+        best_length = 0
+        best_offset = 0
+        if n + min_match <= len(bytearray):
+            for candidate in reversed(chains.get(bytes(bytearray[n:n + min_match]), [])[-max_candidates:]):
+                if n - candidate > window:
+                    break
+                length = min_match
+                while n + length < len(bytearray) and bytearray[candidate + length] == bytearray[n + length]:
+                    length += 1
+                if length > best_length:
+                    best_length = length
+                    best_offset = n - candidate
+
+        if best_length >= min_match:
+            append_sequence(n, best_length, best_offset)
+            for pos in range(n, min(n + best_length, len(bytearray) - min_match + 1)):
+                remember(pos)
+            n += best_length
+            literal_start = n
+        else:
+            if n + min_match <= len(bytearray):
+                remember(n)
+            n += 1
+
+    if literal_start < len(bytearray):
+        append_sequence(len(bytearray), 0, 0)
+    return output
+
+
+def count_runs_qmk_rle(data):
+    """Counts the runs the firmware expands to decode QMK RLE data, each one a single memset() or read.
+    """
+    n = 0
+    runs = 0
+    while n < len(data):
+        marker = data[n]
+        n += 1 + (marker - 127 if marker >= 128 else 1)
+        runs += 1
+    return runs
+
+
+def count_runs_qmk_lz(data):
+    """Counts the runs of literals and matches the firmware copies to decode QMK LZ data.
+    """
+    def skip_length(n):
+        while data[n] == 255:
+            n += 1
+        return n + 1
+
+    n = 0
+    runs = 0
+    while n < len(data):
+        token = data[n]
+        n += 1
+        literals = token >> 4
+        if literals == 15:
+            end = skip_length(n)
+            literals += sum(data[n:end])
+            n = end
+        n += literals
+        runs += 1 if literals > 0 else 0
+        if token & 0x0F:
+            n += 1
+            if (token & 0x0F) == 15:
+                n = skip_length(n)
+            runs += 1
+    return runs
@@ -230,12 +230,41 @@ def _save(im, fp, filename):
     verbose = encoderinfo.get("verbose", False)
     use_deltas = encoderinfo.get("use_deltas", True)
     use_rle = encoderinfo.get("use_rle", True)
+    use_lz = encoderinfo.get("use_lz", True)
+    stats = encoderinfo.get("stats", None)
 
     # Helper for inline verbose prints
     def vprint(s):
         if verbose:
             print(s)
 
+    # Helper to compress pixel data with each of the enabled schemes, see qp.h, painter_compression_t
+    def _compress(raw_data):
+        compressed = {0x00: raw_data}
+        if use_rle:
+            compressed[0x01] = qmk.painter.compress_bytes_qmk_rle(raw_data)
+        if use_lz:
+            compressed[0x02] = qmk.painter.compress_bytes_qmk_lz(raw_data)
+        return compressed
+
+    # Helper to pick the smallest, preferring the simplest scheme if there's a tie
+    def _smallest(compressed):
+        return min(compressed.keys(), key=lambda scheme: (len(compressed[scheme]), scheme))
+
+    # Helper to tally up how each scheme fared, for reporting back to the caller
+    def _record_stats(compressed, chosen):
+        if stats is None:
+            return
+        for scheme, data in compressed.items():
+            entry = stats.setdefault(scheme, {'bytes': 0, 'runs': 0, 'frames': 0})
+            entry['bytes'] += len(data)
+            if scheme == 0x01:
+                entry['runs'] += qmk.painter.count_runs_qmk_rle(data)
+            elif scheme == 0x02:
+                entry['runs'] += qmk.painter.count_runs_qmk_lz(data)
+        stats[chosen]['frames'] += 1
+        stats['chosen_bytes'] = stats.get('chosen_bytes', 0) + len(compressed[chosen])
+
     # Helper to iterate through all frames in the input image
     def _for_all_frames(x: FunctionType):
         frame_num = 0
@@ -290,12 +319,11 @@ def _save(im, fp, filename):
         converted = qmk.painter.convert_requested_format(this_frame, format)
         graphic_data = qmk.painter.convert_image_bytes(converted, format)
 
-        # Convert the raw data to RLE-encoded if requested
+        # Compress the raw data if requested
         raw_data = graphic_data[1]
-        if use_rle:
-            rle_data = qmk.painter.compress_bytes_qmk_rle(graphic_data[1])
-        use_raw_this_frame = not use_rle or len(raw_data) <= len(rle_data)
-        image_data = raw_data if use_raw_this_frame else rle_data
+        compressed = _compress(raw_data)
+        compression = _smallest(compressed)
+        image_data = compressed[compression]
 
         # Work out if a delta frame is smaller than injecting it directly
         use_delta_this_frame = False
@@ -319,10 +347,9 @@ def _save(im, fp, filename):
 
                 # Work out how large the delta frame is going to be with compression etc.
                 delta_raw_data = delta_graphic_data[1]
-                if use_rle:
-                    delta_rle_data = qmk.painter.compress_bytes_qmk_rle(delta_graphic_data[1])
-                delta_use_raw_this_frame = not use_rle or len(delta_raw_data) <= len(delta_rle_data)
-                delta_image_data = delta_raw_data if delta_use_raw_this_frame else delta_rle_data
+                delta_compressed = _compress(delta_raw_data)
+                delta_compression = _smallest(delta_compressed)
+                delta_image_data = delta_compressed[delta_compression]
 
                 # If the size of the delta frame (plus delta descriptor) is smaller than the original, use that instead
                 # This ensures that if a non-delta is overall smaller in size, we use that in preference due to flash
@@ -335,8 +362,8 @@ def _save(im, fp, filename):
                     converted = delta_converted
                     graphic_data = delta_graphic_data
                     raw_data = delta_raw_data
-                    rle_data = delta_rle_data
-                    use_raw_this_frame = delta_use_raw_this_frame
+                    compressed = delta_compressed
+                    compression = delta_compression
                     image_data = delta_image_data
                     use_delta_this_frame = True
 
@@ -347,7 +374,7 @@ def _save(im, fp, filename):
         frame_descriptor.is_delta = use_delta_this_frame
         frame_descriptor.is_transparent = False
         frame_descriptor.format = format['image_format_byte']
-        frame_descriptor.compression = 0x00 if use_raw_this_frame else 0x01  # See qp.h, painter_compression_t
+        frame_descriptor.compression = compression  # See qp.h, painter_compression_t
         frame_descriptor.delay = frame.info['duration'] if 'duration' in frame.info else 1000  # If we're not an animation, just pretend we're delaying for 1000ms
         frame_descriptor.write(fp)
 
@@ -380,6 +407,7 @@ def _save(im, fp, filename):
             delta_descriptor.write(fp)
 
         # Write out the data for this frame to the output
+        _record_stats(compressed, compression)
         data_descriptor = QGFFrameDataDescriptorV1()
         data_descriptor.data = image_data
         vprint(f'{f"Frame {idx:3d} data":26s} {fp.tell():5d}d / {fp.tell():04X}h')
@@ -48,6 +48,10 @@ void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds) {
     _delay_us(WS2812_TRST_US);
 }
 
+bool ws2812_busy(void) {
+    return false;
+}
+
 /*
   This routine writes an array of bytes with RGB values to the Dataout pin
   using the fast 800kHz clockless WS2811/2812 protocol.
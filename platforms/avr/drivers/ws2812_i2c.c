@@ -27,3 +27,7 @@ void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) {
 
     i2c_transmit(WS2812_ADDRESS, (uint8_t *)ledarray, sizeof(LED_TYPE) * leds, WS2812_TIMEOUT);
 }
+
+bool ws2812_busy(void) {
+    return false;
+}
@@ -4,6 +4,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <ch.h>
 
 #pragma once
 
@@ -40,6 +41,14 @@ bool __attribute__((nonnull, hot)) serial_transport_receive(uint8_t* destination
  */
 bool __attribute__((nonnull, hot)) serial_transport_receive_blocking(uint8_t* destination, const size_t size);
 
+/**
+ * @brief Blocking receive of size * bytes with an explicit timeout.
+ *
+ * @return true Receive success.
+ * @return false Receive failed, e.g. by timeout or bit errors.
+ */
+bool __attribute__((nonnull, hot)) serial_transport_receive_timeout(uint8_t* destination, const size_t size, const sysinterval_t timeout);
+
 /**
  * @brief Blocking send of buffer with timeout.
  *
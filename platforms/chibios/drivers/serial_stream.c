@@ -0,0 +1,339 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <ch.h>
+#include <string.h>
+
+#include "quantum.h"
+#include "crc.h"
+#include "serial.h"
+#include "serial_usart.h"
+#include "serial_protocol.h"
+#include "synchronization_util.h"
+
+#if !defined(SERIAL_USART_FULL_DUPLEX)
+#    error The streaming serial protocol needs a full-duplex connection, please define SERIAL_USART_FULL_DUPLEX.
+#endif
+
+#ifndef SERIAL_STREAM_KEEPALIVE_MS
+#    define SERIAL_STREAM_KEEPALIVE_MS 10
+#endif // SERIAL_STREAM_KEEPALIVE_MS
+
+#if SERIAL_STREAM_KEEPALIVE_MS >= SERIAL_USART_TIMEOUT
+#    error SERIAL_STREAM_KEEPALIVE_MS has to be shorter than SERIAL_USART_TIMEOUT, or the master treats an idle slave as stalled.
+#endif
+
+/*
+ * Both halves transmit and receive at the same time, so there is no handshake.
+ * Every frame carries one transaction buffer:
+ *
+ *   uint8_t sync      STREAM_SYNC, to find the start of a frame
+ *   uint8_t id        transaction id, or one of the STREAM_ID_ control ids
+ *   uint8_t size      payload size, which has to match the id
+ *   uint8_t check     crc8 over the id and size
+ *   payload           initiator2target buffer towards the slave,
+ *                     target2initiator buffer towards the master
+ *   uint8_t crc8      over the id, size and payload
+ *
+ * The sync byte can also turn up inside a payload or checksum, so a frame is
+ * only accepted once the whole header checks out. Otherwise the receiver
+ * drops the sync byte and looks for the next one.
+ *
+ * After each scan the slave streams the target2initiator buffers which
+ * changed, and a keepalive frame if it sent nothing for
+ * SERIAL_STREAM_KEEPALIVE_MS. A thread on the master writes each into the
+ * shared memory as it arrives, so reading one costs no time on the wire. If
+ * the master receives a damaged frame it asks the slave to resend everything.
+ * Every frame the master sends is answered with that transaction's
+ * target2initiator buffer, which is empty for plain writes, so a lost write
+ * fails the transaction and is retried like on any other transport.
+ */
+
+#define STREAM_SYNC 0xA5
+#define STREAM_HEADER_SIZE 4
+#define STREAM_OVERHEAD (STREAM_HEADER_SIZE + 1)
+#define STREAM_TIMEOUT -1
+#define STREAM_ERROR -2
+
+// Slave to master, sent when the slave had nothing else to send for a while
+#define STREAM_ID_KEEPALIVE 0xFE
+// Master to slave, asks for every target2initiator buffer to be sent again
+#define STREAM_ID_RESYNC 0xFD
+
+static uint8_t stream_tx_frame[STREAM_OVERHEAD + UINT8_MAX];
+static uint8_t stream_rx_frame[STREAM_OVERHEAD + UINT8_MAX];
+static bool    stream_rx_dropped = false;
+
+// Both the receive thread and the main loop send, so frames must not interleave
+static MUTEX_DECL(stream_tx_lock);
+
+// Slave: CRC of each target2initiator buffer as last sent, to spot changes
+static uint8_t       stream_sent_crc[NUM_TOTAL_TRANSACTIONS];
+static uint32_t      stream_last_sent = 0;
+static volatile bool stream_resync    = true;
+
+// Master: written by the receive thread, read by the main loop
+static volatile uint32_t stream_last_frame = 0;
+static volatile uint8_t  stream_reply_id   = 0xFF;
+static BSEMAPHORE_DECL(stream_reply, true);
+
+static uint8_t stream_build_frame(uint8_t id, const uint8_t* payload, uint8_t size) {
+    stream_tx_frame[0] = STREAM_SYNC;
+    stream_tx_frame[1] = id;
+    stream_tx_frame[2] = size;
+    stream_tx_frame[3] = crc8(&stream_tx_frame[1], 2);
+    if (size) {
+        memcpy(&stream_tx_frame[STREAM_HEADER_SIZE], payload, size);
+    }
+    stream_tx_frame[STREAM_HEADER_SIZE + size] = crc8(&stream_tx_frame[1], STREAM_HEADER_SIZE - 1 + size);
+    return size + STREAM_OVERHEAD;
+}
+
+static bool stream_send_control(uint8_t id) {
+    chMtxLock(&stream_tx_lock);
+    bool okay = serial_transport_send(stream_tx_frame, stream_build_frame(id, NULL, 0));
+    chMtxUnlock(&stream_tx_lock);
+    return okay;
+}
+
+/**
+ * @brief Check that the header in stream_rx_frame is one we could have been
+ * sent, rather than a sync byte that happened to turn up inside a payload.
+ */
+static bool stream_header_valid(bool initiator2target) {
+    uint8_t id   = stream_rx_frame[1];
+    uint8_t size = stream_rx_frame[2];
+
+    if (stream_rx_frame[0] != STREAM_SYNC || stream_rx_frame[3] != crc8(&stream_rx_frame[1], 2)) {
+        return false;
+    }
+    if (id == (initiator2target ? STREAM_ID_RESYNC : STREAM_ID_KEEPALIVE)) {
+        return size == 0;
+    }
+    if (id >= NUM_TOTAL_TRANSACTIONS) {
+        return false;
+    }
+
+    split_transaction_desc_t* transaction = &split_transaction_table[id];
+    return size == (initiator2target ? transaction->initiator2target_buffer_size : transaction->target2initiator_buffer_size);
+}
+
+/**
+ * @brief Receive the next intact frame into stream_rx_frame. Sets
+ * stream_rx_dropped if any bytes had to be skipped to find it.
+ *
+ * @return int Id of the frame, STREAM_TIMEOUT if nothing arrived or
+ * STREAM_ERROR if the frame was damaged.
+ */
+static int stream_receive_frame(bool initiator2target, sysinterval_t timeout) {
+    uint8_t have = 0;
+    while (have < STREAM_HEADER_SIZE) {
+        if (!serial_transport_receive_timeout(&stream_rx_frame[have], 1, have ? TIME_MS2I(SERIAL_USART_TIMEOUT) : timeout)) {
+            return have ? STREAM_ERROR : STREAM_TIMEOUT;
+        }
+        ++have;
+
+        // Drop bytes from the front until they could still start a valid header
+        while (have && (stream_rx_frame[0] != STREAM_SYNC || (have == STREAM_HEADER_SIZE && !stream_header_valid(initiator2target)))) {
+            memmove(&stream_rx_frame[0], &stream_rx_frame[1], --have);
+            stream_rx_dropped = true;
+        }
+    }
+
+    uint8_t size = stream_rx_frame[2];
+    if (unlikely(!serial_transport_receive(&stream_rx_frame[STREAM_HEADER_SIZE], size + 1) || stream_rx_frame[STREAM_HEADER_SIZE + size] != crc8(&stream_rx_frame[1], STREAM_HEADER_SIZE - 1 + size))) {
+        return STREAM_ERROR;
+    }
+
+    return stream_rx_frame[1];
+}
+
+/**
+ * @brief Apply a frame from the master, and answer it.
+ */
+static void stream_react_to_frame(uint8_t id) {
+    split_transaction_desc_t* transaction = &split_transaction_table[id];
+
+    chMtxLock(&stream_tx_lock);
+    split_shared_memory_lock();
+    memcpy(split_trans_initiator2target_buffer(transaction), &stream_rx_frame[STREAM_HEADER_SIZE], transaction->initiator2target_buffer_size);
+    if (transaction->slave_callback) {
+        transaction->slave_callback(transaction->initiator2target_buffer_size, split_trans_initiator2target_buffer(transaction), transaction->target2initiator_buffer_size, split_trans_target2initiator_buffer(transaction));
+    }
+    uint8_t len = stream_build_frame(id, split_trans_target2initiator_buffer(transaction), transaction->target2initiator_buffer_size);
+    split_shared_memory_unlock();
+
+    serial_transport_send(stream_tx_frame, len);
+    chMtxUnlock(&stream_tx_lock);
+}
+
+/**
+ * @brief This thread runs on the slave, applying frames from the master.
+ */
+static THD_WORKING_AREA(waSlaveThread, 1024);
+static THD_FUNCTION(SlaveThread, arg) {
+    (void)arg;
+    chRegSetThreadName("split_stream_slave");
+
+    while (true) {
+        int id = stream_receive_frame(true, TIME_INFINITE);
+        if (unlikely(id < 0)) {
+            serial_transport_driver_clear();
+        } else if (id == STREAM_ID_RESYNC) {
+            stream_resync = true;
+        } else {
+            stream_react_to_frame(id);
+        }
+    }
+}
+
+/**
+ * @brief This thread runs on the master, writing every buffer the slave
+ * streams into the shared memory.
+ */
+static THD_WORKING_AREA(waMasterThread, 512);
+static THD_FUNCTION(MasterThread, arg) {
+    (void)arg;
+    chRegSetThreadName("split_stream_master");
+
+    while (true) {
+        stream_rx_dropped = false;
+        int id            = stream_receive_frame(false, TIME_INFINITE);
+        if (unlikely(id < 0)) {
+            serial_transport_driver_clear();
+        }
+        // Whatever was lost might have been a change, so have the slave send everything again
+        if (unlikely(id < 0 || stream_rx_dropped)) {
+            stream_send_control(STREAM_ID_RESYNC);
+        }
+        if (unlikely(id < 0)) {
+            continue;
+        }
+
+        if (id == STREAM_ID_KEEPALIVE) {
+            stream_last_frame = timer_read32();
+            continue;
+        }
+
+        split_transaction_desc_t* transaction = &split_transaction_table[id];
+        split_shared_memory_lock();
+        memcpy(split_trans_target2initiator_buffer(transaction), &stream_rx_frame[STREAM_HEADER_SIZE], transaction->target2initiator_buffer_size);
+        stream_last_frame = timer_read32();
+        split_shared_memory_unlock();
+
+        // Streamed buffers are never empty or from a callback, so anything else answers a frame we sent
+        if (transaction->slave_callback || transaction->target2initiator_buffer_size == 0) {
+            stream_reply_id = id;
+            chBSemSignal(&stream_reply);
+        }
+    }
+}
+
+/**
+ * @brief Slave specific initializations.
+ */
+void soft_serial_target_init(void) {
+    serial_transport_driver_slave_init();
+
+    chThdCreateStatic(waSlaveThread, sizeof(waSlaveThread), HIGHPRIO, SlaveThread, NULL);
+}
+
+/**
+ * @brief Send the target2initiator buffers which changed since they were last
+ * sent, or all of them if the master asked for it. Called by the slave after
+ * each scan, so nothing runs while the halves are idle.
+ */
+void soft_serial_target_publish(void) {
+    bool refresh  = stream_resync;
+    bool okay     = true;
+    stream_resync = false;
+
+    chMtxLock(&stream_tx_lock);
+    for (uint8_t id = 0; id < NUM_TOTAL_TRANSACTIONS; ++id) {
+        split_transaction_desc_t* transaction = &split_transaction_table[id];
+        uint8_t                   size        = transaction->target2initiator_buffer_size;
+        if (!size || transaction->slave_callback) {
+            continue;
+        }
+
+        uint8_t len = 0;
+        split_shared_memory_lock();
+        uint8_t crc = crc8(split_trans_target2initiator_buffer(transaction), size);
+        if (refresh || crc != stream_sent_crc[id]) {
+            stream_sent_crc[id] = crc;
+            len                 = stream_build_frame(id, split_trans_target2initiator_buffer(transaction), size);
+        }
+        split_shared_memory_unlock();
+
+        if (len) {
+            okay &= serial_transport_send(stream_tx_frame, len);
+            stream_last_sent = timer_read32();
+        }
+    }
+    chMtxUnlock(&stream_tx_lock);
+
+    // The master checks for a stalled link, so let it know we are still here
+    if (timer_elapsed32(stream_last_sent) >= SERIAL_STREAM_KEEPALIVE_MS) {
+        okay &= stream_send_control(STREAM_ID_KEEPALIVE);
+        stream_last_sent = timer_read32();
+    }
+
+    // After a failed send the master's copy is unknown, so resend everything
+    if (!okay) {
+        stream_resync = true;
+    }
+}
+
+/**
+ * @brief Master specific initializations.
+ */
+void soft_serial_initiator_init(void) {
+    serial_transport_driver_master_init();
+
+    chThdCreateStatic(waMasterThread, sizeof(waMasterThread), HIGHPRIO, MasterThread, NULL);
+}
+
+/**
+ * @brief Run a transaction from the master half to the slave half.
+ *
+ * @param index Transaction Table index of the transaction to start.
+ * @return bool Indicates success of transaction.
+ */
+bool soft_serial_transaction(int index) {
+    /* Sanity check that we are actually starting a valid transaction. */
+    if (unlikely(index < 0 || index >= NUM_TOTAL_TRANSACTIONS)) {
+        serial_dprintf("SPLIT: illegal transaction id\n");
+        return false;
+    }
+
+    split_transaction_desc_t* transaction = &split_transaction_table[index];
+
+    if (transaction->initiator2target_buffer_size || transaction->slave_callback) {
+        chMtxLock(&stream_tx_lock);
+        split_shared_memory_lock();
+        uint8_t len = stream_build_frame(index, split_trans_initiator2target_buffer(transaction), transaction->initiator2target_buffer_size);
+        split_shared_memory_unlock();
+
+        chBSemReset(&stream_reply, true);
+        bool sent = serial_transport_send(stream_tx_frame, len);
+        chMtxUnlock(&stream_tx_lock);
+        if (unlikely(!sent)) {
+            serial_dprintf("SPLIT: sending frame failed\n");
+            return false;
+        }
+
+        // A write the slave never saw fails here, so the caller retries it
+        do {
+            if (unlikely(chBSemWaitTimeout(&stream_reply, TIME_MS2I(SERIAL_USART_TIMEOUT)) != MSG_OK)) {
+                serial_dprintf("SPLIT: no reply from slave\n");
+                return false;
+            }
+        } while (stream_reply_id != index);
+    } else if (timer_elapsed32(stream_last_frame) >= SERIAL_USART_TIMEOUT) {
+        // Nothing has arrived for a while, so whatever we have is stale
+        serial_dprintf("SPLIT: slave stream stalled\n");
+        return false;
+    }
+
+    return true;
+}
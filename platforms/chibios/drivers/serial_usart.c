@@ -148,6 +148,11 @@ inline bool serial_transport_receive(uint8_t* destination, const size_t size) {
     return success;
 }
 
+inline bool serial_transport_receive_timeout(uint8_t* destination, const size_t size, const sysinterval_t timeout) {
+    bool success = (size_t)chnReadTimeout(serial_driver, destination, size, timeout) == size;
+    return success;
+}
+
 inline bool serial_transport_receive_blocking(uint8_t* destination, const size_t size) {
     bool success = (size_t)chnRead(serial_driver, destination, size) == size;
     return success;
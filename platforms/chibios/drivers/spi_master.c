@@ -26,6 +26,29 @@ static SPIConfig spiConfig = {NULL, 0, 0, 0};
 static SPIConfig spiConfig = {false, NULL, 0, 0, 0, 0};
 #endif
 
+// State of the transfer started by spi_transmit_async(), if any
+static volatile bool spi_async_busy = false;
+static BSEMAPHORE_DECL(spi_async_done, true);
+
+static void spi_async_end_cb(SPIDriver *spip) {
+    (void)spip;
+    chSysLockFromISR();
+    if (spi_async_busy) {
+        spi_async_busy = false;
+        chBSemSignalI(&spi_async_done);
+    }
+    chSysUnlockFromISR();
+}
+
+/**
+ * @brief Waits for the transfer started by spi_transmit_async() to finish.
+ */
+void spi_wait(void) {
+    if (spi_async_busy) {
+        chBSemWait(&spi_async_done);
+    }
+}
+
 __attribute__((weak)) void spi_init(void) {
     static bool is_initialised = false;
     if (!is_initialised) {
@@ -52,6 +75,8 @@ __attribute__((weak)) void spi_init(void) {
 }
 
 bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
+    spi_wait();
+
     if (currentSlavePin != NO_PIN || slavePin == NO_PIN) {
         return false;
     }
@@ -250,6 +275,7 @@ bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
     currentSlavePin  = slavePin;
     spiConfig.ssport = PAL_PORT(slavePin);
     spiConfig.sspad  = PAL_PAD(slavePin);
+    spiConfig.end_cb = spi_async_end_cb;
 
     setPinOutput(slavePin);
     spiStart(&SPI_DRIVER, &spiConfig);
@@ -259,6 +285,7 @@ bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
 }
 
 spi_status_t spi_write(uint8_t data) {
+    spi_wait();
     uint8_t rxData;
     spiExchange(&SPI_DRIVER, 1, &data, &rxData);
 
@@ -266,6 +293,7 @@ spi_status_t spi_write(uint8_t data) {
 }
 
 spi_status_t spi_read(void) {
+    spi_wait();
     uint8_t data = 0;
     spiReceive(&SPI_DRIVER, 1, &data);
 
@@ -273,17 +301,34 @@ spi_status_t spi_read(void) {
 }
 
 spi_status_t spi_transmit(const uint8_t *data, uint16_t length) {
+    spi_wait();
     spiSend(&SPI_DRIVER, length, data);
     return SPI_STATUS_SUCCESS;
 }
 
+spi_status_t spi_transmit_async(const uint8_t *data, uint16_t length) {
+    spi_wait();
+
+#if defined(CACHE_LINE_SIZE)
+    // The DMA reads memory directly, so anything still in the data cache has to be written back first
+    cacheBufferFlush(data, length);
+#endif
+
+    chBSemReset(&spi_async_done, true);
+    spi_async_busy = true;
+    spiStartSend(&SPI_DRIVER, length, data);
+    return SPI_STATUS_SUCCESS;
+}
+
 spi_status_t spi_receive(uint8_t *data, uint16_t length) {
+    spi_wait();
     spiReceive(&SPI_DRIVER, length, data);
     return SPI_STATUS_SUCCESS;
 }
 
 void spi_stop(void) {
     if (currentSlavePin != NO_PIN) {
+        spi_wait();
         spiUnselect(&SPI_DRIVER);
         spiStop(&SPI_DRIVER);
         currentSlavePin = NO_PIN;
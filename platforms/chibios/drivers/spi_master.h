@@ -87,6 +87,10 @@ spi_status_t spi_transmit(const uint8_t *data, uint16_t length);
 
 spi_status_t spi_receive(uint8_t *data, uint16_t length);
 
+spi_status_t spi_transmit_async(const uint8_t *data, uint16_t length);
+
+void spi_wait(void);
+
 void spi_stop(void);
 #ifdef __cplusplus
 }
@@ -107,3 +107,7 @@ void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) {
 
     chSysUnlock();
 }
+
+bool ws2812_busy(void) {
+    return false;
+}
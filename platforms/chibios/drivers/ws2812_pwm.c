@@ -1,6 +1,7 @@
 #include "ws2812.h"
 #include "quantum.h"
 #include <hal.h>
+#include <string.h>
 
 /* Adapted from https://github.com/joewa/WS2812-LED-Driver_ChibiOS/ */
 
@@ -293,6 +294,9 @@ typedef uint8_t ws2812_buffer_t;
 
 static ws2812_buffer_t ws2812_frame_buffer[WS2812_BIT_N + 1]; /**< Buffer for a frame */
 
+static LED_TYPE ws2812_encoded[WS2812_LED_COUNT]; /**< Colours currently encoded in the frame buffer */
+static uint16_t ws2812_encoded_count = 0;         /**< Number of LEDs encoded at least once */
+
 /* --- PUBLIC FUNCTIONS ----------------------------------------------------- */
 /*
  * Gedanke: Double-buffer type transactions: double buffer transfers using two memory pointers for
@@ -386,11 +390,24 @@ void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
         s_init = true;
     }
 
+    // The frame buffer is streamed continuously by DMA, so only LEDs whose
+    // colour changed since they were last encoded need to be rewritten.
     for (uint16_t i = 0; i < leds; i++) {
+        if (i < ws2812_encoded_count && memcmp(&ws2812_encoded[i], &ledarray[i], sizeof(LED_TYPE)) == 0) {
+            continue;
+        }
 #ifdef RGBW
         ws2812_write_led_rgbw(i, ledarray[i].r, ledarray[i].g, ledarray[i].b, ledarray[i].w);
 #else
         ws2812_write_led(i, ledarray[i].r, ledarray[i].g, ledarray[i].b);
 #endif
+        ws2812_encoded[i] = ledarray[i];
+    }
+    if (leds > ws2812_encoded_count) {
+        ws2812_encoded_count = leds;
     }
 }
+
+bool ws2812_busy(void) {
+    return false;
+}
@@ -1,5 +1,7 @@
 #include "quantum.h"
 #include "ws2812.h"
+#include "ws2812_spi_encode.h"
+#include <string.h>
 
 /* Adapted from https://github.com/gamazeps/ws2812b-chibios-SPIDMA/ */
 
@@ -73,67 +75,48 @@
 #    define WS2812_SCK_OUTPUT_MODE PAL_MODE_ALTERNATE(WS2812_SPI_SCK_PAL_MODE) | PAL_OUTPUT_TYPE_PUSHPULL
 #endif
 
-#define BYTES_FOR_LED_BYTE 4
-#ifdef RGBW
-#    define WS2812_CHANNELS 4
-#else
-#    define WS2812_CHANNELS 3
-#endif
-#define BYTES_FOR_LED (BYTES_FOR_LED_BYTE * WS2812_CHANNELS)
-#define DATA_SIZE (BYTES_FOR_LED * WS2812_LED_COUNT)
+#define DATA_SIZE (WS2812_SPI_BYTES_FOR_LED * WS2812_LED_COUNT)
 #define RESET_SIZE (1000 * WS2812_TRST_US / (2 * WS2812_TIMING))
 #define PREAMBLE_SIZE 4
 
-static uint8_t txbuf[PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE] = {0};
-
-/*
- * As the trick here is to use the SPI to send a huge pattern of 0 and 1 to
- * the ws2812b protocol, we use this helper function to translate bytes into
- * 0s and 1s for the LED (with the appropriate timing).
- */
-static uint8_t get_protocol_eq(uint8_t data, int pos) {
-    uint8_t eq = 0;
-    if (data & (1 << (2 * (3 - pos))))
-        eq = 0b1110;
-    else
-        eq = 0b1000;
-    if (data & (2 << (2 * (3 - pos))))
-        eq += 0b11100000;
-    else
-        eq += 0b10000000;
-    return eq;
-}
-
-static void set_led_color_rgb(LED_TYPE color, int pos) {
-    uint8_t* tx_start = &txbuf[PREAMBLE_SIZE];
-
-#if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
-#elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_RGB)
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
-#elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_BGR)
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.b, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.r, j);
-#endif
-#ifdef RGBW
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 4 + j] = get_protocol_eq(color.w, j);
+#if !defined(WS2812_SPI_USE_CIRCULAR_BUFFER) && !defined(WS2812_SPI_SYNC)
+#    define WS2812_SPI_ASYNC
+// One buffer is encoded into while the other is being sent
+#    define WS2812_SPI_BUFFERS 2
+#else
+#    define WS2812_SPI_BUFFERS 1
 #endif
+
+static uint8_t txbuf[WS2812_SPI_BUFFERS][PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE] = {0};
+
+// Colours currently encoded in each buffer, so only changed LEDs are re-encoded
+static LED_TYPE ws2812_encoded[WS2812_SPI_BUFFERS][WS2812_LED_COUNT];
+static uint16_t ws2812_encoded_count[WS2812_SPI_BUFFERS];
+
+#ifdef WS2812_SPI_ASYNC
+// Set when new data arrives while a transfer is running, the transfer
+// complete callback then starts the buffer which was filled meanwhile.
+static volatile bool ws2812_pending = false;
+// Buffer to encode the next frame into, the other one may be in flight
+static volatile uint8_t ws2812_fill = 0;
+// Colours of the last frame sent or queued, which the buffer being filled
+// is usually a frame behind
+static LED_TYPE ws2812_sent[WS2812_LED_COUNT];
+static uint16_t ws2812_sent_count = 0;
+
+static void ws2812_spi_complete_cb(SPIDriver* spip) {
+    osalSysLockFromISR();
+    if (ws2812_pending) {
+        ws2812_pending = false;
+        spiStartSendI(spip, sizeof(txbuf[0]), txbuf[ws2812_fill]);
+        ws2812_fill ^= 1;
+    }
+    osalSysUnlockFromISR();
 }
+#    define WS2812_SPI_COMPLETE_CB ws2812_spi_complete_cb
+#else
+#    define WS2812_SPI_COMPLETE_CB NULL
+#endif
 
 void ws2812_init(void) {
     palSetLineMode(RGB_DI_PIN, WS2812_MOSI_OUTPUT_MODE);
@@ -149,7 +132,7 @@ void ws2812_init(void) {
 #    if SPI_SUPPORTS_CIRCULAR == TRUE
         WS2812_SPI_BUFFER_MODE,
 #    endif
-        NULL, // end_cb
+        WS2812_SPI_COMPLETE_CB, // end_cb
         PAL_PORT(RGB_DI_PIN),
         PAL_PAD(RGB_DI_PIN),
 #    if defined(WB32F3G71xx) || defined(WB32FQ95xx)
@@ -168,8 +151,8 @@ void ws2812_init(void) {
 #    if SPI_SUPPORTS_SLAVE_MODE == TRUE
         false,
 #    endif
-        NULL, // data_cb
-        NULL, // error_cb
+        WS2812_SPI_COMPLETE_CB, // data_cb
+        NULL,                   // error_cb
         PAL_PORT(RGB_DI_PIN),
         PAL_PAD(RGB_DI_PIN),
         WS2812_SPI_DIVISOR_CR1_BR_X,
@@ -181,7 +164,7 @@ void ws2812_init(void) {
     spiStart(&WS2812_SPI, &spicfg); /* Setup transfer parameters.       */
     spiSelect(&WS2812_SPI);         /* Slave Select assertion.          */
 #ifdef WS2812_SPI_USE_CIRCULAR_BUFFER
-    spiStartSend(&WS2812_SPI, ARRAY_SIZE(txbuf), txbuf);
+    spiStartSend(&WS2812_SPI, sizeof(txbuf[0]), txbuf[0]);
 #endif
 }
 
@@ -192,17 +175,52 @@ void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
         s_init = true;
     }
 
-    for (uint8_t i = 0; i < leds; i++) {
-        set_led_color_rgb(ledarray[i], i);
+#ifdef WS2812_SPI_ASYNC
+    osalSysLock();
+    // Take back a frame still waiting to be sent, so its buffer can't be started while it's being encoded
+    bool    pending = ws2812_pending;
+    uint8_t fill    = ws2812_fill;
+    ws2812_pending  = false;
+    osalSysUnlock();
+
+    if (leds <= ws2812_sent_count && memcmp(ws2812_sent, ledarray, sizeof(LED_TYPE) * leds) == 0 && !pending) {
+        return;
+    }
+    memcpy(ws2812_sent, ledarray, sizeof(LED_TYPE) * leds);
+    if (leds > ws2812_sent_count) {
+        ws2812_sent_count = leds;
+    }
+    ws2812_spi_encode_changed(&txbuf[fill][PREAMBLE_SIZE], ws2812_encoded[fill], &ws2812_encoded_count[fill], ledarray, leds);
+
+    // Send async - each led takes ~0.03ms, 50 leds ~1.5ms. If the previous
+    // frame is still being sent, this one is started from the transfer
+    // complete callback instead of waiting here.
+    osalSysLock();
+    if (WS2812_SPI.state == SPI_ACTIVE) {
+        ws2812_pending = true;
+    } else {
+        spiStartSendI(&WS2812_SPI, sizeof(txbuf[fill]), txbuf[fill]);
+        ws2812_fill = fill ^ 1;
     }
+    osalSysUnlock();
+#else
+    bool changed = ws2812_spi_encode_changed(&txbuf[0][PREAMBLE_SIZE], ws2812_encoded[0], &ws2812_encoded_count[0], ledarray, leds);
 
-    // Send async - each led takes ~0.03ms, 50 leds ~1.5ms, animations flushing faster than send will cause issues.
-    // Instead spiSend can be used to send synchronously (or the thread logic can be added back).
-#ifndef WS2812_SPI_USE_CIRCULAR_BUFFER
-#    ifdef WS2812_SPI_SYNC
-    spiSend(&WS2812_SPI, ARRAY_SIZE(txbuf), txbuf);
+#    ifdef WS2812_SPI_USE_CIRCULAR_BUFFER
+    // the buffer is streamed continuously, changes are picked up on the next pass
+    (void)changed;
 #    else
-    spiStartSend(&WS2812_SPI, ARRAY_SIZE(txbuf), txbuf);
+    if (changed) {
+        spiSend(&WS2812_SPI, sizeof(txbuf[0]), txbuf[0]);
+    }
 #    endif
 #endif
 }
+
+bool ws2812_busy(void) {
+#ifdef WS2812_SPI_ASYNC
+    return ws2812_pending || WS2812_SPI.state == SPI_ACTIVE;
+#else
+    return false;
+#endif
+}
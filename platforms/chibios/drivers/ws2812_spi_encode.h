@@ -0,0 +1,79 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "ws2812.h"
+
+/*
+ * As the trick here is to use the SPI to send a huge pattern of 0 and 1 to
+ * the ws2812b protocol, every pair of data bits is translated into one byte
+ * of 0s and 1s for the LED (with the appropriate timing).
+ *
+ * This is kept free of any HAL types so the encoder can be tested and timed
+ * on the host.
+ */
+
+#define WS2812_SPI_BYTES_FOR_LED_BYTE 4
+#ifdef RGBW
+#    define WS2812_SPI_CHANNELS 4
+#else
+#    define WS2812_SPI_CHANNELS 3
+#endif
+#define WS2812_SPI_BYTES_FOR_LED (WS2812_SPI_BYTES_FOR_LED_BYTE * WS2812_SPI_CHANNELS)
+
+static const uint8_t ws2812_spi_bit_pairs[4] = {0x88, 0x8E, 0xE8, 0xEE};
+
+static inline void ws2812_spi_encode_byte(uint8_t* tx, uint8_t data) {
+    tx[0] = ws2812_spi_bit_pairs[(data >> 6) & 0b11];
+    tx[1] = ws2812_spi_bit_pairs[(data >> 4) & 0b11];
+    tx[2] = ws2812_spi_bit_pairs[(data >> 2) & 0b11];
+    tx[3] = ws2812_spi_bit_pairs[data & 0b11];
+}
+
+static inline void ws2812_spi_encode_led(uint8_t* tx, LED_TYPE color) {
+#if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
+    ws2812_spi_encode_byte(tx, color.g);
+    ws2812_spi_encode_byte(tx + WS2812_SPI_BYTES_FOR_LED_BYTE, color.r);
+    ws2812_spi_encode_byte(tx + WS2812_SPI_BYTES_FOR_LED_BYTE * 2, color.b);
+#elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_RGB)
+    ws2812_spi_encode_byte(tx, color.r);
+    ws2812_spi_encode_byte(tx + WS2812_SPI_BYTES_FOR_LED_BYTE, color.g);
+    ws2812_spi_encode_byte(tx + WS2812_SPI_BYTES_FOR_LED_BYTE * 2, color.b);
+#elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_BGR)
+    ws2812_spi_encode_byte(tx, color.b);
+    ws2812_spi_encode_byte(tx + WS2812_SPI_BYTES_FOR_LED_BYTE, color.g);
+    ws2812_spi_encode_byte(tx + WS2812_SPI_BYTES_FOR_LED_BYTE * 2, color.r);
+#endif
+#ifdef RGBW
+    ws2812_spi_encode_byte(tx + WS2812_SPI_BYTES_FOR_LED_BYTE * 3, color.w);
+#endif
+}
+
+/**
+ * @brief Encode the LEDs whose colour differs from the one last encoded into
+ * the buffer.
+ *
+ * @param tx the LED data of the transfer buffer, after any preamble
+ * @param encoded the colours currently encoded in tx, updated as LEDs are encoded
+ * @param encoded_count how many entries of encoded are valid, updated to cover leds
+ * @return bool true if any LED was encoded
+ */
+static inline bool ws2812_spi_encode_changed(uint8_t* tx, LED_TYPE* encoded, uint16_t* encoded_count, const LED_TYPE* leds, uint16_t count) {
+    bool changed = false;
+    for (uint16_t i = 0; i < count; i++) {
+        if (i < *encoded_count && memcmp(&encoded[i], &leds[i], sizeof(LED_TYPE)) == 0) {
+            continue;
+        }
+        ws2812_spi_encode_led(&tx[WS2812_SPI_BYTES_FOR_LED * i], leds[i]);
+        encoded[i] = leds[i];
+        changed    = true;
+    }
+    if (count > *encoded_count) {
+        *encoded_count = count;
+    }
+    return changed;
+}
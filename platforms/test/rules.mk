@@ -23,3 +23,9 @@ eeprom_legacy_emulated_flash_SRC := \
 	$(PLATFORM_PATH)/chibios/drivers/eeprom/eeprom_legacy_emulated_flash.c
 eeprom_legacy_emulated_flash_tiny_SRC := $(eeprom_legacy_emulated_flash_SRC)
 eeprom_legacy_emulated_flash_large_SRC := $(eeprom_legacy_emulated_flash_SRC)
+
+ws2812_spi_encode_INC := \
+	$(PLATFORM_PATH)/chibios/drivers/
+
+ws2812_spi_encode_SRC := \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/ws2812_spi_encode_tests.cpp
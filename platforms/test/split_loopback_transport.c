@@ -0,0 +1,121 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+
+#include "split_loopback_transport.h"
+#include "transactions.h"
+#include "transport.h"
+
+void advance_time(uint32_t ms);
+
+static split_shared_memory_t shared_memory; // the side currently running
+static split_shared_memory_t other_memory;  // the side waiting for it
+split_shared_memory_t *const split_shmem = &shared_memory;
+
+static split_loopback_faults_t loopback_faults = {0};
+static split_loopback_stats_t  loopback_stats  = {0};
+static uint32_t                loopback_rng    = 1;
+
+static uint16_t loopback_random(void) {
+    // xorshift32, so a given seed always produces the same faults
+    loopback_rng ^= loopback_rng << 13;
+    loopback_rng ^= loopback_rng >> 17;
+    loopback_rng ^= loopback_rng << 5;
+    return loopback_rng >> 16;
+}
+
+static bool loopback_chance(uint16_t rate) {
+    return rate && loopback_random() < rate;
+}
+
+static void loopback_switch_sides(void) {
+    split_shared_memory_t temp;
+    memcpy(&temp, &shared_memory, sizeof(temp));
+    memcpy(&shared_memory, &other_memory, sizeof(shared_memory));
+    memcpy(&other_memory, &temp, sizeof(other_memory));
+}
+
+static bool loopback_wire(uint8_t *dest, const uint8_t *src, size_t length, bool corrupt) {
+    if (loopback_chance(loopback_faults.drop_rate)) {
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        dest[i] = src[i];
+        if (loopback_chance(loopback_faults.bit_error_rate) || (corrupt && i == 0)) {
+            dest[i] ^= 1 << (loopback_random() & 7);
+            loopback_stats.bit_errors++;
+        }
+    }
+    loopback_stats.bytes += length;
+    return true;
+}
+
+void split_loopback_set_faults(const split_loopback_faults_t *faults) {
+    loopback_faults = *faults;
+    loopback_rng    = faults->seed ? faults->seed : 1;
+}
+
+void split_loopback_clear_faults(void) {
+    split_loopback_faults_t faults = {0};
+    split_loopback_set_faults(&faults);
+}
+
+void split_loopback_clear_stats(void) {
+    memset(&loopback_stats, 0, sizeof(loopback_stats));
+}
+
+const split_loopback_stats_t *split_loopback_get_stats(void) {
+    return &loopback_stats;
+}
+
+void transport_master_init(void) {}
+void transport_slave_init(void) {}
+
+bool transport_execute_transaction(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length) {
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+    loopback_stats.transactions++;
+    advance_time(loopback_faults.latency_ms);
+
+    if (initiator2target_length > 0) {
+        size_t len = trans->initiator2target_buffer_size < initiator2target_length ? trans->initiator2target_buffer_size : initiator2target_length;
+        memcpy(split_trans_initiator2target_buffer(trans), initiator2target_buf, len);
+    }
+
+    // Same framing as the serial transport, whole buffers each way with the callback in between
+    uint8_t *master = (uint8_t *)&shared_memory;
+    uint8_t *slave  = (uint8_t *)&other_memory;
+    bool corrupt = loopback_faults.corrupt_after && loopback_stats.transactions == loopback_faults.corrupt_after + 1;
+    if (!loopback_wire(&slave[trans->initiator2target_offset], &master[trans->initiator2target_offset], trans->initiator2target_buffer_size, corrupt)) {
+        loopback_stats.failures++;
+        return false;
+    }
+
+    if (trans->slave_callback) {
+        loopback_switch_sides();
+        trans->slave_callback(trans->initiator2target_buffer_size, split_trans_initiator2target_buffer(trans), trans->target2initiator_buffer_size, split_trans_target2initiator_buffer(trans));
+        loopback_switch_sides();
+    }
+
+    if (!loopback_wire(&master[trans->target2initiator_offset], &slave[trans->target2initiator_offset], trans->target2initiator_buffer_size, false)) {
+        loopback_stats.failures++;
+        return false;
+    }
+
+    if (target2initiator_length > 0) {
+        size_t len = trans->target2initiator_buffer_size < target2initiator_length ? trans->target2initiator_buffer_size : target2initiator_length;
+        memcpy(target2initiator_buf, split_trans_target2initiator_buffer(trans), len);
+    }
+
+    return true;
+}
+
+bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    return transactions_master(master_matrix, slave_matrix);
+}
+
+void transport_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    loopback_switch_sides();
+    transactions_slave(master_matrix, slave_matrix);
+    loopback_switch_sides();
+}
@@ -0,0 +1,43 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * In-process split transport for host tests. Master and slave each keep their
+ * own copy of the split shared memory, and every transaction is copied between
+ * them byte by byte over a simulated wire that can be made slow or unreliable.
+ * The master side's copy is the one visible through split_shmem, except while
+ * slave callbacks and transport_slave() are running.
+ */
+
+typedef struct {
+    uint32_t latency_ms;     // added to the clock for every transaction
+    uint16_t bit_error_rate; // chance of any byte on the wire having a bit flipped, out of 65536
+    uint16_t drop_rate;      // chance of each direction of a transaction being lost, out of 65536
+    uint32_t seed;           // for the fault generator, so runs are repeatable
+    uint32_t corrupt_after;  // if non-zero, flip a bit in the first byte the master sends after this many transactions
+} split_loopback_faults_t;
+
+typedef struct {
+    uint32_t transactions; // started by the master
+    uint32_t failures;     // transactions which returned false
+    uint32_t bytes;        // bytes put on the wire in either direction
+    uint32_t bit_errors;   // bytes which had a bit flipped
+} split_loopback_stats_t;
+
+void                          split_loopback_set_faults(const split_loopback_faults_t *faults);
+void                          split_loopback_clear_faults(void);
+void                          split_loopback_clear_stats(void);
+const split_loopback_stats_t *split_loopback_get_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,131 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ws2812_spi_encode.h"
+}
+
+static constexpr uint16_t led_count = 128;
+
+class Ws2812SpiEncode : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        tx.assign(WS2812_SPI_BYTES_FOR_LED * led_count, 0);
+        encoded.assign(led_count, LED_TYPE{});
+        encoded_count = 0;
+        leds.resize(led_count);
+        for (uint16_t i = 0; i < led_count; ++i) {
+            leds[i]   = LED_TYPE{};
+            leds[i].r = i;
+            leds[i].g = i * 3;
+            leds[i].b = 255 - i;
+        }
+    }
+
+    bool encode(void) {
+        return ws2812_spi_encode_changed(tx.data(), encoded.data(), &encoded_count, leds.data(), led_count);
+    }
+
+    // The per-bit encoder the lookup table replaced
+    static uint8_t reference_bit_pair(uint8_t data, int pos) {
+        uint8_t eq = 0;
+        if (data & (1 << (2 * (3 - pos))))
+            eq = 0b1110;
+        else
+            eq = 0b1000;
+        if (data & (2 << (2 * (3 - pos))))
+            eq += 0b11100000;
+        else
+            eq += 0b10000000;
+        return eq;
+    }
+
+    void reference_encode(void) {
+        for (uint16_t i = 0; i < led_count; ++i) {
+            uint8_t* led   = &tx[WS2812_SPI_BYTES_FOR_LED * i];
+            uint8_t  ch[3] = {leds[i].g, leds[i].r, leds[i].b};
+            for (int c = 0; c < 3; ++c) {
+                for (int j = 0; j < 4; ++j) {
+                    led[c * WS2812_SPI_BYTES_FOR_LED_BYTE + j] = reference_bit_pair(ch[c], j);
+                }
+            }
+        }
+    }
+
+    template <typename F>
+    static double best_time(F&& work) {
+        double best = 1e12;
+        for (int run = 0; run < 7; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            for (int rep = 0; rep < 100; ++rep) {
+                work();
+            }
+            best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / 100);
+        }
+        return best;
+    }
+
+    std::vector<uint8_t>  tx;
+    std::vector<LED_TYPE> encoded;
+    uint16_t              encoded_count;
+    std::vector<LED_TYPE> leds;
+};
+
+TEST_F(Ws2812SpiEncode, EncodesBitPairs) {
+    uint8_t out[WS2812_SPI_BYTES_FOR_LED_BYTE];
+    ws2812_spi_encode_byte(out, 0b00011011);
+    EXPECT_EQ(out[0], 0x88);
+    EXPECT_EQ(out[1], 0x8E);
+    EXPECT_EQ(out[2], 0xE8);
+    EXPECT_EQ(out[3], 0xEE);
+}
+
+TEST_F(Ws2812SpiEncode, MatchesPerBitEncoder) {
+    ASSERT_TRUE(encode());
+    auto table = tx;
+    std::fill(tx.begin(), tx.end(), 0);
+    reference_encode();
+    EXPECT_EQ(table, tx);
+}
+
+TEST_F(Ws2812SpiEncode, OnlyChangedLedsEncoded) {
+    ASSERT_TRUE(encode());
+    EXPECT_FALSE(encode());
+
+    // Anything re-encoded would overwrite the marker
+    std::fill(tx.begin(), tx.end(), 0x55);
+    leds[7].b ^= 0xFF;
+    ASSERT_TRUE(encode());
+
+    for (uint16_t i = 0; i < led_count; ++i) {
+        bool written = tx[WS2812_SPI_BYTES_FOR_LED * i] != 0x55;
+        EXPECT_EQ(written, i == 7) << "led " << i;
+    }
+}
+
+TEST_F(Ws2812SpiEncode, EncodeCost) {
+    double table = best_time([&] {
+        encoded_count = 0;
+        encode();
+    });
+    double reference = best_time([&] { reference_encode(); });
+    double one_changed = best_time([&] {
+        leds[led_count / 2].r ^= 1;
+        encode();
+    });
+
+    RecordProperty("table_ns_per_led", std::to_string(table / led_count));
+    RecordProperty("per_bit_ns_per_led", std::to_string(reference / led_count));
+    RecordProperty("one_changed_ns_per_frame", std::to_string(one_changed));
+
+    EXPECT_LT(table * 2, reference);
+    // Skipping unchanged LEDs has to cost less than encoding them all
+    EXPECT_LT(one_changed, table);
+}
@@ -5,13 +5,20 @@ LED_MATRIX_EFFECT(BREATHING)
 bool BREATHING(effect_params_t* params) {
     LED_MATRIX_USE_LIMITS(led_min, led_max);
 
-    uint8_t  val  = led_matrix_eeconfig.val;
     uint16_t time = scale16by8(g_led_timer, led_matrix_eeconfig.speed / 8);
-    val           = scale8(abs8(sin8(time) - 128) * 2, val);
+#        ifdef LED_MATRIX_HIGH_RESOLUTION
+    uint16_t val = scale16(abs(sin16(time << 8)) * 2, led_matrix_eeconfig.val * 257);
+    for (uint8_t i = led_min; i < led_max; i++) {
+        LED_MATRIX_TEST_LED_FLAGS();
+        led_matrix_set_value16(i, val);
+    }
+#        else
+    uint8_t val = scale8(abs8(sin8(time) - 128) * 2, led_matrix_eeconfig.val);
     for (uint8_t i = led_min; i < led_max; i++) {
         LED_MATRIX_TEST_LED_FLAGS();
         led_matrix_set_value(i, val);
     }
+#        endif
     return led_matrix_check_finished_leds(led_max);
 }
 
@@ -92,6 +92,15 @@ uint8_t g_led_frame_buffer[MATRIX_ROWS][MATRIX_COLS] = {{0}};
 last_hit_t g_last_hit_tracker;
 #endif // LED_MATRIX_KEYREACTIVE_ENABLED
 
+// high resolution intensity buffer, converted to driver values on flush
+#ifdef LED_MATRIX_HIGH_RESOLUTION
+static uint16_t led_intensity[LED_MATRIX_LED_COUNT];
+#    ifdef LED_MATRIX_DITHERING
+static uint8_t led_dither_error[LED_MATRIX_LED_COUNT];
+static bool    led_dither_active; // some LED sits between two driver values, so every flush changes the output
+#    endif // LED_MATRIX_DITHERING
+#endif     // LED_MATRIX_HIGH_RESOLUTION
+
 // internals
 static bool            suspend_state     = false;
 static uint8_t         led_last_enable   = UINT8_MAX;
@@ -152,19 +161,80 @@ uint8_t led_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
     return led_count;
 }
 
+#ifdef LED_MATRIX_HIGH_RESOLUTION
+static inline uint16_t led_matrix_gamma16(uint16_t value) {
+#    ifdef USE_CIE1931_CURVE
+    // interpolate between the two table entries either side of the high byte
+    uint8_t  frac = value & 0xFF;
+    uint16_t lo   = pgm_read_word(&CIE1931_CURVE_16[value >> 8]);
+    uint16_t hi   = pgm_read_word(&CIE1931_CURVE_16[(value >> 8) + 1]);
+    return lo + (((uint32_t)(hi - lo) * frac) >> 8);
+#    else
+    return value;
+#    endif
+}
+
+static void led_matrix_convert_intensity(void) {
+#    ifdef LED_MATRIX_DITHERING
+    led_dither_active = false;
+#    endif
+    for (uint8_t i = 0; i < LED_MATRIX_LED_COUNT; i++) {
+        uint32_t level = led_matrix_gamma16(led_intensity[i]);
+#    ifdef LED_MATRIX_DITHERING
+        // carry the truncated low byte over to the next frame so the average
+        // output over time matches the 16 bit level, levels which land on a
+        // driver value exactly have nothing to carry
+        if (level & 0xFF) {
+            level += led_dither_error[i];
+            led_dither_error[i] = level & 0xFF;
+            led_dither_active   = true;
+        } else {
+            led_dither_error[i] = 0;
+        }
+#    else
+        level += 0x80;
+#    endif
+        level >>= 8;
+        if (level > UINT8_MAX) {
+            level = UINT8_MAX;
+        }
+        led_matrix_driver.set_value(i, level);
+    }
+}
+
+void led_matrix_set_value16(int index, uint16_t value) {
+    led_intensity[index] = value;
+}
+
+void led_matrix_set_value16_all(uint16_t value) {
+    for (uint8_t i = 0; i < LED_MATRIX_LED_COUNT; i++) {
+        led_intensity[i] = value;
+    }
+}
+#endif // LED_MATRIX_HIGH_RESOLUTION
+
 void led_matrix_update_pwm_buffers(void) {
+#ifdef LED_MATRIX_HIGH_RESOLUTION
+    led_matrix_convert_intensity();
+#endif
     led_matrix_driver.flush();
 }
 
 void led_matrix_set_value(int index, uint8_t value) {
-#ifdef USE_CIE1931_CURVE
+#ifdef LED_MATRIX_HIGH_RESOLUTION
+    led_matrix_set_value16(index, value * 257);
+#else
+#    ifdef USE_CIE1931_CURVE
     value = pgm_read_byte(&CIE1931_CURVE[value]);
-#endif
+#    endif
     led_matrix_driver.set_value(index, value);
+#endif
 }
 
 void led_matrix_set_value_all(uint8_t value) {
-#if defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
+#if defined(LED_MATRIX_HIGH_RESOLUTION)
+    led_matrix_set_value16_all(value * 257);
+#elif defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
     for (uint8_t i = 0; i < LED_MATRIX_LED_COUNT; i++)
         led_matrix_set_value(i, value);
 #else
@@ -327,7 +397,12 @@ static void led_task_render(uint8_t effect) {
     // next task
     if (!rendering) {
         led_task_state = FLUSHING;
-        if (!led_effect_params.init && effect == LED_MATRIX_NONE) {
+        if (!led_effect_params.init && effect == LED_MATRIX_NONE
+#if defined(LED_MATRIX_HIGH_RESOLUTION) && defined(LED_MATRIX_DITHERING)
+            // unless the dithered output has to keep alternating
+            && !led_dither_active
+#endif
+        ) {
             // We only need to flush once if we are LED_MATRIX_NONE
             led_task_state = SYNCING;
         }
@@ -112,6 +112,10 @@ uint8_t led_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
 
 void led_matrix_set_value(int index, uint8_t value);
 void led_matrix_set_value_all(uint8_t value);
+#ifdef LED_MATRIX_HIGH_RESOLUTION
+void led_matrix_set_value16(int index, uint16_t value);
+void led_matrix_set_value16_all(uint16_t value);
+#endif
 
 void process_led_matrix(uint8_t row, uint8_t col, bool pressed);
 
@@ -0,0 +1,10 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#define MATRIX_ROWS 1
+#define MATRIX_COLS 1
+
+#define LED_MATRIX_LED_COUNT 64
+#define LED_MATRIX_HIGH_RESOLUTION
+#define LED_MATRIX_DITHERING
@@ -0,0 +1,152 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "led_matrix.h"
+#include "led_tables.h"
+#include "timer.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+void led_matrix_update_pwm_buffers(void);
+
+bool eeconfig_is_enabled(void) {
+    return true;
+}
+
+void eeconfig_init(void) {}
+
+bool is_keyboard_master(void) {
+    return true;
+}
+}
+
+// What the LED driver was last sent, and how often it was flushed
+static uint8_t  driver_values[LED_MATRIX_LED_COUNT];
+static uint32_t driver_flushes;
+
+static void mock_init(void) {}
+
+static void mock_set_value(int index, uint8_t value) {
+    driver_values[index] = value;
+}
+
+static void mock_set_value_all(uint8_t value) {
+    std::fill(driver_values, driver_values + LED_MATRIX_LED_COUNT, value);
+}
+
+static void mock_flush(void) {
+    driver_flushes++;
+}
+
+extern "C" const led_matrix_driver_t led_matrix_driver = {mock_init, mock_set_value, mock_set_value_all, mock_flush};
+extern "C" led_config_t              g_led_config      = {{{0}}, {}, {}};
+
+class LedMatrixDither : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        set_time(0);
+        led_matrix_init();
+        led_matrix_enable_noeeprom();
+        led_matrix_mode_noeeprom(LED_MATRIX_SOLID);
+        driver_flushes = 0;
+    }
+
+    // A 16 bit level which gamma corrects to exactly the table entry, so the expected average is known
+    static uint16_t level_for(uint8_t entry) {
+        return uint16_t(entry) << 8;
+    }
+
+    static double expected_average(uint8_t entry) {
+        return CIE1931_CURVE_16[entry] / 256.0;
+    }
+
+    // Runs the task with user code setting every LED to the given level each loop, as an indicator would
+    void run(uint32_t ms, uint16_t level) {
+        for (uint32_t i = 0; i < ms; ++i) {
+            advance_time(1);
+            led_matrix_task();
+            led_matrix_set_value16_all(level);
+        }
+    }
+
+    template <typename F>
+    static double best_time(F&& work) {
+        double best = 1e12;
+        for (int run = 0; run < 7; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            for (int rep = 0; rep < 100; ++rep) {
+                work();
+            }
+            best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / 100);
+        }
+        return best;
+    }
+};
+
+TEST_F(LedMatrixDither, AveragesToSixteenBitLevel) {
+    const uint8_t entry = 40;
+    ASSERT_NE(CIE1931_CURVE_16[entry] & 0xFF, 0);
+    led_matrix_set_value16_all(level_for(entry));
+
+    uint32_t sum = 0;
+    for (int frame = 0; frame < 256; ++frame) {
+        led_matrix_update_pwm_buffers();
+        sum += driver_values[0];
+    }
+    EXPECT_NEAR(sum / 256.0, expected_average(entry), 1.0 / 256);
+}
+
+TEST_F(LedMatrixDither, KeepsFlushingUnderNone) {
+    const uint8_t entry = 40;
+    led_matrix_disable_noeeprom();
+    run(100, level_for(entry));
+
+    // Each flush only shows one of the two driver values either side of the level, so they have to keep coming
+    driver_flushes = 0;
+    uint32_t sum   = 0;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        uint32_t flushes = driver_flushes;
+        advance_time(1);
+        led_matrix_task();
+        led_matrix_set_value16_all(level_for(entry));
+        if (driver_flushes != flushes) {
+            sum += driver_values[0];
+        }
+    }
+    ASSERT_GE(driver_flushes, 1000u / LED_MATRIX_LED_FLUSH_LIMIT / 2);
+    EXPECT_NEAR(double(sum) / driver_flushes, expected_average(entry), 0.5);
+
+    // Once nothing is left between two driver values, LED_MATRIX_NONE goes back to flushing once
+    run(100, 0);
+    EXPECT_EQ(driver_values[0], 0);
+    driver_flushes = 0;
+    run(500, 0);
+    EXPECT_EQ(driver_flushes, 0u);
+}
+
+TEST_F(LedMatrixDither, FlushCost) {
+    for (uint8_t i = 0; i < LED_MATRIX_LED_COUNT; ++i) {
+        led_matrix_set_value16(i, i * 997);
+    }
+    double converted = best_time([] { led_matrix_update_pwm_buffers(); });
+
+    // What the 8 bit path costs per frame: gamma correcting each value as it is set, then flushing
+    double reference = best_time([] {
+        for (uint8_t i = 0; i < LED_MATRIX_LED_COUNT; ++i) {
+            led_matrix_driver.set_value(i, pgm_read_byte(&CIE1931_CURVE[(i * 997) >> 8]));
+        }
+        led_matrix_driver.flush();
+    });
+
+    RecordProperty("high_resolution_ns_per_frame", std::to_string(converted));
+    RecordProperty("eight_bit_ns_per_frame", std::to_string(reference));
+    RecordProperty("ns_per_led", std::to_string(converted / LED_MATRIX_LED_COUNT));
+    EXPECT_LT(converted, reference * 8);
+}
@@ -0,0 +1,14 @@
+led_matrix_dither_DEFS := -DLED_MATRIX_ENABLE -DUSE_CIE1931_CURVE -DEEPROM_TEST_HARNESS -DNO_DEBUG
+led_matrix_dither_CONFIG := $(QUANTUM_PATH)/led_matrix/tests/config_mock.h
+led_matrix_dither_INC := \
+	$(QUANTUM_PATH)/led_matrix \
+	$(QUANTUM_PATH)/led_matrix/animations \
+	$(QUANTUM_PATH)/led_matrix/animations/runners
+
+led_matrix_dither_SRC := \
+	$(QUANTUM_PATH)/led_matrix/tests/led_matrix_dither_tests.cpp \
+	$(QUANTUM_PATH)/led_matrix/led_matrix.c \
+	$(QUANTUM_PATH)/led_tables.c \
+	$(LIB_PATH)/lib8tion/lib8tion.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/eeprom.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
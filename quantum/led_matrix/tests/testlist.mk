@@ -0,0 +1,2 @@
+TEST_LIST += \
+	led_matrix_dither
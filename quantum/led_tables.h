@@ -19,5 +19,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdint.h>
 
 #ifdef USE_CIE1931_CURVE
-extern const uint8_t CIE1931_CURVE[] PROGMEM;
+extern const uint8_t  CIE1931_CURVE[] PROGMEM;
+extern const uint16_t CIE1931_CURVE_16[] PROGMEM;
 #endif
@@ -40,6 +40,50 @@
 #    define QUANTUM_PAINTER_LOAD_FONTS_TO_RAM FALSE
 #endif
 
+#ifndef QUANTUM_PAINTER_GLYPH_CACHE_SIZE
+/**
+ * @def This controls the number of bytes of RAM set aside for caching decoded font glyphs, in the display's native pixel
+ *      format. Glyphs which are drawn again with the same font, colors and display are sent straight from RAM, without
+ *      reading or decoding the font. The least recently drawn glyphs are dropped when it fills up. Set to 0 to disable.
+ */
+#    define QUANTUM_PAINTER_GLYPH_CACHE_SIZE 0
+#endif // QUANTUM_PAINTER_GLYPH_CACHE_SIZE
+
+#ifndef QUANTUM_PAINTER_GLYPH_CACHE_ENTRIES
+/**
+ * @def This controls the maximum number of glyphs held in the glyph cache, see \ref QUANTUM_PAINTER_GLYPH_CACHE_SIZE.
+ *      Each one uses an extra 32 bytes of RAM for bookkeeping.
+ */
+#    define QUANTUM_PAINTER_GLYPH_CACHE_ENTRIES 32
+#endif // QUANTUM_PAINTER_GLYPH_CACHE_ENTRIES
+
+#ifndef QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES
+/**
+ * @def This controls how many recolored palettes of up to 4bpp are kept after being converted to a display's native
+ *      pixel format, so that drawing text and images in a few different colors doesn't regenerate them every time. Each
+ *      one uses 84 bytes of RAM. Defaults to 0, where every palette is generated in the global lookup table, which holds
+ *      only one.
+ */
+#    define QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES 0
+#endif // QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES
+
+#ifndef QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE
+/**
+ * @def This controls how many bytes are read from external SPI flash at a time when images and fonts are loaded using
+ *      \ref qp_load_image_flash or \ref qp_load_font_flash. Larger blocks spread the cost of each flash transaction over
+ *      more data, at the cost of RAM. Needs to be a power of two, no larger than the flash's page size.
+ */
+#    define QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE 64
+#endif // QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE
+
+#ifndef QUANTUM_PAINTER_FLASH_STREAM_CACHE_BLOCKS
+/**
+ * @def This controls how many blocks of external SPI flash are kept in RAM, shared between all images and fonts loaded
+ *      from it, see \ref QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE. The least recently used block is replaced first.
+ */
+#    define QUANTUM_PAINTER_FLASH_STREAM_CACHE_BLOCKS 4
+#endif // QUANTUM_PAINTER_FLASH_STREAM_CACHE_BLOCKS
+
 #ifndef QUANTUM_PAINTER_CONCURRENT_ANIMATIONS
 /**
  * @def This controls the maximum number of animations that Quantum Painter can play simultaneously. Increasing this
@@ -48,6 +92,73 @@
 #    define QUANTUM_PAINTER_CONCURRENT_ANIMATIONS 4
 #endif // QUANTUM_PAINTER_CONCURRENT_ANIMATIONS
 
+#ifndef QUANTUM_PAINTER_ANIMATION_MIN_IDLE_MS
+/**
+ * @def This controls the minimum time, in milliseconds, left for the rest of the firmware between drawing frames of an
+ *      animation which has fallen behind schedule. Animations which are far enough behind skip ahead to the latest
+ *      non-delta frame which is already due, rather than drawing every frame back to back.
+ */
+#    define QUANTUM_PAINTER_ANIMATION_MIN_IDLE_MS 5
+#endif // QUANTUM_PAINTER_ANIMATION_MIN_IDLE_MS
+
+#ifndef QUANTUM_PAINTER_NUM_COMPOSITORS
+/**
+ * @def This controls the maximum number of layer compositors that can exist at any one time, see
+ *      \ref qp_compositor_make. Only used with QUANTUM_PAINTER_COMPOSITOR_ENABLE.
+ */
+#    define QUANTUM_PAINTER_NUM_COMPOSITORS 1
+#endif // QUANTUM_PAINTER_NUM_COMPOSITORS
+
+#ifndef QUANTUM_PAINTER_COMPOSITOR_MAX_LAYERS
+/**
+ * @def This controls the maximum number of layers each compositor holds. Each one uses around 32 bytes of RAM.
+ */
+#    define QUANTUM_PAINTER_COMPOSITOR_MAX_LAYERS 16
+#endif // QUANTUM_PAINTER_COMPOSITOR_MAX_LAYERS
+
+#ifndef QUANTUM_PAINTER_COMPOSITOR_TILE_WIDTH
+/**
+ * @def This controls the width of the tiles a compositor divides the display into. Each tile is rendered into a
+ *      scratch buffer of \ref QUANTUM_PAINTER_COMPOSITOR_TILE_WIDTH by \ref QUANTUM_PAINTER_COMPOSITOR_TILE_HEIGHT
+ *      pixels, which is shared between all compositors. Larger tiles send more data to the display in one go, but
+ *      redraw more of the screen for small changes.
+ */
+#    define QUANTUM_PAINTER_COMPOSITOR_TILE_WIDTH 16
+#endif // QUANTUM_PAINTER_COMPOSITOR_TILE_WIDTH
+
+#ifndef QUANTUM_PAINTER_COMPOSITOR_TILE_HEIGHT
+/**
+ * @def This controls the height of the tiles a compositor divides the display into, see
+ *      \ref QUANTUM_PAINTER_COMPOSITOR_TILE_WIDTH.
+ */
+#    define QUANTUM_PAINTER_COMPOSITOR_TILE_HEIGHT 16
+#endif // QUANTUM_PAINTER_COMPOSITOR_TILE_HEIGHT
+
+#ifndef QUANTUM_PAINTER_COMPOSITOR_MAX_TILES
+/**
+ * @def This controls the maximum number of tiles a compositor's display can be divided into. Each compositor uses one
+ *      bit of RAM per tile to track which ones need redrawing.
+ */
+#    define QUANTUM_PAINTER_COMPOSITOR_MAX_TILES 512
+#endif // QUANTUM_PAINTER_COMPOSITOR_MAX_TILES
+
+#ifndef QUANTUM_PAINTER_COMPOSITOR_MAX_BITS_PER_PIXEL
+/**
+ * @def This controls the largest native pixel format, in bits per pixel, of displays a compositor can be used with.
+ *      Sizes the tile scratch buffer. Needs to be a multiple of 8.
+ */
+#    define QUANTUM_PAINTER_COMPOSITOR_MAX_BITS_PER_PIXEL 16
+#endif // QUANTUM_PAINTER_COMPOSITOR_MAX_BITS_PER_PIXEL
+
+#ifndef QUANTUM_PAINTER_COMPOSITOR_IMAGE_CURSORS
+/**
+ * @def This controls how many image layers taller than a tile each compositor keeps the decoding position of, so each
+ *      row of tiles carries on decoding where the previous one got to instead of starting from the top of the image.
+ *      Each one uses around 300 bytes of RAM. Needs to be at least 1.
+ */
+#    define QUANTUM_PAINTER_COMPOSITOR_IMAGE_CURSORS 2
+#endif // QUANTUM_PAINTER_COMPOSITOR_IMAGE_CURSORS
+
 #ifndef QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE
 /**
  * @def This controls the maximum size of the pixel data buffer used for single blocks of transmission. Larger buffers
@@ -56,6 +167,24 @@
 #    define QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE 32
 #endif
 
+#ifndef QUANTUM_PAINTER_DECODE_BLOCK_PIXELS
+/**
+ * @def This controls how many pixels of images and fonts are decoded at a time. Decoding uses two buffers of this many
+ *      bytes on the stack. Needs to be a multiple of 8.
+ */
+#    define QUANTUM_PAINTER_DECODE_BLOCK_PIXELS 64
+#endif // QUANTUM_PAINTER_DECODE_BLOCK_PIXELS
+
+#ifndef QUANTUM_PAINTER_SPI_ASYNC
+/**
+ * @def This controls whether pixel data is sent to SPI displays in the background using DMA. Two pixel data buffers are
+ *      used, so that the next block of pixels can be decoded while the previous one is being transmitted. Drawing
+ *      functions wait for the last block before releasing the bus. Requires twice the RAM for
+ *      \ref QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE, and is only supported on ChibiOS.
+ */
+#    define QUANTUM_PAINTER_SPI_ASYNC FALSE
+#endif // QUANTUM_PAINTER_SPI_ASYNC
+
 #ifndef QUANTUM_PAINTER_SUPPORTS_256_PALETTE
 /**
  * @def This controls whether 256-color palettes are supported. This has relatively hefty requirements on RAM -- at
@@ -101,6 +230,18 @@ typedef struct painter_image_desc_t {
  */
 typedef const painter_image_desc_t *painter_image_handle_t;
 
+/**
+ * @typedef Playback statistics for a running Quantum Painter animation, see \ref qp_get_animation_stats.
+ */
+typedef struct painter_animation_stats_t {
+    uint32_t elapsed_ms;     ///< Time since the animation was started
+    uint32_t frames_drawn;   ///< Number of frames drawn since the animation was started
+    uint32_t frames_skipped; ///< Number of frames skipped in order to catch up, since the animation was started
+    uint16_t fps_x100;       ///< Average number of frames drawn per second, multiplied by 100
+    uint16_t last_frame_ms;  ///< Time taken to decode and send the most recent frame
+    uint16_t max_frame_ms;   ///< Longest time taken to decode and send a single frame
+} painter_animation_stats_t;
+
 /**
  * @typedef A descriptor for a Quantum Painter font.
  */
@@ -302,6 +443,21 @@ bool qp_pixdata(painter_device_t device, const void *pixel_data, uint32_t native
  */
 painter_image_handle_t qp_load_image_mem(const void *buffer);
 
+#ifdef QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+/**
+ * Loads an image stored in external SPI flash, such as one packed by `qmk painter-make-flash-image`. Image data is read
+ * from flash as it's drawn, through a small cache of flash blocks.
+ *
+ * @note Images can be unloaded by calling \ref qp_close_image.
+ *
+ * @param address[in] the address of the image data within the flash
+ * @return an image handle usable with \ref qp_drawimage, \ref qp_drawimage_recolor, \ref qp_animate, and
+ *         \ref qp_animate_recolor.
+ * @return NULL if loading the image failed
+ */
+painter_image_handle_t qp_load_image_flash(uint32_t address);
+#endif // QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+
 /**
  * Closes an image handle when no longer in use.
  *
@@ -378,6 +534,16 @@ deferred_token qp_animate_recolor(painter_device_t device, uint16_t x, uint16_t
  */
 void qp_stop_animation(deferred_token anim_token);
 
+/**
+ * Retrieves playback statistics for a running animation.
+ *
+ * @param anim_token[in] the animation token returned by \ref qp_animate, or \ref qp_animate_recolor.
+ * @param stats[out] the statistics for the animation
+ * @return true if the animation is running and the statistics were retrieved
+ * @return false if the animation token is not a running animation
+ */
+bool qp_get_animation_stats(deferred_token anim_token, painter_animation_stats_t *stats);
+
 /**
  * Loads a font into memory.
  *
@@ -389,6 +555,20 @@ void qp_stop_animation(deferred_token anim_token);
  */
 painter_font_handle_t qp_load_font_mem(const void *buffer);
 
+#ifdef QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+/**
+ * Loads a font stored in external SPI flash, such as one packed by `qmk painter-make-flash-image`. Font data is read from
+ * flash as it's drawn, through a small cache of flash blocks, unless \ref QUANTUM_PAINTER_LOAD_FONTS_TO_RAM is set.
+ *
+ * @note Fonts can be unloaded by calling \ref qp_close_font.
+ *
+ * @param address[in] the address of the font data within the flash
+ * @return an image handle usable with \ref qp_textwidth, \ref qp_drawtext, and \ref qp_drawtext_recolor.
+ * @return NULL if loading the font failed
+ */
+painter_font_handle_t qp_load_font_flash(uint32_t address);
+#endif // QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+
 /**
  * Closes a font handle when no longer in use.
  *
@@ -478,3 +658,7 @@ int16_t qp_drawtext_recolor(painter_device_t device, uint16_t x, uint16_t y, pai
 #ifdef QUANTUM_PAINTER_LVGL_INTEGRATION_ENABLE
 #    include "qp_lvgl.h"
 #endif // QUANTUM_PAINTER_LVGL_INTEGRATION_ENABLE
+
+#ifdef QUANTUM_PAINTER_COMPOSITOR_ENABLE
+#    include "qp_compositor.h"
+#endif // QUANTUM_PAINTER_COMPOSITOR_ENABLE
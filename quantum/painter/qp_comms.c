@@ -3,6 +3,9 @@
 
 #include "qp_comms.h"
 
+// The device whose comms have been started and not yet stopped
+static painter_device_t active_device = NULL;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Base comms APIs
 
@@ -23,7 +26,12 @@ bool qp_comms_start(painter_device_t device) {
         return false;
     }
 
-    return driver->comms_vtable->comms_start(device);
+    if (!driver->comms_vtable->comms_start(device)) {
+        return false;
+    }
+
+    active_device = device;
+    return true;
 }
 
 void qp_comms_stop(painter_device_t device) {
@@ -34,6 +42,17 @@ void qp_comms_stop(painter_device_t device) {
     }
 
     driver->comms_vtable->comms_stop(device);
+    if (active_device == device) {
+        active_device = NULL;
+    }
+}
+
+painter_device_t qp_comms_pause(void) {
+    painter_device_t device = active_device;
+    if (device) {
+        qp_comms_stop(device);
+    }
+    return device;
 }
 
 uint32_t qp_comms_send(painter_device_t device, const void *data, uint32_t byte_count) {
@@ -16,6 +16,10 @@ bool     qp_comms_start(painter_device_t device);
 void     qp_comms_stop(painter_device_t device);
 uint32_t qp_comms_send(painter_device_t device, const void* data, uint32_t byte_count);
 
+// Stops the comms of whichever device has them started, if any, so that something else on the same bus can use it. The
+// returned device needs its comms restarted with qp_comms_start() afterwards.
+painter_device_t qp_comms_pause(void);
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Comms APIs that use a D/C pin
 
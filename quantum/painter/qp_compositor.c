@@ -0,0 +1,668 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "qp_internal.h"
+#include "qp_draw.h"
+#include "qp_compositor.h"
+
+_Static_assert(QUANTUM_PAINTER_COMPOSITOR_MAX_LAYERS < INVALID_PAINTER_LAYER, "QUANTUM_PAINTER_COMPOSITOR_MAX_LAYERS needs to be less than 255");
+_Static_assert(QUANTUM_PAINTER_COMPOSITOR_IMAGE_CURSORS > 0 && QUANTUM_PAINTER_COMPOSITOR_IMAGE_CURSORS < 255, "QUANTUM_PAINTER_COMPOSITOR_IMAGE_CURSORS needs to be between 1 and 254");
+_Static_assert((QUANTUM_PAINTER_COMPOSITOR_MAX_BITS_PER_PIXEL > 0) && (QUANTUM_PAINTER_COMPOSITOR_MAX_BITS_PER_PIXEL % 8) == 0, "QUANTUM_PAINTER_COMPOSITOR_MAX_BITS_PER_PIXEL needs to be a non-zero multiple of 8");
+
+#define QP_COMPOSITOR_MAX_BYTES_PER_PIXEL (QUANTUM_PAINTER_COMPOSITOR_MAX_BITS_PER_PIXEL / 8)
+#define QP_COMPOSITOR_NO_CURSOR 0xFF
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Compositor definitions
+
+typedef enum qp_compositor_layer_type_t {
+    QP_COMPOSITOR_LAYER_RECT,
+    QP_COMPOSITOR_LAYER_IMAGE,
+    QP_COMPOSITOR_LAYER_TEXT,
+} qp_compositor_layer_type_t;
+
+typedef struct qp_compositor_layer_t {
+    uint8_t    type; // qp_compositor_layer_type_t
+    bool       visible;
+    bool       color_key;
+    uint8_t    cursor; // index of the image cursor used by this layer during a render, or QP_COMPOSITOR_NO_CURSOR
+    qp_pixel_t fg_hsv888;
+    qp_pixel_t bg_hsv888;
+    qp_pixel_t key_hsv888;
+
+    // Area covered by the layer, empty if either dimension is zero
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+
+    union {
+        painter_image_handle_t image;
+        struct {
+            painter_font_handle_t font;
+            const char           *str;
+        } text;
+    };
+} qp_compositor_layer_t;
+
+// The compositor is also the device that layers are drawn to, which only keeps the pixels landing in the current tile
+typedef struct qp_compositor_t {
+    struct painter_driver_t base; // must be first, so it can be cast to/from the painter_device_t* type
+
+    painter_device_t display;
+    qp_pixel_t       background_hsv888;
+    uint8_t          bytes_per_pixel;
+    uint16_t         tiles_x;
+    uint16_t         tiles_y;
+
+    // The tile currently being drawn, inclusive on all sides
+    uint16_t tile_l;
+    uint16_t tile_t;
+    uint16_t tile_r;
+    uint16_t tile_b;
+
+    // Manually manage the viewport for streaming pixel data into the tile
+    uint16_t viewport_l;
+    uint16_t viewport_t;
+    uint16_t viewport_r;
+    uint16_t viewport_b;
+    uint16_t pixdata_x;
+    uint16_t pixdata_y;
+
+    // Pixels of the layer being drawn which match this are skipped, if enabled
+    bool                            keyed;
+    __attribute__((__aligned__(4))) uint8_t key[QP_COMPOSITOR_MAX_BYTES_PER_PIXEL];
+
+    uint8_t               layer_count;
+    qp_compositor_layer_t layers[QUANTUM_PAINTER_COMPOSITOR_MAX_LAYERS];
+
+    // Tiles are rendered a row at a time, top to bottom, so tall images carry on decoding from the row above
+    qp_internal_image_cursor_t image_cursors[QUANTUM_PAINTER_COMPOSITOR_IMAGE_CURSORS];
+
+    // One bit per tile which needs redrawing
+    uint8_t dirty[(QUANTUM_PAINTER_COMPOSITOR_MAX_TILES + 7) / 8];
+} qp_compositor_t;
+
+// Compositor storage
+static qp_compositor_t compositors[QUANTUM_PAINTER_NUM_COMPOSITORS] = {0};
+
+// Tiles are drawn and sent one at a time, so the scratch buffer is shared between compositors. It's transmitted from
+// directly rather than through the pixdata buffers, so is always sent synchronously.
+__attribute__((__aligned__(4))) static uint8_t tile_buffer[QUANTUM_PAINTER_COMPOSITOR_TILE_WIDTH * QUANTUM_PAINTER_COMPOSITOR_TILE_HEIGHT * QP_COMPOSITOR_MAX_BYTES_PER_PIXEL];
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+
+static inline qp_compositor_t *qp_compositor_from_handle(painter_compositor_t handle) {
+    qp_compositor_t *compositor = (qp_compositor_t *)handle;
+    return (compositor && compositor->display) ? compositor : NULL;
+}
+
+static inline qp_compositor_layer_t *qp_compositor_get_layer(painter_compositor_t handle, painter_layer_t layer) {
+    qp_compositor_t *compositor = qp_compositor_from_handle(handle);
+    return (compositor && layer < compositor->layer_count) ? &compositor->layers[layer] : NULL;
+}
+
+static inline uint16_t qp_compositor_tile_width(qp_compositor_t *compositor) {
+    return compositor->tile_r - compositor->tile_l + 1;
+}
+
+// Converts a color to the display's native pixel format
+static void qp_compositor_native_color(qp_compositor_t *compositor, qp_pixel_t hsv888, uint8_t *native) {
+    struct painter_driver_t *display     = (struct painter_driver_t *)compositor->display;
+    uint8_t                  palette_idx = 0;
+    display->driver_vtable->palette_convert(compositor->display, 1, &hsv888);
+    display->driver_vtable->append_pixels(compositor->display, native, &hsv888, 0, 1, &palette_idx);
+}
+
+static void qp_compositor_mark_dirty(qp_compositor_t *compositor, uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+    if (width == 0 || height == 0 || x >= compositor->base.panel_width || y >= compositor->base.panel_height) {
+        return;
+    }
+
+    uint16_t tx0 = x / QUANTUM_PAINTER_COMPOSITOR_TILE_WIDTH;
+    uint16_t ty0 = y / QUANTUM_PAINTER_COMPOSITOR_TILE_HEIGHT;
+    uint16_t tx1 = QP_MIN((uint32_t)x + width - 1, compositor->base.panel_width - 1) / QUANTUM_PAINTER_COMPOSITOR_TILE_WIDTH;
+    uint16_t ty1 = QP_MIN((uint32_t)y + height - 1, compositor->base.panel_height - 1) / QUANTUM_PAINTER_COMPOSITOR_TILE_HEIGHT;
+    for (uint16_t ty = ty0; ty <= ty1; ++ty) {
+        for (uint16_t tx = tx0; tx <= tx1; ++tx) {
+            uint16_t tile = ty * compositor->tiles_x + tx;
+            compositor->dirty[tile / 8] |= 1 << (tile % 8);
+        }
+    }
+}
+
+static inline void qp_compositor_mark_layer_dirty(qp_compositor_t *compositor, qp_compositor_layer_t *layer) {
+    if (layer->visible) {
+        qp_compositor_mark_dirty(compositor, layer->x, layer->y, layer->width, layer->height);
+    }
+}
+
+// Works out the area covered by image and text layers from their contents
+static void qp_compositor_update_size(qp_compositor_layer_t *layer) {
+    switch (layer->type) {
+        case QP_COMPOSITOR_LAYER_IMAGE:
+            layer->width  = layer->image ? layer->image->width : 0;
+            layer->height = layer->image ? layer->image->height : 0;
+            break;
+        case QP_COMPOSITOR_LAYER_TEXT: {
+            int16_t width = (layer->text.font && layer->text.str) ? qp_textwidth(layer->text.font, layer->text.str) : 0;
+            layer->width  = width > 0 ? width : 0;
+            layer->height = layer->text.font ? layer->text.font->line_height : 0;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static painter_layer_t qp_compositor_add_layer(painter_compositor_t handle, const qp_compositor_layer_t *layer) {
+    qp_compositor_t *compositor = qp_compositor_from_handle(handle);
+    if (!compositor || compositor->layer_count >= QUANTUM_PAINTER_COMPOSITOR_MAX_LAYERS) {
+        qp_dprintf("qp_compositor_add_layer: fail (no free layers)\n");
+        return INVALID_PAINTER_LAYER;
+    }
+
+    painter_layer_t        index = compositor->layer_count++;
+    qp_compositor_layer_t *added = &compositor->layers[index];
+    *added                       = *layer;
+    added->visible               = true;
+    qp_compositor_update_size(added);
+    qp_compositor_mark_layer_dirty(compositor, added);
+    return index;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tile drawing
+
+// Fills part of the tile with a solid native color
+static void qp_compositor_fill(qp_compositor_t *compositor, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom, const uint8_t *native) {
+    uint8_t  bpp    = compositor->bytes_per_pixel;
+    uint32_t stride = qp_compositor_tile_width(compositor) * bpp;
+    uint8_t *first  = &tile_buffer[(top - compositor->tile_t) * stride + (left - compositor->tile_l) * bpp];
+    uint32_t length = (right - left + 1) * bpp;
+
+    // Fill the first row a pixel at a time, then copy it to the rest
+    for (uint32_t i = 0; i < length; i += bpp) {
+        memcpy(&first[i], native, bpp);
+    }
+    for (uint16_t y = top + 1; y <= bottom; ++y) {
+        memcpy(first + (y - top) * stride, first, length);
+    }
+}
+
+static bool qp_compositor_draw_layer(qp_compositor_t *compositor, qp_compositor_layer_t *layer) {
+    // Only the part of the layer within the tile is kept
+    uint16_t left   = QP_MAX(layer->x, compositor->tile_l);
+    uint16_t top    = QP_MAX(layer->y, compositor->tile_t);
+    uint16_t right  = QP_MIN((uint32_t)layer->x + layer->width - 1, compositor->tile_r);
+    uint16_t bottom = QP_MIN((uint32_t)layer->y + layer->height - 1, compositor->tile_b);
+    if (!layer->visible || layer->width == 0 || layer->height == 0 || left > right || top > bottom) {
+        return true;
+    }
+
+    // Rectangles are filled straight into the tile, rather than sending the whole rectangle through pixdata
+    if (layer->type == QP_COMPOSITOR_LAYER_RECT) {
+        __attribute__((__aligned__(4))) uint8_t native[QP_COMPOSITOR_MAX_BYTES_PER_PIXEL];
+        qp_compositor_native_color(compositor, layer->fg_hsv888, native);
+        qp_compositor_fill(compositor, left, top, right, bottom, native);
+        return true;
+    }
+
+    compositor->keyed = layer->color_key;
+    if (layer->color_key) {
+        qp_compositor_native_color(compositor, layer->key_hsv888, compositor->key);
+    }
+
+    painter_device_t device = (painter_device_t)compositor;
+    qp_pixel_t       fg     = layer->fg_hsv888;
+    qp_pixel_t       bg     = layer->bg_hsv888;
+    if (layer->type == QP_COMPOSITOR_LAYER_IMAGE) {
+        // Only the rows landing in the tile are decoded, anything to either side is dropped by pixdata
+        qp_internal_image_cursor_t *cursor = (layer->cursor != QP_COMPOSITOR_NO_CURSOR) ? &compositor->image_cursors[layer->cursor] : NULL;
+        return qp_internal_drawimage_rows(device, layer->x, layer->y, layer->image, top - layer->y, bottom - layer->y, fg, bg, cursor);
+    }
+
+    // Text is drawn a glyph at a time, side by side, so is drawn in full
+    return qp_drawtext_recolor(device, layer->x, layer->y, layer->text.font, layer->text.str, fg.hsv888.h, fg.hsv888.s, fg.hsv888.v, bg.hsv888.h, bg.hsv888.s, bg.hsv888.v) > 0;
+}
+
+static bool qp_compositor_render_tile(qp_compositor_t *compositor, uint16_t tx, uint16_t ty) {
+    compositor->tile_l = tx * QUANTUM_PAINTER_COMPOSITOR_TILE_WIDTH;
+    compositor->tile_t = ty * QUANTUM_PAINTER_COMPOSITOR_TILE_HEIGHT;
+    compositor->tile_r = QP_MIN(compositor->tile_l + QUANTUM_PAINTER_COMPOSITOR_TILE_WIDTH, compositor->base.panel_width) - 1;
+    compositor->tile_b = QP_MIN(compositor->tile_t + QUANTUM_PAINTER_COMPOSITOR_TILE_HEIGHT, compositor->base.panel_height) - 1;
+
+    __attribute__((__aligned__(4))) uint8_t background[QP_COMPOSITOR_MAX_BYTES_PER_PIXEL];
+    qp_compositor_native_color(compositor, compositor->background_hsv888, background);
+    qp_compositor_fill(compositor, compositor->tile_l, compositor->tile_t, compositor->tile_r, compositor->tile_b, background);
+
+    for (uint8_t i = 0; i < compositor->layer_count; ++i) {
+        if (!qp_compositor_draw_layer(compositor, &compositor->layers[i])) {
+            qp_dprintf("qp_compositor_render_tile: fail (could not draw layer %d)\n", (int)i);
+            return false;
+        }
+    }
+
+    uint32_t pixel_count = ((uint32_t)qp_compositor_tile_width(compositor)) * (compositor->tile_b - compositor->tile_t + 1);
+    return qp_viewport(compositor->display, compositor->tile_l, compositor->tile_t, compositor->tile_r, compositor->tile_b) && qp_pixdata(compositor->display, tile_buffer, pixel_count);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Driver vtable
+
+static bool qp_compositor_init(painter_device_t device, painter_rotation_t rotation) {
+    // No-op.
+    return true;
+}
+
+static bool qp_compositor_power(painter_device_t device, bool power_on) {
+    // No-op.
+    return true;
+}
+
+static bool qp_compositor_clear_device(painter_device_t device) {
+    // No-op.
+    return true;
+}
+
+static bool qp_compositor_flush(painter_device_t device) {
+    // No-op.
+    return true;
+}
+
+static bool qp_compositor_viewport(painter_device_t device, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom) {
+    qp_compositor_t *compositor = (qp_compositor_t *)device;
+
+    // Set the viewport locations
+    compositor->viewport_l = left;
+    compositor->viewport_t = top;
+    compositor->viewport_r = right;
+    compositor->viewport_b = bottom;
+
+    // Reset the write location to the top left
+    compositor->pixdata_x = left;
+    compositor->pixdata_y = top;
+    return true;
+}
+
+// Copies the part of each row of pixel data which lands within the tile, dropping the rest
+static bool qp_compositor_pixdata(painter_device_t device, const void *pixel_data, uint32_t native_pixel_count) {
+    qp_compositor_t *compositor = (qp_compositor_t *)device;
+    const uint8_t   *source     = (const uint8_t *)pixel_data;
+    uint8_t          bpp        = compositor->bytes_per_pixel;
+
+    while (native_pixel_count > 0) {
+        uint32_t count = QP_MIN(native_pixel_count, (uint32_t)compositor->viewport_r - compositor->pixdata_x + 1);
+
+        if (compositor->pixdata_y >= compositor->tile_t && compositor->pixdata_y <= compositor->tile_b) {
+            uint16_t left  = QP_MAX(compositor->pixdata_x, compositor->tile_l);
+            uint16_t right = QP_MIN(compositor->pixdata_x + count - 1, compositor->tile_r);
+            if (left <= right) {
+                const uint8_t *from   = source + (left - compositor->pixdata_x) * bpp;
+                uint8_t       *to     = &tile_buffer[((compositor->pixdata_y - compositor->tile_t) * qp_compositor_tile_width(compositor) + (left - compositor->tile_l)) * bpp];
+                uint32_t       length = (right - left + 1) * bpp;
+                if (!compositor->keyed) {
+                    memcpy(to, from, length);
+                } else {
+                    for (uint32_t i = 0; i < length; i += bpp) {
+                        if (memcmp(&from[i], compositor->key, bpp) != 0) {
+                            memcpy(&to[i], &from[i], bpp);
+                        }
+                    }
+                }
+            }
+        }
+
+        source += count * bpp;
+        native_pixel_count -= count;
+        compositor->pixdata_x += count;
+
+        // Move to the next row, looping back to the top like a display would
+        if (compositor->pixdata_x > compositor->viewport_r) {
+            compositor->pixdata_x = compositor->viewport_l;
+            compositor->pixdata_y++;
+            if (compositor->pixdata_y > compositor->viewport_b) {
+                compositor->pixdata_y = compositor->viewport_t;
+            }
+        }
+    }
+    return true;
+}
+
+// Pixel formats are the display's, so conversion is left to its driver
+static bool qp_compositor_palette_convert(painter_device_t device, int16_t palette_size, qp_pixel_t *palette) {
+    qp_compositor_t         *compositor = (qp_compositor_t *)device;
+    struct painter_driver_t *display    = (struct painter_driver_t *)compositor->display;
+    return display->driver_vtable->palette_convert(compositor->display, palette_size, palette);
+}
+
+static bool qp_compositor_append_pixels(painter_device_t device, uint8_t *target_buffer, qp_pixel_t *palette, uint32_t pixel_offset, uint32_t pixel_count, uint8_t *palette_indices) {
+    qp_compositor_t         *compositor = (qp_compositor_t *)device;
+    struct painter_driver_t *display    = (struct painter_driver_t *)compositor->display;
+    return display->driver_vtable->append_pixels(compositor->display, target_buffer, palette, pixel_offset, pixel_count, palette_indices);
+}
+
+static bool qp_compositor_append_pixdata(painter_device_t device, uint8_t *target_buffer, uint32_t pixdata_offset, uint8_t pixdata_byte) {
+    qp_compositor_t         *compositor = (qp_compositor_t *)device;
+    struct painter_driver_t *display    = (struct painter_driver_t *)compositor->display;
+    return display->driver_vtable->append_pixdata(compositor->display, target_buffer, pixdata_offset, pixdata_byte);
+}
+
+static const struct painter_driver_vtable_t qp_compositor_driver_vtable = {
+    .init            = qp_compositor_init,
+    .power           = qp_compositor_power,
+    .clear           = qp_compositor_clear_device,
+    .flush           = qp_compositor_flush,
+    .pixdata         = qp_compositor_pixdata,
+    .viewport        = qp_compositor_viewport,
+    .palette_convert = qp_compositor_palette_convert,
+    .append_pixels   = qp_compositor_append_pixels,
+    .append_pixdata  = qp_compositor_append_pixdata,
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Comms vtable
+
+static bool qp_compositor_comms_init(painter_device_t device) {
+    // No-op.
+    return true;
+}
+
+static bool qp_compositor_comms_start(painter_device_t device) {
+    // No-op.
+    return true;
+}
+
+static void qp_compositor_comms_stop(painter_device_t device) {
+    // No-op.
+}
+
+static uint32_t qp_compositor_comms_send(painter_device_t device, const void *data, uint32_t byte_count) {
+    // No-op.
+    return byte_count;
+}
+
+static const struct painter_comms_vtable_t qp_compositor_comms_vtable = {
+    // These are all effective no-op's because they're not actually needed.
+    .comms_init  = qp_compositor_comms_init,
+    .comms_start = qp_compositor_comms_start,
+    .comms_stop  = qp_compositor_comms_stop,
+    .comms_send  = qp_compositor_comms_send,
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter External API: qp_compositor_make
+
+painter_compositor_t qp_compositor_make(painter_device_t display, uint8_t hue, uint8_t sat, uint8_t val) {
+    qp_dprintf("qp_compositor_make: entry\n");
+    struct painter_driver_t *driver = (struct painter_driver_t *)display;
+    if (!driver || !driver->validate_ok) {
+        qp_dprintf("qp_compositor_make: fail (validation_ok == false)\n");
+        return NULL;
+    }
+
+    // Tiles are kept in the display's native format, so pixels need to be whole bytes
+    if (driver->native_bits_per_pixel == 0 || (driver->native_bits_per_pixel % 8) != 0 || driver->native_bits_per_pixel > QUANTUM_PAINTER_COMPOSITOR_MAX_BITS_PER_PIXEL) {
+        qp_dprintf("qp_compositor_make: fail (unsupported pixel format)\n");
+        return NULL;
+    }
+
+    uint16_t width, height;
+    qp_get_geometry(display, &width, &height, NULL, NULL, NULL);
+    uint16_t tiles_x = (width + QUANTUM_PAINTER_COMPOSITOR_TILE_WIDTH - 1) / QUANTUM_PAINTER_COMPOSITOR_TILE_WIDTH;
+    uint16_t tiles_y = (height + QUANTUM_PAINTER_COMPOSITOR_TILE_HEIGHT - 1) / QUANTUM_PAINTER_COMPOSITOR_TILE_HEIGHT;
+    if ((uint32_t)tiles_x * tiles_y > QUANTUM_PAINTER_COMPOSITOR_MAX_TILES) {
+        qp_dprintf("qp_compositor_make: fail (too many tiles)\n");
+        return NULL;
+    }
+
+    for (uint8_t i = 0; i < QUANTUM_PAINTER_NUM_COMPOSITORS; ++i) {
+        qp_compositor_t *compositor = &compositors[i];
+        if (!compositor->display) {
+            memset(compositor, 0, sizeof(qp_compositor_t));
+            compositor->base.driver_vtable         = &qp_compositor_driver_vtable;
+            compositor->base.comms_vtable          = &qp_compositor_comms_vtable;
+            compositor->base.native_bits_per_pixel = driver->native_bits_per_pixel;
+            compositor->base.panel_width           = width;
+            compositor->base.panel_height          = height;
+            compositor->display                    = display;
+            compositor->background_hsv888          = (qp_pixel_t){.hsv888 = {.h = hue, .s = sat, .v = val}};
+            compositor->bytes_per_pixel            = driver->native_bits_per_pixel / 8;
+            compositor->tiles_x                    = tiles_x;
+            compositor->tiles_y                    = tiles_y;
+            if (!qp_init((painter_device_t)compositor, QP_ROTATION_0)) {
+                compositor->display = NULL;
+                return NULL;
+            }
+
+            // Palettes cached for a previous compositor in this slot may have been for a different pixel format
+            qp_internal_invalidate_palette();
+
+            // Whatever the display shows doesn't match yet
+            qp_compositor_invalidate((painter_compositor_t)compositor);
+            qp_dprintf("qp_compositor_make: ok\n");
+            return (painter_compositor_t)compositor;
+        }
+    }
+
+    qp_dprintf("qp_compositor_make: fail (no free compositors)\n");
+    return NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter External API: qp_compositor_close
+
+bool qp_compositor_close(painter_compositor_t handle) {
+    qp_compositor_t *compositor = qp_compositor_from_handle(handle);
+    if (!compositor) {
+        qp_dprintf("qp_compositor_close: fail (invalid compositor)\n");
+        return false;
+    }
+
+    // Free up this compositor for reuse
+    compositor->display          = NULL;
+    compositor->base.validate_ok = false;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter External API: qp_compositor_add_*
+
+painter_layer_t qp_compositor_add_rect(painter_compositor_t compositor, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom, uint8_t hue, uint8_t sat, uint8_t val) {
+    qp_compositor_layer_t layer = {
+        .type      = QP_COMPOSITOR_LAYER_RECT,
+        .fg_hsv888 = {.hsv888 = {.h = hue, .s = sat, .v = val}},
+        .x         = left,
+        .y         = top,
+        .width     = (right >= left) ? right - left + 1 : 0,
+        .height    = (bottom >= top) ? bottom - top + 1 : 0,
+    };
+    return qp_compositor_add_layer(compositor, &layer);
+}
+
+painter_layer_t qp_compositor_add_image(painter_compositor_t compositor, uint16_t x, uint16_t y, painter_image_handle_t image) {
+    // Same defaults as qp_drawimage
+    return qp_compositor_add_image_recolor(compositor, x, y, image, 0, 0, 255, 0, 0, 0);
+}
+
+painter_layer_t qp_compositor_add_image_recolor(painter_compositor_t compositor, uint16_t x, uint16_t y, painter_image_handle_t image, uint8_t hue_fg, uint8_t sat_fg, uint8_t val_fg, uint8_t hue_bg, uint8_t sat_bg, uint8_t val_bg) {
+    qp_compositor_layer_t layer = {
+        .type      = QP_COMPOSITOR_LAYER_IMAGE,
+        .fg_hsv888 = {.hsv888 = {.h = hue_fg, .s = sat_fg, .v = val_fg}},
+        .bg_hsv888 = {.hsv888 = {.h = hue_bg, .s = sat_bg, .v = val_bg}},
+        .x         = x,
+        .y         = y,
+        .image     = image,
+    };
+    return qp_compositor_add_layer(compositor, &layer);
+}
+
+painter_layer_t qp_compositor_add_text(painter_compositor_t compositor, uint16_t x, uint16_t y, painter_font_handle_t font, const char *str) {
+    // Same defaults as qp_drawtext
+    return qp_compositor_add_text_recolor(compositor, x, y, font, str, 0, 0, 255, 0, 0, 0);
+}
+
+painter_layer_t qp_compositor_add_text_recolor(painter_compositor_t compositor, uint16_t x, uint16_t y, painter_font_handle_t font, const char *str, uint8_t hue_fg, uint8_t sat_fg, uint8_t val_fg, uint8_t hue_bg, uint8_t sat_bg, uint8_t val_bg) {
+    qp_compositor_layer_t layer = {
+        .type      = QP_COMPOSITOR_LAYER_TEXT,
+        .fg_hsv888 = {.hsv888 = {.h = hue_fg, .s = sat_fg, .v = val_fg}},
+        .bg_hsv888 = {.hsv888 = {.h = hue_bg, .s = sat_bg, .v = val_bg}},
+        .x         = x,
+        .y         = y,
+        .text      = {.font = font, .str = str},
+    };
+    return qp_compositor_add_layer(compositor, &layer);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter External API: layer updates
+//
+// Each marks the tiles covered by the layer both before and after the change for redrawing.
+
+bool qp_compositor_move(painter_compositor_t compositor, painter_layer_t layer, uint16_t x, uint16_t y) {
+    qp_compositor_layer_t *target = qp_compositor_get_layer(compositor, layer);
+    if (!target) {
+        return false;
+    }
+
+    if (target->x != x || target->y != y) {
+        qp_compositor_mark_layer_dirty((qp_compositor_t *)compositor, target);
+        target->x = x;
+        target->y = y;
+        qp_compositor_mark_layer_dirty((qp_compositor_t *)compositor, target);
+    }
+    return true;
+}
+
+bool qp_compositor_set_visible(painter_compositor_t compositor, painter_layer_t layer, bool visible) {
+    qp_compositor_layer_t *target = qp_compositor_get_layer(compositor, layer);
+    if (!target) {
+        return false;
+    }
+
+    if (target->visible != visible) {
+        target->visible = true;
+        qp_compositor_mark_layer_dirty((qp_compositor_t *)compositor, target);
+        target->visible = visible;
+    }
+    return true;
+}
+
+bool qp_compositor_set_colors(painter_compositor_t compositor, painter_layer_t layer, uint8_t hue_fg, uint8_t sat_fg, uint8_t val_fg, uint8_t hue_bg, uint8_t sat_bg, uint8_t val_bg) {
+    qp_compositor_layer_t *target = qp_compositor_get_layer(compositor, layer);
+    if (!target) {
+        return false;
+    }
+
+    target->fg_hsv888 = (qp_pixel_t){.hsv888 = {.h = hue_fg, .s = sat_fg, .v = val_fg}};
+    target->bg_hsv888 = (qp_pixel_t){.hsv888 = {.h = hue_bg, .s = sat_bg, .v = val_bg}};
+    qp_compositor_mark_layer_dirty((qp_compositor_t *)compositor, target);
+    return true;
+}
+
+bool qp_compositor_set_color_key(painter_compositor_t compositor, painter_layer_t layer, bool transparent, uint8_t hue, uint8_t sat, uint8_t val) {
+    qp_compositor_layer_t *target = qp_compositor_get_layer(compositor, layer);
+    if (!target || target->type == QP_COMPOSITOR_LAYER_RECT) {
+        return false;
+    }
+
+    target->color_key  = transparent;
+    target->key_hsv888 = (qp_pixel_t){.hsv888 = {.h = hue, .s = sat, .v = val}};
+    qp_compositor_mark_layer_dirty((qp_compositor_t *)compositor, target);
+    return true;
+}
+
+bool qp_compositor_set_image(painter_compositor_t compositor, painter_layer_t layer, painter_image_handle_t image) {
+    qp_compositor_layer_t *target = qp_compositor_get_layer(compositor, layer);
+    if (!target || target->type != QP_COMPOSITOR_LAYER_IMAGE) {
+        return false;
+    }
+
+    qp_compositor_mark_layer_dirty((qp_compositor_t *)compositor, target);
+    target->image = image;
+    qp_compositor_update_size(target);
+    qp_compositor_mark_layer_dirty((qp_compositor_t *)compositor, target);
+    return true;
+}
+
+bool qp_compositor_set_text(painter_compositor_t compositor, painter_layer_t layer, const char *str) {
+    qp_compositor_layer_t *target = qp_compositor_get_layer(compositor, layer);
+    if (!target || target->type != QP_COMPOSITOR_LAYER_TEXT) {
+        return false;
+    }
+
+    // The old size is kept, so whatever was covered by the previous string gets redrawn even if it was modified in place
+    qp_compositor_mark_layer_dirty((qp_compositor_t *)compositor, target);
+    target->text.str = str;
+    qp_compositor_update_size(target);
+    qp_compositor_mark_layer_dirty((qp_compositor_t *)compositor, target);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter External API: qp_compositor_clear
+
+bool qp_compositor_clear(painter_compositor_t handle) {
+    qp_compositor_t *compositor = qp_compositor_from_handle(handle);
+    if (!compositor) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < compositor->layer_count; ++i) {
+        qp_compositor_mark_layer_dirty(compositor, &compositor->layers[i]);
+    }
+    compositor->layer_count = 0;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter External API: qp_compositor_invalidate
+
+void qp_compositor_invalidate(painter_compositor_t handle) {
+    qp_compositor_t *compositor = qp_compositor_from_handle(handle);
+    if (compositor) {
+        qp_compositor_mark_dirty(compositor, 0, 0, compositor->base.panel_width, compositor->base.panel_height);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter External API: qp_compositor_render
+
+bool qp_compositor_render(painter_compositor_t handle) {
+    qp_dprintf("qp_compositor_render: entry\n");
+    qp_compositor_t *compositor = qp_compositor_from_handle(handle);
+    if (!compositor) {
+        qp_dprintf("qp_compositor_render: fail (invalid compositor)\n");
+        return false;
+    }
+
+    // Images may have changed since the last render, so cursors start again from the top of each one
+    uint8_t cursors = 0;
+    for (uint8_t i = 0; i < compositor->layer_count; ++i) {
+        qp_compositor_layer_t *layer = &compositor->layers[i];
+        layer->cursor                = QP_COMPOSITOR_NO_CURSOR;
+        if (layer->type == QP_COMPOSITOR_LAYER_IMAGE && layer->visible && layer->height > QUANTUM_PAINTER_COMPOSITOR_TILE_HEIGHT && cursors < QUANTUM_PAINTER_COMPOSITOR_IMAGE_CURSORS) {
+            compositor->image_cursors[cursors].image = NULL;
+            layer->cursor                            = cursors++;
+        }
+    }
+
+    for (uint16_t ty = 0; ty < compositor->tiles_y; ++ty) {
+        for (uint16_t tx = 0; tx < compositor->tiles_x; ++tx) {
+            uint16_t tile = ty * compositor->tiles_x + tx;
+            if (!(compositor->dirty[tile / 8] & (1 << (tile % 8)))) {
+                continue;
+            }
+
+            if (!qp_compositor_render_tile(compositor, tx, ty)) {
+                qp_dprintf("qp_compositor_render: fail (could not render tile %d)\n", (int)tile);
+                return false;
+            }
+            compositor->dirty[tile / 8] &= ~(1 << (tile % 8));
+        }
+    }
+
+    qp_dprintf("qp_compositor_render: ok\n");
+    return true;
+}
@@ -0,0 +1,229 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "qp.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter - Compositor types
+
+/**
+ * @typedef A handle to a Quantum Painter compositor, which holds a list of layers drawn onto a display.
+ */
+typedef const void *painter_compositor_t;
+
+/**
+ * @typedef A handle to a layer within a compositor. Layers are drawn in the order they were added, so later layers are
+ *          drawn over the top of earlier ones.
+ */
+typedef uint8_t painter_layer_t;
+
+/**
+ * @def The value returned when a layer could not be added to a compositor.
+ */
+#define INVALID_PAINTER_LAYER ((painter_layer_t)0xFF)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter - Compositor External API
+
+/**
+ * Creates a compositor for the supplied display, which is divided up into tiles of
+ * \ref QUANTUM_PAINTER_COMPOSITOR_TILE_WIDTH by \ref QUANTUM_PAINTER_COMPOSITOR_TILE_HEIGHT pixels. Only tiles whose
+ * layers have changed are redrawn by \ref qp_compositor_render.
+ *
+ * @note The display needs to be initialised with \ref qp_init first, and the compositor remade if its rotation changes.
+ *
+ * @param display[in] the handle of the device to draw to
+ * @param hue[in] the hue of the background, drawn underneath all the layers, with 0-360 mapped to 0-255
+ * @param sat[in] the saturation of the background, with 0-100% mapped to 0-255
+ * @param val[in] the value of the background, with 0-100% mapped to 0-255
+ * @return handle to the compositor, or NULL if the display is unsupported or there are no free compositors
+ */
+painter_compositor_t qp_compositor_make(painter_device_t display, uint8_t hue, uint8_t sat, uint8_t val);
+
+/**
+ * Frees a compositor, so that another can be made in its place. Nothing is drawn to the display.
+ *
+ * @param compositor[in] the handle of the compositor to free
+ * @return true if the compositor was freed
+ * @return false if the handle was invalid
+ */
+bool qp_compositor_close(painter_compositor_t compositor);
+
+/**
+ * Adds a filled rectangle layer.
+ *
+ * @param compositor[in] the handle of the compositor
+ * @param left[in] the x-position of the left side of the rectangle
+ * @param top[in] the y-position of the top side of the rectangle
+ * @param right[in] the x-position of the right side of the rectangle
+ * @param bottom[in] the y-position of the bottom side of the rectangle
+ * @param hue[in] the hue to use, with 0-360 mapped to 0-255
+ * @param sat[in] the saturation to use, with 0-100% mapped to 0-255
+ * @param val[in] the value to use, with 0-100% mapped to 0-255
+ * @return handle to the layer, or INVALID_PAINTER_LAYER if the compositor is full
+ */
+painter_layer_t qp_compositor_add_rect(painter_compositor_t compositor, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom, uint8_t hue, uint8_t sat, uint8_t val);
+
+/**
+ * Adds an image layer, drawn using the first frame of the image.
+ *
+ * @param compositor[in] the handle of the compositor
+ * @param x[in] the x-position where the image should be drawn
+ * @param y[in] the y-position where the image should be drawn
+ * @param image[in] the handle of the image, which needs to stay loaded while the layer uses it
+ * @return handle to the layer, or INVALID_PAINTER_LAYER if the compositor is full
+ */
+painter_layer_t qp_compositor_add_image(painter_compositor_t compositor, uint16_t x, uint16_t y, painter_image_handle_t image);
+
+/**
+ * Adds an image layer, recoloring monochrome images to the desired foreground/background.
+ *
+ * @param compositor[in] the handle of the compositor
+ * @param x[in] the x-position where the image should be drawn
+ * @param y[in] the y-position where the image should be drawn
+ * @param image[in] the handle of the image, which needs to stay loaded while the layer uses it
+ * @param hue_fg[in] the foreground hue to use, with 0-360 mapped to 0-255
+ * @param sat_fg[in] the foreground saturation to use, with 0-100% mapped to 0-255
+ * @param val_fg[in] the foreground value to use, with 0-100% mapped to 0-255
+ * @param hue_bg[in] the background hue to use, with 0-360 mapped to 0-255
+ * @param sat_bg[in] the background saturation to use, with 0-100% mapped to 0-255
+ * @param val_bg[in] the background value to use, with 0-100% mapped to 0-255
+ * @return handle to the layer, or INVALID_PAINTER_LAYER if the compositor is full
+ */
+painter_layer_t qp_compositor_add_image_recolor(painter_compositor_t compositor, uint16_t x, uint16_t y, painter_image_handle_t image, uint8_t hue_fg, uint8_t sat_fg, uint8_t val_fg, uint8_t hue_bg, uint8_t sat_bg, uint8_t val_bg);
+
+/**
+ * Adds a text layer.
+ *
+ * @param compositor[in] the handle of the compositor
+ * @param x[in] the x-position where the text should be drawn
+ * @param y[in] the y-position where the text should be drawn
+ * @param font[in] the handle of the font, which needs to stay loaded while the layer uses it
+ * @param str[in] the string to draw, which is not copied -- it needs to stay valid while the layer uses it
+ * @return handle to the layer, or INVALID_PAINTER_LAYER if the compositor is full
+ */
+painter_layer_t qp_compositor_add_text(painter_compositor_t compositor, uint16_t x, uint16_t y, painter_font_handle_t font, const char *str);
+
+/**
+ * Adds a text layer, recoloring monochrome fonts to the desired foreground/background.
+ *
+ * @param compositor[in] the handle of the compositor
+ * @param x[in] the x-position where the text should be drawn
+ * @param y[in] the y-position where the text should be drawn
+ * @param font[in] the handle of the font, which needs to stay loaded while the layer uses it
+ * @param str[in] the string to draw, which is not copied -- it needs to stay valid while the layer uses it
+ * @param hue_fg[in] the foreground hue to use, with 0-360 mapped to 0-255
+ * @param sat_fg[in] the foreground saturation to use, with 0-100% mapped to 0-255
+ * @param val_fg[in] the foreground value to use, with 0-100% mapped to 0-255
+ * @param hue_bg[in] the background hue to use, with 0-360 mapped to 0-255
+ * @param sat_bg[in] the background saturation to use, with 0-100% mapped to 0-255
+ * @param val_bg[in] the background value to use, with 0-100% mapped to 0-255
+ * @return handle to the layer, or INVALID_PAINTER_LAYER if the compositor is full
+ */
+painter_layer_t qp_compositor_add_text_recolor(painter_compositor_t compositor, uint16_t x, uint16_t y, painter_font_handle_t font, const char *str, uint8_t hue_fg, uint8_t sat_fg, uint8_t val_fg, uint8_t hue_bg, uint8_t sat_bg, uint8_t val_bg);
+
+/**
+ * Moves a layer, keeping its size.
+ *
+ * @param compositor[in] the handle of the compositor
+ * @param layer[in] the handle of the layer
+ * @param x[in] the new x-position of the left side of the layer
+ * @param y[in] the new y-position of the top side of the layer
+ * @return true if the layer was moved
+ * @return false if the handles were invalid
+ */
+bool qp_compositor_move(painter_compositor_t compositor, painter_layer_t layer, uint16_t x, uint16_t y);
+
+/**
+ * Shows or hides a layer.
+ *
+ * @param compositor[in] the handle of the compositor
+ * @param layer[in] the handle of the layer
+ * @param visible[in] whether or not the layer should be drawn
+ * @return true if the layer was updated
+ * @return false if the handles were invalid
+ */
+bool qp_compositor_set_visible(painter_compositor_t compositor, painter_layer_t layer, bool visible);
+
+/**
+ * Changes the colors of a layer. Rectangles use the foreground color only.
+ *
+ * @param compositor[in] the handle of the compositor
+ * @param layer[in] the handle of the layer
+ * @param hue_fg[in] the foreground hue to use, with 0-360 mapped to 0-255
+ * @param sat_fg[in] the foreground saturation to use, with 0-100% mapped to 0-255
+ * @param val_fg[in] the foreground value to use, with 0-100% mapped to 0-255
+ * @param hue_bg[in] the background hue to use, with 0-360 mapped to 0-255
+ * @param sat_bg[in] the background saturation to use, with 0-100% mapped to 0-255
+ * @param val_bg[in] the background value to use, with 0-100% mapped to 0-255
+ * @return true if the layer was updated
+ * @return false if the handles were invalid
+ */
+bool qp_compositor_set_colors(painter_compositor_t compositor, painter_layer_t layer, uint8_t hue_fg, uint8_t sat_fg, uint8_t val_fg, uint8_t hue_bg, uint8_t sat_bg, uint8_t val_bg);
+
+/**
+ * Makes pixels of a layer matching the supplied color transparent, so the layers underneath show through them. Usually
+ * the background color of a recolored image or text layer.
+ *
+ * @param compositor[in] the handle of the compositor
+ * @param layer[in] the handle of the layer
+ * @param transparent[in] whether or not pixels matching the color should be skipped
+ * @param hue[in] the hue of the transparent color, with 0-360 mapped to 0-255
+ * @param sat[in] the saturation of the transparent color, with 0-100% mapped to 0-255
+ * @param val[in] the value of the transparent color, with 0-100% mapped to 0-255
+ * @return true if the layer was updated
+ * @return false if the handles were invalid, or the layer is a rectangle
+ */
+bool qp_compositor_set_color_key(painter_compositor_t compositor, painter_layer_t layer, bool transparent, uint8_t hue, uint8_t sat, uint8_t val);
+
+/**
+ * Changes the image drawn by an image layer.
+ *
+ * @param compositor[in] the handle of the compositor
+ * @param layer[in] the handle of the layer
+ * @param image[in] the handle of the image, which needs to stay loaded while the layer uses it
+ * @return true if the layer was updated
+ * @return false if the handles were invalid, or the layer isn't an image
+ */
+bool qp_compositor_set_image(painter_compositor_t compositor, painter_layer_t layer, painter_image_handle_t image);
+
+/**
+ * Changes the string drawn by a text layer. Also needs calling if the contents of the same string were modified.
+ *
+ * @param compositor[in] the handle of the compositor
+ * @param layer[in] the handle of the layer
+ * @param str[in] the string to draw, which is not copied -- it needs to stay valid while the layer uses it
+ * @return true if the layer was updated
+ * @return false if the handles were invalid, or the layer isn't text
+ */
+bool qp_compositor_set_text(painter_compositor_t compositor, painter_layer_t layer, const char *str);
+
+/**
+ * Removes all layers from a compositor, leaving only the background.
+ *
+ * @param compositor[in] the handle of the compositor
+ * @return true if the layers were removed
+ * @return false if the handle was invalid
+ */
+bool qp_compositor_clear(painter_compositor_t compositor);
+
+/**
+ * Forces every tile to be redrawn by the next \ref qp_compositor_render, such as after something else has drawn to
+ * the display.
+ *
+ * @param compositor[in] the handle of the compositor
+ */
+void qp_compositor_invalidate(painter_compositor_t compositor);
+
+/**
+ * Redraws each tile whose layers have changed since the last render, and sends it to the display.
+ *
+ * @note Displays with their own framebuffer, such as surfaces, still need \ref qp_flush afterwards.
+ *
+ * @param compositor[in] the handle of the compositor
+ * @return true if all the changed tiles were sent
+ * @return false if drawing or sending a tile failed, in which case the tiles not sent are retried next time
+ */
+bool qp_compositor_render(painter_compositor_t compositor);
@@ -9,8 +9,8 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Quantum Painter utility functions
 
-// Global variable used for native pixel data streaming.
-extern uint8_t qp_internal_global_pixdata_buffer[QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE];
+// Global variable used for native pixel data streaming. Always points at a buffer which is safe to fill.
+extern uint8_t *qp_internal_global_pixdata_buffer;
 
 // Check if the supplied bpp is capable of being rendered
 bool qp_internal_bpp_capable(uint8_t bits_per_pixel);
@@ -18,6 +18,12 @@ bool qp_internal_bpp_capable(uint8_t bits_per_pixel);
 // Returns the number of pixels that can fit in the pixdata buffer
 uint32_t qp_internal_num_pixels_in_buffer(painter_device_t device);
 
+// Checks if the supplied data lives in one of the pixdata buffers
+bool qp_internal_is_pixdata_buffer(const void* data);
+
+// Marks the supplied pixdata buffer as being transmitted in the background, so that it is no longer filled
+void qp_internal_pixdata_in_flight(const void* data);
+
 // Fills the supplied buffer with equivalent native pixels matching the supplied HSV
 void qp_internal_fill_pixdata(painter_device_t device, uint32_t num_pixels, uint8_t hue, uint8_t sat, uint8_t val);
 
@@ -27,6 +33,31 @@ bool qp_internal_setpixel_impl(painter_device_t device, uint16_t x, uint16_t y);
 // qp_rect internal implementation, but uses the global pixdata buffer with pre-converted native pixels.
 bool qp_internal_fillrect_helper_impl(painter_device_t device, uint16_t l, uint16_t t, uint16_t r, uint16_t b);
 
+// Span batching for filled and outlined shapes, using the global pixdata buffer with pre-converted native pixels. Spans
+// which continue a pending block on the row directly above or below it, with the same extent, are merged into it so the
+// whole block needs only one viewport. Spans already covered by a pending block are dropped.
+#define QP_SPAN_BATCH_BLOCKS 8
+
+typedef struct qp_internal_span_block_t {
+    uint16_t l;
+    uint16_t t;
+    uint16_t r;
+    uint16_t b;
+} qp_internal_span_block_t;
+
+typedef struct qp_internal_span_batch_t {
+    painter_device_t         device;
+    uint8_t                  count;
+    qp_internal_span_block_t blocks[QP_SPAN_BATCH_BLOCKS]; // least recently extended first
+} qp_internal_span_batch_t;
+
+void qp_internal_span_batch_init(qp_internal_span_batch_t* batch, painter_device_t device);
+bool qp_internal_span_batch_add(qp_internal_span_batch_t* batch, uint16_t l, uint16_t r, uint16_t y);
+bool qp_internal_span_batch_flush(qp_internal_span_batch_t* batch);
+
+// Adds the spans between x0 and x1 (0 <= x0 <= x1) to the left and right of centerx, on the rows y above and below centery
+bool qp_internal_span_batch_add_mirrored(qp_internal_span_batch_t* batch, int16_t centerx, int16_t centery, int16_t x0, int16_t x1, int16_t y);
+
 // Convert from input pixel data + palette to equivalent pixels
 typedef int16_t (*qp_internal_byte_input_callback)(void* cb_arg);
 typedef bool (*qp_internal_pixel_output_callback)(qp_pixel_t* palette, uint8_t index, void* cb_arg);
@@ -43,12 +74,12 @@ extern qp_pixel_t qp_internal_global_pixel_lookup_table[256];
 extern qp_pixel_t qp_internal_global_pixel_lookup_table[16];
 #endif
 
-// Generates a color-interpolated lookup table based off the number of items, from foreground to background, for use with monochrome image rendering.
-// Returns true if a palette was created, false if the palette is reused.
-// As this uses a global, this may present a problem if using the same parameters but a different screen converts pixels -- use qp_internal_invalidate_palette() below to reset.
-bool qp_internal_interpolate_palette(qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888, int16_t steps);
+// Returns a palette for monochrome image rendering, interpolated from background to foreground over the number of
+// entries needed for bits_per_pixel, and converted to the device's native pixel format. The most recently used palettes
+// are cached, so drawing with the same colors again doesn't regenerate them. Returns NULL if conversion failed.
+qp_pixel_t* qp_internal_recolor_palette(painter_device_t device, qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888, uint8_t bits_per_pixel);
 
-// Resets the global palette so that it can be regenerated. Only needed if the colors are identical, but a different display is used with a different internal pixel format.
+// Drops all generated palettes, so that they get regenerated when next used.
 void qp_internal_invalidate_palette(void);
 
 // Helper shared between image and font rendering -- sets up the global palette to match the palette block specified in the asset. Expects the stream to be positioned at the start of the block header.
@@ -64,15 +95,24 @@ enum qp_internal_rle_mode_t {
 };
 
 struct qp_internal_byte_input_state {
-    painter_device_t device;
-    qp_stream_t*     src_stream;
-    int16_t          curr;
+    painter_device_t      device;
+    qp_stream_t*          src_stream;
+    painter_compression_t compression;
+    int16_t               curr;
     union {
         // RLE-specific
         struct {
             enum qp_internal_rle_mode_t mode;
             uint8_t                     remain; // number of bytes remaining in the current mode
         } rle;
+        // LZ-specific
+        struct {
+            uint32_t literals; // number of literal bytes remaining in the current sequence
+            uint32_t match;    // number of bytes remaining to be copied from the window
+            uint8_t  token;    // match length of the current sequence, pending until its literals are done
+            uint8_t  offset;   // distance back into the window of the current match, minus one
+            uint8_t  pos;      // write position in the window, wraps around with the uint8_t
+        } lz;
     };
 };
 
@@ -80,6 +120,7 @@ struct qp_internal_pixel_output_state {
     painter_device_t device;
     uint32_t         pixel_write_pos;
     uint32_t         max_pixels;
+    uint8_t*         buffer; // pixels are written here instead of the pixdata buffer, if set
 };
 
 bool qp_internal_pixel_appender(qp_pixel_t* palette, uint8_t index, void* cb_arg);
@@ -93,3 +134,49 @@ struct qp_internal_byte_output_state {
 bool qp_internal_byte_appender(uint8_t byteval, void* cb_arg);
 
 qp_internal_byte_input_callback qp_internal_prepare_input_state(struct qp_internal_byte_input_state* input_state, painter_compression_t compression);
+
+// Size of the history window LZ matches copy from, which is shared by all LZ decoding
+#define QP_LZ_WINDOW_SIZE 256
+
+// Copies the LZ window out and back in, so that an input state saved alongside it can be resumed after something else
+// has been decoded in the meantime
+void qp_internal_save_lz_window(uint8_t* window);
+void qp_internal_restore_lz_window(const uint8_t* window);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter block codec functions
+//
+// These work on whole blocks instead of pulling a byte and pushing a pixel at a time through callbacks. The input state
+// needs to have been set up with qp_internal_prepare_input_state(), and can be mixed with the byte-wise decoders.
+
+// Reads the next length bytes of decompressed data from the input, expanding repeated RLE runs with memset() and copying
+// LZ literals straight from the stream
+bool qp_internal_read_block(struct qp_internal_byte_input_state* input_state, uint8_t* buffer, uint32_t length);
+
+// Moves past the next length bytes of decompressed data without producing them, seeking over uncompressed data
+bool qp_internal_skip_block(struct qp_internal_byte_input_state* input_state, uint32_t length);
+
+// Decodes palette-indexed pixel data into the pixdata buffer (or the output state's buffer, if set), transmitting it whenever it fills up. Leftovers are not transmitted.
+bool qp_internal_decode_palette_block(painter_device_t device, uint32_t pixel_count, uint8_t bits_per_pixel, struct qp_internal_byte_input_state* input_state, qp_pixel_t* palette, struct qp_internal_pixel_output_state* output_state);
+
+// Copies native pixel data into the pixdata buffer, transmitting it whenever it fills up. Leftovers are not transmitted.
+bool qp_internal_send_bytes_block(painter_device_t device, uint32_t byte_count, struct qp_internal_byte_input_state* input_state, struct qp_internal_byte_output_state* output_state);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter partial image drawing
+
+// Where decoding of an image's first frame got to, at the start of a row, so that drawing rows further down the image
+// can carry on from there instead of decoding everything above them again
+typedef struct qp_internal_image_cursor_t {
+    painter_image_handle_t              image; // NULL until the cursor has been positioned
+    uint16_t                            row;
+    int32_t                             position;
+    struct qp_internal_byte_input_state input_state;
+    uint8_t                             lz_window[QP_LZ_WINDOW_SIZE];
+} qp_internal_image_cursor_t;
+
+// Draws rows first_row to last_row of the first frame of an image, where they'd be if the whole image was drawn at
+// (x, y). Images of less than 8bpp may also draw a few rows above first_row, so that decoding starts on a byte boundary.
+// Rows above are skipped without being decoded into pixels, starting from the cursor if it's at or above them, which is
+// then left at the first row drawn. The cursor may be NULL.
+bool qp_internal_drawimage_rows(painter_device_t device, uint16_t x, uint16_t y, painter_image_handle_t image, uint16_t first_row, uint16_t last_row, qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888, qp_internal_image_cursor_t* cursor);
@@ -8,115 +8,34 @@
 #include "qp_draw.h"
 
 // Utilize 8-way symmetry to draw circles
-static bool qp_circle_helper_impl(painter_device_t device, uint16_t centerx, uint16_t centery, uint16_t offsetx, uint16_t offsety, bool filled) {
+static bool qp_circle_helper_impl(qp_internal_span_batch_t *batch, int16_t centerx, int16_t centery, int16_t offsetx, int16_t offsety, int16_t rowx, bool filled) {
     /*
     Circles have the property of 8-way symmetry, so eight pixels can be drawn
     for each computed [offsetx,offsety] given the center coordinates
     represented by [centerx,centery].
 
-    For filled circles, we can draw horizontal lines between each pair of
-    pixels with the same final value of y.
+    Pixels are handed to the span batch a row at a time, so that runs of
+    pixels become a single span, and runs of identical spans on consecutive
+    rows become a single block with one viewport:
 
-    Two special cases exist and have been optimized:
-    1) offsetx == offsety (the final point), makes half the coordinates
-    equivalent, so we can omit them (and the corresponding fill lines)
-    2) offsetx == 0 (the starting point) means that some horizontal lines
-    would be a single pixel in length, so we write individual pixels instead.
-    This also makes half the symmetrical points identical to their twins,
-    so we only need four points or two points and one line
+    1) offsetx changes on every step, so the rows [centery +/- offsetx] each
+    get the pixels [centerx +/- offsety], or the line between them for filled
+    circles. These stack up vertically near the widest part of the circle.
+    2) offsety only changes on some steps, so the rows [centery +/- offsety]
+    get the pixels from [centerx +/- rowx] to [centerx +/- offsetx], where
+    rowx is the first offsetx seen on that row. The caller only hands these
+    over once it has moved off the row, by setting rowx to -1 otherwise.
+
+    When offsetx == offsety the two cases cover the same pixels, so only the
+    second is drawn.
     */
 
-    int16_t xpx = ((int16_t)centerx) + ((int16_t)offsetx);
-    int16_t xmx = ((int16_t)centerx) - ((int16_t)offsetx);
-    int16_t xpy = ((int16_t)centerx) + ((int16_t)offsety);
-    int16_t xmy = ((int16_t)centerx) - ((int16_t)offsety);
-    int16_t ypx = ((int16_t)centery) + ((int16_t)offsetx);
-    int16_t ymx = ((int16_t)centery) - ((int16_t)offsetx);
-    int16_t ypy = ((int16_t)centery) + ((int16_t)offsety);
-    int16_t ymy = ((int16_t)centery) - ((int16_t)offsety);
-
-    if (offsetx == 0) {
-        if (!qp_internal_setpixel_impl(device, centerx, ypy)) {
-            return false;
-        }
-        if (!qp_internal_setpixel_impl(device, centerx, ymy)) {
-            return false;
-        }
-        if (filled) {
-            if (!qp_internal_fillrect_helper_impl(device, xpy, centery, xmy, centery)) {
-                return false;
-            }
-        } else {
-            if (!qp_internal_setpixel_impl(device, xpy, centery)) {
-                return false;
-            }
-            if (!qp_internal_setpixel_impl(device, xmy, centery)) {
-                return false;
-            }
-        }
-    } else if (offsetx == offsety) {
-        if (filled) {
-            if (!qp_internal_fillrect_helper_impl(device, xpy, ypy, xmy, ypy)) {
-                return false;
-            }
-            if (!qp_internal_fillrect_helper_impl(device, xpy, ymy, xmy, ymy)) {
-                return false;
-            }
-        } else {
-            if (!qp_internal_setpixel_impl(device, xpy, ypy)) {
-                return false;
-            }
-            if (!qp_internal_setpixel_impl(device, xmy, ypy)) {
-                return false;
-            }
-            if (!qp_internal_setpixel_impl(device, xpy, ymy)) {
-                return false;
-            }
-            if (!qp_internal_setpixel_impl(device, xmy, ymy)) {
-                return false;
-            }
-        }
+    if (offsetx != offsety && !qp_internal_span_batch_add_mirrored(batch, centerx, centery, filled ? 0 : offsety, offsety, offsetx)) {
+        return false;
+    }
 
-    } else {
-        if (filled) {
-            if (!qp_internal_fillrect_helper_impl(device, xpx, ypy, xmx, ypy)) {
-                return false;
-            }
-            if (!qp_internal_fillrect_helper_impl(device, xpx, ymy, xmx, ymy)) {
-                return false;
-            }
-            if (!qp_internal_fillrect_helper_impl(device, xpy, ypx, xmy, ypx)) {
-                return false;
-            }
-            if (!qp_internal_fillrect_helper_impl(device, xpy, ymx, xmy, ymx)) {
-                return false;
-            }
-        } else {
-            if (!qp_internal_setpixel_impl(device, xpx, ypy)) {
-                return false;
-            }
-            if (!qp_internal_setpixel_impl(device, xmx, ypy)) {
-                return false;
-            }
-            if (!qp_internal_setpixel_impl(device, xpx, ymy)) {
-                return false;
-            }
-            if (!qp_internal_setpixel_impl(device, xmx, ymy)) {
-                return false;
-            }
-            if (!qp_internal_setpixel_impl(device, xpy, ypx)) {
-                return false;
-            }
-            if (!qp_internal_setpixel_impl(device, xmy, ypx)) {
-                return false;
-            }
-            if (!qp_internal_setpixel_impl(device, xpy, ymx)) {
-                return false;
-            }
-            if (!qp_internal_setpixel_impl(device, xmy, ymx)) {
-                return false;
-            }
-        }
+    if (rowx >= 0 && !qp_internal_span_batch_add_mirrored(batch, centerx, centery, filled ? 0 : rowx, offsetx, offsety)) {
+        return false;
     }
 
     return true;
@@ -137,33 +56,46 @@ bool qp_circle(painter_device_t device, uint16_t x, uint16_t y, uint16_t radius,
     int16_t xcalc = 0;
     int16_t ycalc = (int16_t)radius;
     int16_t err   = ((5 - (radius >> 2)) >> 2);
+    int16_t rowx  = 0;
 
-    qp_internal_fill_pixdata(device, (radius * 2) + 1, hue, sat, val);
+    // Blocks can be taller than a single line, so fill the whole buffer
+    qp_internal_fill_pixdata(device, qp_internal_num_pixels_in_buffer(device), hue, sat, val);
 
     if (!qp_comms_start(device)) {
         qp_dprintf("qp_circle: fail (could not start comms)\n");
         return false;
     }
 
+    qp_internal_span_batch_t batch;
+    qp_internal_span_batch_init(&batch, device);
+
     bool ret = true;
-    if (!qp_circle_helper_impl(device, x, y, xcalc, ycalc, filled)) {
-        ret = false;
+    while (ret) {
+        int16_t prevx = xcalc;
+        int16_t prevy = ycalc;
+        if (xcalc >= ycalc) {
+            // Final point, finish off its row
+            ret = qp_circle_helper_impl(&batch, x, y, xcalc, ycalc, rowx, filled);
+            break;
+        }
+
+        xcalc++;
+        if (err < 0) {
+            err += (xcalc << 1) + 1;
+        } else {
+            ycalc--;
+            err += ((xcalc - ycalc) << 1) + 1;
+        }
+
+        // Only finish the previous point's row once moving off it
+        ret = qp_circle_helper_impl(&batch, x, y, prevx, prevy, (ycalc != prevy) ? rowx : -1, filled);
+        if (ycalc != prevy) {
+            rowx = xcalc;
+        }
     }
 
     if (ret) {
-        while (xcalc < ycalc) {
-            xcalc++;
-            if (err < 0) {
-                err += (xcalc << 1) + 1;
-            } else {
-                ycalc--;
-                err += ((xcalc - ycalc) << 1) + 1;
-            }
-            if (!qp_circle_helper_impl(device, x, y, xcalc, ycalc, filled)) {
-                ret = false;
-                break;
-            }
-        }
+        ret = qp_internal_span_batch_flush(&batch);
     }
 
     qp_dprintf("qp_circle: %s\n", ret ? "ok" : "fail");
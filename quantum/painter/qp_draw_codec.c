@@ -54,15 +54,12 @@ bool qp_internal_decode_grayscale(painter_device_t device, uint32_t pixel_count,
 }
 
 bool qp_internal_decode_recolor(painter_device_t device, uint32_t pixel_count, uint8_t bits_per_pixel, qp_internal_byte_input_callback input_callback, void* input_arg, qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888, qp_internal_pixel_output_callback output_callback, void* output_arg) {
-    struct painter_driver_t* driver = (struct painter_driver_t*)device;
-    int16_t                  steps  = 1 << bits_per_pixel; // number of items we need to interpolate
-    if (qp_internal_interpolate_palette(fg_hsv888, bg_hsv888, steps)) {
-        if (!driver->driver_vtable->palette_convert(device, steps, qp_internal_global_pixel_lookup_table)) {
-            return false;
-        }
+    qp_pixel_t* palette = qp_internal_recolor_palette(device, fg_hsv888, bg_hsv888, bits_per_pixel);
+    if (!palette) {
+        return false;
     }
 
-    return qp_internal_decode_palette(device, pixel_count, bits_per_pixel, input_callback, input_arg, qp_internal_global_pixel_lookup_table, output_callback, output_arg);
+    return qp_internal_decode_palette(device, pixel_count, bits_per_pixel, input_callback, input_arg, palette, output_callback, output_arg);
 }
 
 bool qp_internal_send_bytes(painter_device_t device, uint32_t byte_count, qp_internal_byte_input_callback input_callback, void* input_arg, qp_internal_byte_output_callback output_callback, void* output_arg) {
@@ -125,17 +122,96 @@ static inline int16_t qp_drawimage_byte_rle_decoder(void* cb_arg) {
     return c;
 }
 
+// History of the most recently decoded bytes for LZ matches to copy from. Decoding is never interleaved, so one window is
+// shared by everything -- anything resuming a saved input state later saves and restores it as well. Its size matches
+// the single byte match offsets, so window positions wrap as uint8_t.
+static uint8_t qp_lz_window[QP_LZ_WINDOW_SIZE];
+
+void qp_internal_save_lz_window(uint8_t* window) {
+    memcpy(window, qp_lz_window, sizeof(qp_lz_window));
+}
+
+void qp_internal_restore_lz_window(const uint8_t* window) {
+    memcpy(qp_lz_window, window, sizeof(qp_lz_window));
+}
+
+// Reads the continuation bytes of a length which didn't fit in its token nibble
+static bool qp_lz_read_length(qp_stream_t* stream, uint32_t* length) {
+    int16_t c;
+    do {
+        c = qp_stream_get(stream);
+        if (c < 0) {
+            return false;
+        }
+        *length += c;
+    } while (c == 255);
+    return true;
+}
+
+// Moves on to the next run of literals or the next match, once the current one has been used up
+static bool qp_lz_next_run(struct qp_internal_byte_input_state* state) {
+    while (state->lz.literals == 0 && state->lz.match == 0) {
+        if (state->lz.token != 0) {
+            // The match which follows the literals of the current sequence
+            int16_t offset = qp_stream_get(state->src_stream);
+            if (offset < 0) {
+                return false;
+            }
+            state->lz.offset = offset;
+            state->lz.match  = state->lz.token + 2;
+            if (state->lz.token == 15 && !qp_lz_read_length(state->src_stream, &state->lz.match)) {
+                return false;
+            }
+            state->lz.token = 0;
+        } else {
+            // Start of a new sequence
+            int16_t token = qp_stream_get(state->src_stream);
+            if (token < 0) {
+                return false;
+            }
+            state->lz.literals = token >> 4;
+            state->lz.token    = token & 0x0F;
+            if (state->lz.literals == 15 && !qp_lz_read_length(state->src_stream, &state->lz.literals)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static inline int16_t qp_drawimage_byte_lz_decoder(void* cb_arg) {
+    struct qp_internal_byte_input_state* state = (struct qp_internal_byte_input_state*)cb_arg;
+    if (!qp_lz_next_run(state)) {
+        return -1;
+    }
+
+    if (state->lz.literals > 0) {
+        state->curr = qp_stream_get(state->src_stream);
+        if (state->curr < 0) {
+            return -1;
+        }
+        state->lz.literals--;
+    } else {
+        state->curr = qp_lz_window[(uint8_t)(state->lz.pos - state->lz.offset - 1)];
+        state->lz.match--;
+    }
+
+    qp_lz_window[state->lz.pos++] = state->curr;
+    return state->curr;
+}
+
 bool qp_internal_pixel_appender(qp_pixel_t* palette, uint8_t index, void* cb_arg) {
     struct qp_internal_pixel_output_state* state  = (struct qp_internal_pixel_output_state*)cb_arg;
     struct painter_driver_t*               driver = (struct painter_driver_t*)state->device;
+    uint8_t*                               buffer = state->buffer ? state->buffer : qp_internal_global_pixdata_buffer;
 
-    if (!driver->driver_vtable->append_pixels(state->device, qp_internal_global_pixdata_buffer, palette, state->pixel_write_pos++, 1, &index)) {
+    if (!driver->driver_vtable->append_pixels(state->device, buffer, palette, state->pixel_write_pos++, 1, &index)) {
         return false;
     }
 
     // If we've hit the transmit limit, send out the entire buffer and reset the write position
     if (state->pixel_write_pos == state->max_pixels) {
-        if (!driver->driver_vtable->pixdata(state->device, qp_internal_global_pixdata_buffer, state->pixel_write_pos)) {
+        if (!driver->driver_vtable->pixdata(state->device, buffer, state->pixel_write_pos)) {
             return false;
         }
         state->pixel_write_pos = 0;
@@ -165,6 +241,7 @@ bool qp_internal_byte_appender(uint8_t byteval, void* cb_arg) {
 }
 
 qp_internal_byte_input_callback qp_internal_prepare_input_state(struct qp_internal_byte_input_state* input_state, painter_compression_t compression) {
+    input_state->compression = compression;
     switch (compression) {
         case IMAGE_UNCOMPRESSED:
             return qp_drawimage_byte_uncompressed_decoder;
@@ -172,7 +249,234 @@ qp_internal_byte_input_callback qp_internal_prepare_input_state(struct qp_intern
             input_state->rle.mode   = MARKER_BYTE;
             input_state->rle.remain = 0;
             return qp_drawimage_byte_rle_decoder;
+        case IMAGE_COMPRESSED_LZ:
+            input_state->lz.literals = 0;
+            input_state->lz.match    = 0;
+            input_state->lz.token    = 0;
+            input_state->lz.pos      = 0;
+            return qp_drawimage_byte_lz_decoder;
         default:
             return NULL;
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Block decoding
+
+_Static_assert((QUANTUM_PAINTER_DECODE_BLOCK_PIXELS > 0) && (QUANTUM_PAINTER_DECODE_BLOCK_PIXELS % 8) == 0, "QUANTUM_PAINTER_DECODE_BLOCK_PIXELS needs to be a non-zero multiple of 8");
+
+static bool qp_read_block_rle(struct qp_internal_byte_input_state* state, uint8_t* buffer, uint32_t length) {
+    while (length > 0) {
+        // Same state machine as qp_drawimage_byte_rle_decoder(), but consuming whole runs at a time
+        if (state->rle.mode == MARKER_BYTE) {
+            int16_t marker = qp_stream_get(state->src_stream);
+            int16_t first  = qp_stream_get(state->src_stream);
+            if (marker < 0 || first < 0) {
+                return false;
+            }
+            if (marker >= 128) {
+                state->rle.mode   = NON_REPEATING_RUN;
+                state->rle.remain = marker - 127;
+            } else {
+                state->rle.mode   = REPEATING_RUN;
+                state->rle.remain = marker;
+            }
+            state->curr = first;
+        }
+
+        if (state->rle.remain == 0) {
+            // Empty run, nothing to expand
+            state->rle.mode = MARKER_BYTE;
+            continue;
+        }
+
+        uint8_t n = (length < state->rle.remain) ? length : state->rle.remain;
+        if (state->rle.mode == REPEATING_RUN) {
+            memset(buffer, state->curr, n);
+        } else {
+            // The first byte of the run has already been read ahead
+            buffer[0] = state->curr;
+            if (n > 1 && qp_stream_read(&buffer[1], 1, n - 1, state->src_stream) != n - 1u) {
+                return false;
+            }
+        }
+
+        buffer += n;
+        length -= n;
+        state->rle.remain -= n;
+        if (state->rle.remain == 0) {
+            state->rle.mode = MARKER_BYTE;
+        } else if (state->rle.mode == NON_REPEATING_RUN) {
+            // Keep the read-ahead the byte-wise decoder expects
+            state->curr = qp_stream_get(state->src_stream);
+        }
+    }
+    return true;
+}
+
+// Records bytes which went straight to the output in the window, so later matches can refer back to them
+static void qp_lz_window_append(struct qp_internal_byte_input_state* state, const uint8_t* data, uint32_t length) {
+    if (length > sizeof(qp_lz_window)) {
+        // Only the last window's worth can ever be referred to
+        state->lz.pos += length - sizeof(qp_lz_window);
+        data += length - sizeof(qp_lz_window);
+        length = sizeof(qp_lz_window);
+    }
+    uint32_t first = sizeof(qp_lz_window) - state->lz.pos;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(&qp_lz_window[state->lz.pos], data, first);
+    memcpy(qp_lz_window, data + first, length - first);
+    state->lz.pos += length;
+}
+
+static bool qp_read_block_lz(struct qp_internal_byte_input_state* state, uint8_t* buffer, uint32_t length) {
+    while (length > 0) {
+        // Same state machine as qp_drawimage_byte_lz_decoder(), but consuming whole runs at a time
+        if (!qp_lz_next_run(state)) {
+            return false;
+        }
+
+        uint32_t n;
+        if (state->lz.literals > 0) {
+            n = (length < state->lz.literals) ? length : state->lz.literals;
+            if (qp_stream_read(buffer, 1, n, state->src_stream) != n) {
+                return false;
+            }
+            qp_lz_window_append(state, buffer, n);
+            state->lz.literals -= n;
+        } else {
+            n = (length < state->lz.match) ? length : state->lz.match;
+
+            // Copy up to one repeat of the match out of the window, which may wrap around...
+            uint32_t distance = state->lz.offset + 1u;
+            uint32_t copied   = (n < distance) ? n : distance;
+            uint8_t  src      = state->lz.pos - distance;
+            uint32_t first    = sizeof(qp_lz_window) - src;
+            if (first > copied) {
+                first = copied;
+            }
+            memcpy(buffer, &qp_lz_window[src], first);
+            memcpy(&buffer[first], qp_lz_window, copied - first);
+
+            // ...then matches longer than their distance repeat it, doubling up each time
+            while (copied < n) {
+                uint32_t chunk = (copied < n - copied) ? copied : n - copied;
+                memcpy(&buffer[copied], buffer, chunk);
+                copied += chunk;
+            }
+            qp_lz_window_append(state, buffer, n);
+            state->lz.match -= n;
+        }
+
+        buffer += n;
+        length -= n;
+    }
+    return true;
+}
+
+bool qp_internal_read_block(struct qp_internal_byte_input_state* input_state, uint8_t* buffer, uint32_t length) {
+    switch (input_state->compression) {
+        case IMAGE_UNCOMPRESSED:
+            return qp_stream_read(buffer, 1, length, input_state->src_stream) == length;
+        case IMAGE_COMPRESSED_RLE:
+            return qp_read_block_rle(input_state, buffer, length);
+        case IMAGE_COMPRESSED_LZ:
+            return qp_read_block_lz(input_state, buffer, length);
+        default:
+            return false;
+    }
+}
+
+bool qp_internal_skip_block(struct qp_internal_byte_input_state* input_state, uint32_t length) {
+    if (input_state->compression == IMAGE_UNCOMPRESSED) {
+        return qp_stream_seek(input_state->src_stream, length, SEEK_CUR) == 0;
+    }
+
+    // Compressed data still needs decoding to find where it ends up, but not converting into pixels
+    uint8_t discard[QUANTUM_PAINTER_DECODE_BLOCK_PIXELS];
+    while (length > 0) {
+        uint32_t n = (length < sizeof(discard)) ? length : sizeof(discard);
+        if (!qp_internal_read_block(input_state, discard, n)) {
+            return false;
+        }
+        length -= n;
+    }
+    return true;
+}
+
+bool qp_internal_decode_palette_block(painter_device_t device, uint32_t pixel_count, uint8_t bits_per_pixel, struct qp_internal_byte_input_state* input_state, qp_pixel_t* palette, struct qp_internal_pixel_output_state* output_state) {
+    struct painter_driver_t* driver          = (struct painter_driver_t*)device;
+    const uint8_t            pixel_bitmask   = (1 << bits_per_pixel) - 1;
+    const uint8_t            pixels_per_byte = 8 / bits_per_pixel;
+    uint8_t                  packed[QUANTUM_PAINTER_DECODE_BLOCK_PIXELS];
+    uint8_t                  indices[QUANTUM_PAINTER_DECODE_BLOCK_PIXELS];
+
+    while (pixel_count > 0) {
+        // Read a byte-aligned block of packed palette indices, 8bpp data needs no unpacking
+        uint32_t block_pixels = (pixel_count < QUANTUM_PAINTER_DECODE_BLOCK_PIXELS) ? pixel_count : QUANTUM_PAINTER_DECODE_BLOCK_PIXELS;
+        uint32_t block_bytes  = (block_pixels + pixels_per_byte - 1) / pixels_per_byte;
+        uint8_t* block        = (bits_per_pixel == 8) ? indices : packed;
+        if (!qp_internal_read_block(input_state, block, block_bytes)) {
+            return false;
+        }
+
+        if (bits_per_pixel != 8) {
+            // Unpacking whole bytes may overrun block_pixels in the last block, which is fine as indices is big enough
+            uint8_t* out = indices;
+            for (uint32_t b = 0; b < block_bytes; ++b) {
+                uint8_t byteval = packed[b];
+                for (uint8_t q = 0; q < pixels_per_byte; ++q) {
+                    *out++ = byteval & pixel_bitmask;
+                    byteval >>= bits_per_pixel;
+                }
+            }
+        }
+
+        // Hand as many pixels to the driver at a time as will fit in the output buffer
+        uint32_t done = 0;
+        while (done < block_pixels) {
+            uint8_t* buffer = output_state->buffer ? output_state->buffer : qp_internal_global_pixdata_buffer;
+            uint32_t space  = output_state->max_pixels - output_state->pixel_write_pos;
+            uint32_t count  = (block_pixels - done < space) ? block_pixels - done : space;
+            if (!driver->driver_vtable->append_pixels(device, buffer, palette, output_state->pixel_write_pos, count, &indices[done])) {
+                return false;
+            }
+            output_state->pixel_write_pos += count;
+            done += count;
+
+            if (output_state->pixel_write_pos == output_state->max_pixels) {
+                if (!driver->driver_vtable->pixdata(device, buffer, output_state->pixel_write_pos)) {
+                    return false;
+                }
+                output_state->pixel_write_pos = 0;
+            }
+        }
+
+        pixel_count -= block_pixels;
+    }
+    return true;
+}
+
+bool qp_internal_send_bytes_block(painter_device_t device, uint32_t byte_count, struct qp_internal_byte_input_state* input_state, struct qp_internal_byte_output_state* output_state) {
+    struct painter_driver_t* driver = (struct painter_driver_t*)device;
+    while (byte_count > 0) {
+        // Native pixel data is stored as-is, so read it straight into the pixdata buffer rather than using append_pixdata()
+        uint32_t space = output_state->max_bytes - output_state->byte_write_pos;
+        uint32_t count = (byte_count < space) ? byte_count : space;
+        if (!qp_internal_read_block(input_state, &qp_internal_global_pixdata_buffer[output_state->byte_write_pos], count)) {
+            return false;
+        }
+        output_state->byte_write_pos += count;
+        byte_count -= count;
+
+        if (output_state->byte_write_pos == output_state->max_bytes) {
+            if (!driver->driver_vtable->pixdata(device, qp_internal_global_pixdata_buffer, output_state->byte_write_pos * 8 / driver->native_bits_per_pixel)) {
+                return false;
+            }
+            output_state->byte_write_pos = 0;
+        }
+    }
+    return true;
+}
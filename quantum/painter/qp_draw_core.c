@@ -8,6 +8,12 @@
 #include "qgf.h"
 
 _Static_assert((QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE > 0) && (QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE % 16) == 0, "QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE needs to be a non-zero multiple of 16");
+#if QUANTUM_PAINTER_SPI_ASYNC
+_Static_assert(QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE <= UINT16_MAX, "QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE needs to fit in a single SPI transfer when using QUANTUM_PAINTER_SPI_ASYNC");
+#    define QP_PIXDATA_BUFFER_COUNT 2
+#else
+#    define QP_PIXDATA_BUFFER_COUNT 1
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Global variables
@@ -19,20 +25,46 @@ _Static_assert((QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE > 0) && (QUANTUM_PAINTER_PIX
 //       **** very likely get artifacts rendered to the screen as a result.                                       ****
 //
 
-// Buffer used for transmitting native pixel data to the downstream device.
-__attribute__((__aligned__(4))) uint8_t qp_internal_global_pixdata_buffer[QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE];
+// Buffers used for transmitting native pixel data to the downstream device. With QUANTUM_PAINTER_SPI_ASYNC one of them
+// can be filled while the other is in flight, and qp_internal_global_pixdata_buffer always points at the one to fill.
+__attribute__((__aligned__(4))) static uint8_t pixdata_buffers[QP_PIXDATA_BUFFER_COUNT][QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE];
+
+uint8_t *qp_internal_global_pixdata_buffer = pixdata_buffers[0];
+
+// Buffer last filled with solid color by qp_internal_fill_pixdata(), which stays valid after being swapped out
+static uint8_t *solid_pixdata_buffer = pixdata_buffers[0];
 
-// Static buffer to contain a generated color palette
-static bool                                       generated_palette = false;
-static int16_t                                    generated_steps   = -1;
-__attribute__((__aligned__(4))) static qp_pixel_t interpolated_fg_hsv888;
-__attribute__((__aligned__(4))) static qp_pixel_t interpolated_bg_hsv888;
 #if QUANTUM_PAINTER_SUPPORTS_256_PALETTE
 __attribute__((__aligned__(4))) qp_pixel_t qp_internal_global_pixel_lookup_table[256];
 #else
 __attribute__((__aligned__(4))) qp_pixel_t qp_internal_global_pixel_lookup_table[16];
 #endif
 
+// What a generated palette was made from -- bpp is zero if it isn't valid
+typedef struct qp_palette_key_t {
+    painter_device_t device;
+    qp_pixel_t       fg_hsv888;
+    qp_pixel_t       bg_hsv888;
+    uint8_t          bpp;
+} qp_palette_key_t;
+
+// Palettes generated into the global lookup table, which is also used by palettes loaded from images and fonts
+static qp_palette_key_t lookup_table_key = {0};
+
+#if QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES > 0
+// Palettes of up to this many bpp are kept in the palette cache instead of the global lookup table
+#    define QP_PALETTE_CACHE_MAX_BPP 4
+
+typedef struct qp_palette_cache_entry_t {
+    qp_palette_key_t                           key;
+    uint32_t                                   last_used;
+    __attribute__((__aligned__(4))) qp_pixel_t palette[1 << QP_PALETTE_CACHE_MAX_BPP];
+} qp_palette_cache_entry_t;
+
+static qp_palette_cache_entry_t palette_cache[QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES] = {0};
+static uint32_t                 palette_cache_clock                                  = 0;
+#endif // QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES > 0
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Helpers
 
@@ -41,10 +73,27 @@ uint32_t qp_internal_num_pixels_in_buffer(painter_device_t device) {
     return ((QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE * 8) / driver->native_bits_per_pixel);
 }
 
+// Checks if the supplied data lives in one of the pixdata buffers
+bool qp_internal_is_pixdata_buffer(const void *data) {
+    const uint8_t *p = (const uint8_t *)data;
+    return p >= &pixdata_buffers[0][0] && p < &pixdata_buffers[QP_PIXDATA_BUFFER_COUNT - 1][QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE];
+}
+
+// Marks the supplied pixdata buffer as being transmitted in the background, switching to the other buffer for filling
+void qp_internal_pixdata_in_flight(const void *data) {
+#if QUANTUM_PAINTER_SPI_ASYNC
+    // Only one transfer is in flight at a time, so the other buffer has been sent by now
+    const uint8_t *p = (const uint8_t *)data;
+    if (p >= qp_internal_global_pixdata_buffer && p < qp_internal_global_pixdata_buffer + QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE) {
+        qp_internal_global_pixdata_buffer = (qp_internal_global_pixdata_buffer == pixdata_buffers[0]) ? pixdata_buffers[1] : pixdata_buffers[0];
+    }
+#endif // QUANTUM_PAINTER_SPI_ASYNC
+}
+
 // qp_setpixel internal implementation, but accepts a buffer with pre-converted native pixel. Only the first pixel is used.
 bool qp_internal_setpixel_impl(painter_device_t device, uint16_t x, uint16_t y) {
     struct painter_driver_t *driver = (struct painter_driver_t *)device;
-    return driver->driver_vtable->viewport(device, x, y, x, y) && driver->driver_vtable->pixdata(device, qp_internal_global_pixdata_buffer, 1);
+    return driver->driver_vtable->viewport(device, x, y, x, y) && driver->driver_vtable->pixdata(device, solid_pixdata_buffer, 1);
 }
 
 // Fills the global native pixel buffer with equivalent pixels matching the supplied HSV
@@ -58,33 +107,30 @@ void qp_internal_fill_pixdata(painter_device_t device, uint32_t num_pixels, uint
     driver->driver_vtable->palette_convert(device, 1, &color);
 
     // Append the required number of pixels
-    uint8_t palette_idx = 0;
+    uint8_t palette_idx  = 0;
+    solid_pixdata_buffer = qp_internal_global_pixdata_buffer;
     for (uint32_t i = 0; i < num_pixels; ++i) {
-        driver->driver_vtable->append_pixels(device, qp_internal_global_pixdata_buffer, &color, i, 1, &palette_idx);
+        driver->driver_vtable->append_pixels(device, solid_pixdata_buffer, &color, i, 1, &palette_idx);
     }
 }
 
-// Resets the global palette so that it can be regenerated. Only needed if the colors are identical, but a different display is used with a different internal pixel format.
+// Drops all generated palettes, so that they get regenerated when next used.
 void qp_internal_invalidate_palette(void) {
-    generated_palette = false;
-    generated_steps   = -1;
-}
-
-// Interpolates between two colors to generate a palette
-bool qp_internal_interpolate_palette(qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888, int16_t steps) {
-    // Check if we need to generate a new palette -- if the input parameters match then assume the palette can stay unchanged.
-    // This may present a problem if using the same parameters but a different screen converts pixels -- use qp_internal_invalidate_palette() to reset.
-    if (generated_palette == true && generated_steps == steps && memcmp(&interpolated_fg_hsv888, &fg_hsv888, sizeof(fg_hsv888)) == 0 && memcmp(&interpolated_bg_hsv888, &bg_hsv888, sizeof(bg_hsv888)) == 0) {
-        // We already have the correct palette, no point regenerating it.
-        return false;
+    lookup_table_key.bpp = 0;
+#if QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES > 0
+    for (uint8_t i = 0; i < QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES; ++i) {
+        palette_cache[i].key.bpp   = 0;
+        palette_cache[i].last_used = 0;
     }
+#endif // QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES > 0
+}
 
-    // Save the parameters so we know whether we can skip generation
-    generated_palette      = true;
-    generated_steps        = steps;
-    interpolated_fg_hsv888 = fg_hsv888;
-    interpolated_bg_hsv888 = bg_hsv888;
+static inline bool qp_palette_key_matches(const qp_palette_key_t *key, painter_device_t device, qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888, uint8_t bpp) {
+    return key->bpp == bpp && key->device == device && key->fg_hsv888.hsv888.h == fg_hsv888.hsv888.h && key->fg_hsv888.hsv888.s == fg_hsv888.hsv888.s && key->fg_hsv888.hsv888.v == fg_hsv888.hsv888.v && key->bg_hsv888.hsv888.h == bg_hsv888.hsv888.h && key->bg_hsv888.hsv888.s == bg_hsv888.hsv888.s && key->bg_hsv888.hsv888.v == bg_hsv888.hsv888.v;
+}
 
+// Interpolates between two colors to generate a palette
+static void qp_internal_interpolate_palette(qp_pixel_t *palette, qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888, int16_t steps) {
     int16_t hue_fg = fg_hsv888.hsv888.h;
     int16_t hue_bg = bg_hsv888.hsv888.h;
 
@@ -97,14 +143,61 @@ bool qp_internal_interpolate_palette(qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888,
 
     // Interpolate each of the lookup table entries
     for (int16_t i = 0; i < steps; ++i) {
-        qp_internal_global_pixel_lookup_table[i].hsv888.h = (uint8_t)((hue_fg - hue_bg) * i / (steps - 1) + hue_bg);
-        qp_internal_global_pixel_lookup_table[i].hsv888.s = (uint8_t)((fg_hsv888.hsv888.s - bg_hsv888.hsv888.s) * i / (steps - 1) + bg_hsv888.hsv888.s);
-        qp_internal_global_pixel_lookup_table[i].hsv888.v = (uint8_t)((fg_hsv888.hsv888.v - bg_hsv888.hsv888.v) * i / (steps - 1) + bg_hsv888.hsv888.v);
+        palette[i].hsv888.h = (uint8_t)((hue_fg - hue_bg) * i / (steps - 1) + hue_bg);
+        palette[i].hsv888.s = (uint8_t)((fg_hsv888.hsv888.s - bg_hsv888.hsv888.s) * i / (steps - 1) + bg_hsv888.hsv888.s);
+        palette[i].hsv888.v = (uint8_t)((fg_hsv888.hsv888.v - bg_hsv888.hsv888.v) * i / (steps - 1) + bg_hsv888.hsv888.v);
 
-        qp_dprintf("qp_internal_interpolate_palette: %3d of %d -- H: %3d, S: %3d, V: %3d\n", (int)(i + 1), (int)steps, (int)qp_internal_global_pixel_lookup_table[i].hsv888.h, (int)qp_internal_global_pixel_lookup_table[i].hsv888.s, (int)qp_internal_global_pixel_lookup_table[i].hsv888.v);
+        qp_dprintf("qp_internal_interpolate_palette: %3d of %d -- H: %3d, S: %3d, V: %3d\n", (int)(i + 1), (int)steps, (int)palette[i].hsv888.h, (int)palette[i].hsv888.s, (int)palette[i].hsv888.v);
     }
+}
 
-    return true;
+// Interpolates and converts a palette into the supplied storage, recording what it was made from
+static qp_pixel_t *qp_internal_generate_palette(qp_palette_key_t *key, qp_pixel_t *palette, painter_device_t device, qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888, uint8_t bpp) {
+    struct painter_driver_t *driver = (struct painter_driver_t *)device;
+    int16_t                  steps  = 1 << bpp;
+
+    key->bpp = 0;
+    qp_internal_interpolate_palette(palette, fg_hsv888, bg_hsv888, steps);
+    if (!driver->driver_vtable->palette_convert(device, steps, palette)) {
+        qp_dprintf("qp_internal_recolor_palette: fail (could not convert pixels to native)\n");
+        return NULL;
+    }
+
+    key->device    = device;
+    key->fg_hsv888 = fg_hsv888;
+    key->bg_hsv888 = bg_hsv888;
+    key->bpp       = bpp;
+    return palette;
+}
+
+// Returns a palette interpolated from the background to the foreground color, converted to the device's native format
+qp_pixel_t *qp_internal_recolor_palette(painter_device_t device, qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888, uint8_t bits_per_pixel) {
+#if QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES > 0
+    if (bits_per_pixel <= QP_PALETTE_CACHE_MAX_BPP) {
+        // Reuse a matching palette if there is one, otherwise replace the least recently used
+        uint8_t lru = 0;
+        for (uint8_t i = 0; i < QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES; ++i) {
+            qp_palette_cache_entry_t *entry = &palette_cache[i];
+            if (qp_palette_key_matches(&entry->key, device, fg_hsv888, bg_hsv888, bits_per_pixel)) {
+                entry->last_used = ++palette_cache_clock;
+                return entry->palette;
+            }
+            if (entry->last_used < palette_cache[lru].last_used) {
+                lru = i;
+            }
+        }
+
+        qp_palette_cache_entry_t *entry = &palette_cache[lru];
+        entry->last_used                = ++palette_cache_clock;
+        return qp_internal_generate_palette(&entry->key, entry->palette, device, fg_hsv888, bg_hsv888, bits_per_pixel);
+    }
+#endif // QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES > 0
+
+    // Larger palettes only fit in the global lookup table
+    if (qp_palette_key_matches(&lookup_table_key, device, fg_hsv888, bg_hsv888, bits_per_pixel)) {
+        return qp_internal_global_pixel_lookup_table;
+    }
+    return qp_internal_generate_palette(&lookup_table_key, qp_internal_global_pixel_lookup_table, device, fg_hsv888, bg_hsv888, bits_per_pixel);
 }
 
 // Helper shared between image and font rendering -- sets up the global palette to match the palette block specified in the asset. Expects the stream to be positioned at the start of the block header.
@@ -118,8 +211,8 @@ bool qp_internal_load_qgf_palette(qp_stream_t *stream, uint8_t bpp) {
     // BPP determines the number of palette entries, each entry is a HSV888 triplet.
     const uint16_t palette_entries = 1u << bpp;
 
-    // Ensure we aren't reusing any palette
-    qp_internal_invalidate_palette();
+    // The global lookup table no longer holds a generated palette
+    lookup_table_key.bpp = 0;
 
     // Read the palette entries
     for (uint16_t i = 0; i < palette_entries; ++i) {
@@ -224,6 +317,76 @@ bool qp_line(painter_device_t device, uint16_t x0, uint16_t y0, uint16_t x1, uin
     return ret;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Span batching
+
+void qp_internal_span_batch_init(qp_internal_span_batch_t *batch, painter_device_t device) {
+    batch->device = device;
+    batch->count  = 0;
+}
+
+// Sends the oldest pending block and drops it from the batch
+static bool qp_internal_span_batch_flush_oldest(qp_internal_span_batch_t *batch) {
+    qp_internal_span_block_t block = batch->blocks[0];
+    memmove(&batch->blocks[0], &batch->blocks[1], (batch->count - 1) * sizeof(qp_internal_span_block_t));
+    --batch->count;
+    return qp_internal_fillrect_helper_impl(batch->device, block.l, block.t, block.r, block.b);
+}
+
+bool qp_internal_span_batch_add(qp_internal_span_batch_t *batch, uint16_t l, uint16_t r, uint16_t y) {
+    // Most recently extended blocks are the most likely to continue
+    for (uint8_t i = batch->count; i > 0; --i) {
+        qp_internal_span_block_t *block = &batch->blocks[i - 1];
+        if (l >= block->l && r <= block->r && y >= block->t && y <= block->b) {
+            return true;
+        }
+
+        if (l == block->l && r == block->r && (y == block->b + 1 || y + 1 == block->t)) {
+            qp_internal_span_block_t extended = *block;
+            extended.t                        = QP_MIN(extended.t, y);
+            extended.b                        = QP_MAX(extended.b, y);
+
+            // Keep the blocks in the order they were last extended
+            memmove(block, block + 1, (batch->count - i) * sizeof(qp_internal_span_block_t));
+            batch->blocks[batch->count - 1] = extended;
+            return true;
+        }
+    }
+
+    // Start a new block, making room by sending the one which has gone longest without being extended
+    if (batch->count == QP_SPAN_BATCH_BLOCKS && !qp_internal_span_batch_flush_oldest(batch)) {
+        return false;
+    }
+    batch->blocks[batch->count++] = (qp_internal_span_block_t){.l = l, .t = y, .r = r, .b = y};
+    return true;
+}
+
+bool qp_internal_span_batch_flush(qp_internal_span_batch_t *batch) {
+    while (batch->count > 0) {
+        if (!qp_internal_span_batch_flush_oldest(batch)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool qp_internal_span_batch_add_mirrored(qp_internal_span_batch_t *batch, int16_t centerx, int16_t centery, int16_t x0, int16_t x1, int16_t y) {
+    for (int16_t row = centery - y; row <= centery + y; row += 2 * y) {
+        if (x0 == 0) {
+            if (!qp_internal_span_batch_add(batch, centerx - x1, centerx + x1, row)) {
+                return false;
+            }
+        } else if (!qp_internal_span_batch_add(batch, centerx + x0, centerx + x1, row) || !qp_internal_span_batch_add(batch, centerx - x1, centerx - x0, row)) {
+            return false;
+        }
+
+        if (y == 0) {
+            break;
+        }
+    }
+    return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Quantum Painter External API: qp_rect
 
@@ -242,7 +405,7 @@ bool qp_internal_fillrect_helper_impl(painter_device_t device, uint16_t left, ui
     driver->driver_vtable->viewport(device, l, t, r, b);
     while (remaining > 0) {
         uint32_t transmit = QP_MIN(remaining, pixels_in_pixdata);
-        if (!driver->driver_vtable->pixdata(device, qp_internal_global_pixdata_buffer, transmit)) {
+        if (!driver->driver_vtable->pixdata(device, solid_pixdata_buffer, transmit)) {
             return false;
         }
         remaining -= transmit;
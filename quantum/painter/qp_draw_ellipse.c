@@ -7,53 +7,19 @@
 #include "qp_draw.h"
 
 // Utilize 4-way symmetry to draw an ellipse
-static bool qp_ellipse_helper_impl(painter_device_t device, uint16_t centerx, uint16_t centery, uint16_t offsetx, uint16_t offsety, bool filled) {
+static bool qp_ellipse_helper_impl(qp_internal_span_batch_t *batch, int16_t centerx, int16_t centery, int16_t rowx, int16_t offsetx, int16_t offsety, bool filled) {
     /*
     Ellipses have the property of 4-way symmetry, so four pixels can be drawn
     for each computed [offsetx,offsety] given the center coordinates
     represented by [centerx,centery].
 
-    For filled ellipses, we can draw horizontal lines between each pair of
-    pixels with the same final value of y.
-
-    When offsetx == 0 only two pixels can be drawn for filled or unfilled ellipses
+    Pixels are handed to the span batch a row at a time, from [centerx +/-
+    rowx] to [centerx +/- offsetx] on the rows [centery +/- offsety], or the
+    line between them for filled ellipses. The batch turns runs of identical
+    spans on consecutive rows into a single block with one viewport.
     */
 
-    int16_t xpx = ((int16_t)centerx) + ((int16_t)offsetx);
-    int16_t xmx = ((int16_t)centerx) - ((int16_t)offsetx);
-    int16_t ypy = ((int16_t)centery) + ((int16_t)offsety);
-    int16_t ymy = ((int16_t)centery) - ((int16_t)offsety);
-
-    if (offsetx == 0) {
-        if (!qp_internal_setpixel_impl(device, xpx, ypy)) {
-            return false;
-        }
-        if (!qp_internal_setpixel_impl(device, xpx, ymy)) {
-            return false;
-        }
-    } else if (filled) {
-        if (!qp_internal_fillrect_helper_impl(device, xpx, ypy, xmx, ypy)) {
-            return false;
-        }
-        if (offsety > 0 && !qp_internal_fillrect_helper_impl(device, xpx, ymy, xmx, ymy)) {
-            return false;
-        }
-    } else {
-        if (!qp_internal_setpixel_impl(device, xpx, ypy)) {
-            return false;
-        }
-        if (!qp_internal_setpixel_impl(device, xpx, ymy)) {
-            return false;
-        }
-        if (!qp_internal_setpixel_impl(device, xmx, ypy)) {
-            return false;
-        }
-        if (!qp_internal_setpixel_impl(device, xmx, ymy)) {
-            return false;
-        }
-    }
-
-    return true;
+    return qp_internal_span_batch_add_mirrored(batch, centerx, centery, filled ? 0 : rowx, offsetx, offsety);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -72,34 +38,45 @@ bool qp_ellipse(painter_device_t device, uint16_t x, uint16_t y, uint16_t sizex,
     int16_t fa = 4 * ((int16_t)aa);
     int16_t fb = 4 * ((int16_t)bb);
 
-    int16_t dx = 0;
-    int16_t dy = ((int16_t)sizey);
+    int16_t dx   = 0;
+    int16_t dy   = ((int16_t)sizey);
+    int16_t rowx = 0;
 
-    qp_internal_fill_pixdata(device, QP_MAX(sizex, sizey), hue, sat, val);
+    // Blocks can be taller than a single line, so fill the whole buffer
+    qp_internal_fill_pixdata(device, qp_internal_num_pixels_in_buffer(device), hue, sat, val);
 
     if (!qp_comms_start(device)) {
         qp_dprintf("qp_ellipse: fail (could not start comms)\n");
         return false;
     }
 
+    qp_internal_span_batch_t batch;
+    qp_internal_span_batch_init(&batch, device);
+
+    // Near the top and bottom, dx changes on every step, so runs of pixels on the same row are drawn once dy moves on
     bool ret = true;
     for (int16_t delta = (2 * bb) + (aa * (1 - (2 * sizey))); bb * dx <= aa * dy; dx++) {
-        if (!qp_ellipse_helper_impl(device, x, y, dx, dy, filled)) {
-            ret = false;
-            break;
-        }
         if (delta >= 0) {
+            if (!qp_ellipse_helper_impl(&batch, x, y, rowx, dx, dy, filled)) {
+                ret = false;
+                break;
+            }
+            rowx = dx + 1;
             delta += fa * (1 - dy);
             dy--;
         }
         delta += bb * (4 * dx + 6);
     }
+    if (ret && rowx < dx && !qp_ellipse_helper_impl(&batch, x, y, rowx, dx - 1, dy, filled)) {
+        ret = false;
+    }
 
     dx = sizex;
     dy = 0;
 
-    for (int16_t delta = (2 * aa) + (bb * (1 - (2 * sizex))); aa * dy <= bb * dx; dy++) {
-        if (!qp_ellipse_helper_impl(device, x, y, dx, dy, filled)) {
+    // Near the sides, dy changes on every step, so each row gets a single pair of pixels
+    for (int16_t delta = (2 * aa) + (bb * (1 - (2 * sizex))); ret && aa * dy <= bb * dx; dy++) {
+        if (!qp_ellipse_helper_impl(&batch, x, y, dx, dx, dy, filled)) {
             ret = false;
             break;
         }
@@ -110,6 +87,10 @@ bool qp_ellipse(painter_device_t device, uint16_t x, uint16_t y, uint16_t sizex,
         delta += aa * (4 * dy + 6);
     }
 
+    if (ret) {
+        ret = qp_internal_span_batch_flush(&batch);
+    }
+
     qp_dprintf("qp_ellipse: %s\n", ret ? "ok" : "fail");
     qp_comms_stop(device);
     return ret;
@@ -16,6 +16,9 @@ typedef struct qgf_image_handle_t {
     union {
         qp_stream_t        stream;
         qp_memory_stream_t mem_stream;
+#ifdef QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+        qp_flash_stream_t flash_stream;
+#endif // QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
 #ifdef QP_STREAM_HAS_FILE_IO
         qp_file_stream_t file_stream;
 #endif // QP_STREAM_HAS_FILE_IO
@@ -85,6 +88,28 @@ painter_image_handle_t qp_load_image_mem(const void *buffer) {
     return qp_load_image_internal(image_mem_stream_factory, (void *)buffer);
 }
 
+#ifdef QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter External API: qp_load_image_flash
+
+static inline bool image_flash_stream_factory(qgf_image_handle_t *image, void *arg) {
+    uint32_t address = *(uint32_t *)arg;
+
+    // Assume we can read the graphics descriptor
+    image->flash_stream = qp_make_flash_stream(address, sizeof(qgf_graphics_descriptor_v1_t));
+
+    // Update the length of the stream to match, and rewind to the start
+    image->flash_stream.length   = qgf_get_total_size(&image->stream);
+    image->flash_stream.position = 0;
+
+    return true;
+}
+
+painter_image_handle_t qp_load_image_flash(uint32_t address) {
+    return qp_load_image_internal(image_flash_stream_factory, &address);
+}
+#endif // QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Quantum Painter External API: qp_close_image
 
@@ -121,6 +146,7 @@ typedef struct qgf_frame_info_t {
     uint16_t              right;
     uint16_t              bottom;
     uint16_t              delay;
+    qp_pixel_t *          palette;
 } qgf_frame_info_t;
 
 static bool qp_drawimage_prepare_frame_for_stream_read(painter_device_t device, qgf_image_handle_t *qgf_image, uint16_t frame_number, qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888, qgf_frame_info_t *info) {
@@ -147,9 +173,6 @@ static bool qp_drawimage_prepare_frame_for_stream_read(painter_device_t device,
         return false;
     }
 
-    // Ensure we aren't reusing any palette
-    qp_internal_invalidate_palette();
-
     if (!qp_internal_bpp_capable(info->bpp)) {
         qp_dprintf("qp_drawimage_recolor: fail (image bpp too high (%d), check QUANTUM_PAINTER_SUPPORTS_256_PALETTE or QUANTUM_PAINTER_SUPPORTS_NATIVE_COLORS)\n", (int)info->bpp);
         qp_comms_stop(device);
@@ -157,25 +180,24 @@ static bool qp_drawimage_prepare_frame_for_stream_read(painter_device_t device,
     }
 
     // Handle palette if needed
-    const uint16_t palette_entries  = 1u << info->bpp;
-    bool           needs_pixconvert = false;
+    info->palette = NULL;
     if (info->has_palette) {
         // Load the palette from the stream
         if (!qp_internal_load_qgf_palette((qp_stream_t *)&qgf_image->stream, info->bpp)) {
             return false;
         }
 
-        needs_pixconvert = true;
-    } else {
-        if (info->bpp <= 8) {
-            // Interpolate from fg/bg
-            needs_pixconvert = qp_internal_interpolate_palette(fg_hsv888, bg_hsv888, palette_entries);
-        }
-    }
-
-    if (needs_pixconvert) {
         // Convert the palette to native format
-        if (!driver->driver_vtable->palette_convert(device, palette_entries, qp_internal_global_pixel_lookup_table)) {
+        if (!driver->driver_vtable->palette_convert(device, 1u << info->bpp, qp_internal_global_pixel_lookup_table)) {
+            qp_dprintf("qp_drawimage_recolor: fail (could not convert pixels to native)\n");
+            qp_comms_stop(device);
+            return false;
+        }
+        info->palette = qp_internal_global_pixel_lookup_table;
+    } else if (info->bpp <= 8) {
+        // Interpolate from fg/bg, reusing a previous palette if the colors match
+        info->palette = qp_internal_recolor_palette(device, fg_hsv888, bg_hsv888, info->bpp);
+        if (!info->palette) {
             qp_dprintf("qp_drawimage_recolor: fail (could not convert pixels to native)\n");
             qp_comms_stop(device);
             return false;
@@ -268,7 +290,7 @@ static bool qp_drawimage_recolor_impl(painter_device_t device, uint16_t x, uint1
         struct qp_internal_pixel_output_state output_state = {.device = device, .pixel_write_pos = 0, .max_pixels = qp_internal_num_pixels_in_buffer(device)};
 
         // Decode the pixel data and stream to the display
-        ret = qp_internal_decode_palette(device, pixel_count, frame_info->bpp, input_callback, &input_state, qp_internal_global_pixel_lookup_table, qp_internal_pixel_appender, &output_state);
+        ret = qp_internal_decode_palette_block(device, pixel_count, frame_info->bpp, &input_state, frame_info->palette, &output_state);
         // Any leftovers need transmission as well.
         if (ret && output_state.pixel_write_pos > 0) {
             ret &= driver->driver_vtable->pixdata(device, qp_internal_global_pixdata_buffer, output_state.pixel_write_pos);
@@ -279,7 +301,7 @@ static bool qp_drawimage_recolor_impl(painter_device_t device, uint16_t x, uint1
 
         // Stream the raw pixel data to the display
         uint32_t byte_count = pixel_count * frame_info->bpp / 8;
-        ret                 = qp_internal_send_bytes(device, byte_count, input_callback, &input_state, qp_internal_byte_appender, &output_state);
+        ret                 = qp_internal_send_bytes_block(device, byte_count, &input_state, &output_state);
         // Any leftovers need transmission as well.
         if (ret && output_state.byte_write_pos > 0) {
             ret &= driver->driver_vtable->pixdata(device, qp_internal_global_pixdata_buffer, output_state.byte_write_pos * 8 / driver->native_bits_per_pixel);
@@ -298,6 +320,98 @@ bool qp_drawimage_recolor(painter_device_t device, uint16_t x, uint16_t y, paint
     return qp_drawimage_recolor_impl(device, x, y, image, 0, &frame_info, fg_hsv888, bg_hsv888);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter Internal API: qp_internal_drawimage_rows
+
+bool qp_internal_drawimage_rows(painter_device_t device, uint16_t x, uint16_t y, painter_image_handle_t image, uint16_t first_row, uint16_t last_row, qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888, qp_internal_image_cursor_t *cursor) {
+    struct painter_driver_t *driver    = (struct painter_driver_t *)device;
+    qgf_image_handle_t      *qgf_image = (qgf_image_handle_t *)image;
+    if (!driver->validate_ok || !qgf_image->validate_ok || first_row > last_row || last_row >= image->height) {
+        qp_dprintf("qp_internal_drawimage_rows: fail (invalid arguments)\n");
+        return false;
+    }
+
+    // The first frame is never a delta, so covers the whole image
+    qgf_frame_info_t frame_info = {0};
+    if (!qp_drawimage_prepare_frame_for_stream_read(device, qgf_image, 0, fg_hsv888, bg_hsv888, &frame_info) || frame_info.is_delta) {
+        qp_dprintf("qp_internal_drawimage_rows: fail (could not read frame 0)\n");
+        return false;
+    }
+
+    struct qp_internal_byte_input_state input_state = {.device = device, .src_stream = &qgf_image->stream};
+    if (qp_internal_prepare_input_state(&input_state, frame_info.compression_scheme) == NULL) {
+        qp_dprintf("qp_internal_drawimage_rows: fail (invalid image compression scheme)\n");
+        return false;
+    }
+
+    // Back up to the nearest row starting on a byte boundary, which for sub-byte pixels is at most 7 rows up
+    uint8_t  pixels_per_byte = (frame_info.bpp < 8) ? 8 / frame_info.bpp : 1;
+    uint16_t start_row       = first_row;
+    while ((((uint32_t)start_row) * image->width) % pixels_per_byte != 0) {
+        --start_row;
+    }
+
+    // Carry on from the cursor if it's no further down, otherwise from the top of the image
+    uint16_t row = 0;
+    if (cursor && cursor->image == image && cursor->row <= start_row) {
+        if (qp_stream_setpos(&qgf_image->stream, cursor->position) != 0) {
+            return false;
+        }
+        input_state            = cursor->input_state;
+        input_state.device     = device;
+        input_state.src_stream = &qgf_image->stream;
+        if (input_state.compression == IMAGE_COMPRESSED_LZ) {
+            qp_internal_restore_lz_window(cursor->lz_window);
+        }
+        row = cursor->row;
+    }
+
+    // Skipping happens before comms start, as the image may be on a bus shared with the device
+    if (!qp_internal_skip_block(&input_state, ((uint32_t)(start_row - row)) * image->width * frame_info.bpp / 8)) {
+        qp_dprintf("qp_internal_drawimage_rows: fail (could not skip to row %d)\n", (int)start_row);
+        return false;
+    }
+    if (cursor) {
+        cursor->image       = image;
+        cursor->row         = start_row;
+        cursor->position    = qp_stream_tell(&qgf_image->stream);
+        cursor->input_state = input_state;
+        if (input_state.compression == IMAGE_COMPRESSED_LZ) {
+            qp_internal_save_lz_window(cursor->lz_window);
+        }
+    }
+
+    if (!qp_comms_start(device)) {
+        qp_dprintf("qp_internal_drawimage_rows: fail (could not start comms)\n");
+        return false;
+    }
+
+    if (!driver->driver_vtable->viewport(device, x, y + start_row, x + image->width - 1, y + last_row)) {
+        qp_dprintf("qp_internal_drawimage_rows: fail (could not set viewport)\n");
+        qp_comms_stop(device);
+        return false;
+    }
+
+    bool     ret         = false;
+    uint32_t pixel_count = ((uint32_t)image->width) * (last_row - start_row + 1);
+    if (frame_info.bpp <= 8) {
+        struct qp_internal_pixel_output_state output_state = {.device = device, .pixel_write_pos = 0, .max_pixels = qp_internal_num_pixels_in_buffer(device)};
+        ret = qp_internal_decode_palette_block(device, pixel_count, frame_info.bpp, &input_state, frame_info.palette, &output_state);
+        if (ret && output_state.pixel_write_pos > 0) {
+            ret &= driver->driver_vtable->pixdata(device, qp_internal_global_pixdata_buffer, output_state.pixel_write_pos);
+        }
+    } else {
+        struct qp_internal_byte_output_state output_state = {.device = device, .byte_write_pos = 0, .max_bytes = qp_internal_num_pixels_in_buffer(device) * driver->native_bits_per_pixel / 8};
+        ret = qp_internal_send_bytes_block(device, pixel_count * frame_info.bpp / 8, &input_state, &output_state);
+        if (ret && output_state.byte_write_pos > 0) {
+            ret &= driver->driver_vtable->pixdata(device, qp_internal_global_pixdata_buffer, output_state.byte_write_pos * 8 / driver->native_bits_per_pixel);
+        }
+    }
+
+    qp_comms_stop(device);
+    return ret;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Quantum Painter External API: qp_animate
 
@@ -317,36 +431,113 @@ typedef struct animation_state_t {
     qp_pixel_t             bg_hsv888;
     uint16_t               frame_number;
     deferred_token         defer_token;
+    uint32_t               start_time;
+    uint32_t               due_time; // when frame_number should be on screen
+    uint32_t               frames_drawn;
+    uint32_t               frames_skipped;
+    uint16_t               last_frame_ms;
+    uint16_t               max_frame_ms;
 } animation_state_t;
 
 static deferred_executor_t animation_executors[QUANTUM_PAINTER_CONCURRENT_ANIMATIONS] = {0};
 static animation_state_t   animation_states[QUANTUM_PAINTER_CONCURRENT_ANIMATIONS]    = {0};
 
+static bool qp_animation_frame_timing(animation_state_t *state, uint16_t frame_number, bool *is_delta, uint16_t *delay_ms) {
+    qgf_image_handle_t *qgf_image = (qgf_image_handle_t *)state->image;
+    qgf_seek_to_frame_descriptor(&qgf_image->stream, frame_number);
+
+    qgf_frame_v1_t frame_descriptor;
+    if (qp_stream_read(&frame_descriptor, sizeof(qgf_frame_v1_t), 1, &qgf_image->stream) != 1) {
+        return false;
+    }
+
+    uint8_t bpp;
+    bool    has_palette;
+    return qgf_parse_frame_descriptor(&frame_descriptor, &bpp, &has_palette, is_delta, NULL, delay_ms);
+}
+
+static void qp_animation_catch_up(animation_state_t *state, uint32_t now) {
+    if (!timer_expired32(now, state->due_time)) {
+        return;
+    }
+
+    // Find the latest full frame which should already be on screen. Delta frames can't be skipped to as they only hold
+    // the changes from the frame before them, so anything in between a full frame and its deltas has to be drawn.
+    uint32_t behind       = TIMER_DIFF_32(now, state->due_time);
+    uint32_t elapsed      = 0;
+    uint32_t skip_elapsed = 0;
+    uint16_t skip_count   = 0;
+    uint16_t frame_number = state->frame_number;
+    for (uint16_t i = 0; i < state->image->frame_count && elapsed <= behind; ++i) {
+        bool     is_delta;
+        uint16_t delay_ms;
+        if (!qp_animation_frame_timing(state, frame_number, &is_delta, &delay_ms)) {
+            return;
+        }
+        if (i > 0 && !is_delta) {
+            skip_count   = i;
+            skip_elapsed = elapsed;
+        }
+        elapsed += delay_ms;
+        if (++frame_number >= state->image->frame_count) {
+            frame_number = 0;
+        }
+    }
+
+    if (skip_count > 0) {
+        qp_dprintf("qp_animation_catch_up: skipping %d frames (%dms behind)\n", (int)skip_count, (int)behind);
+        state->frame_number = (state->frame_number + skip_count) % state->image->frame_count;
+        state->due_time += skip_elapsed;
+        state->frames_skipped += skip_count;
+    }
+}
+
 static deferred_token qp_render_animation_state(animation_state_t *state, uint16_t *delay_ms) {
     qgf_frame_info_t frame_info = {0};
     qp_dprintf("qp_render_animation_state: entry (frame #%d)\n", (int)state->frame_number);
-    bool ret = qp_drawimage_recolor_impl(state->device, state->x, state->y, state->image, state->frame_number, &frame_info, state->fg_hsv888, state->bg_hsv888);
+    uint32_t start = timer_read32();
+    bool     ret   = qp_drawimage_recolor_impl(state->device, state->x, state->y, state->image, state->frame_number, &frame_info, state->fg_hsv888, state->bg_hsv888);
     if (ret) {
+        uint32_t frame_ms    = TIMER_DIFF_32(timer_read32(), start);
+        state->last_frame_ms = frame_ms > UINT16_MAX ? UINT16_MAX : frame_ms;
+        if (state->last_frame_ms > state->max_frame_ms) {
+            state->max_frame_ms = state->last_frame_ms;
+        }
+        ++state->frames_drawn;
+
         ++state->frame_number;
         if (state->frame_number >= state->image->frame_count) {
             state->frame_number = 0;
         }
         *delay_ms = frame_info.delay;
+        state->due_time += frame_info.delay;
     }
     qp_dprintf("qp_render_animation_state: %s (delay %dms)\n", ret ? "ok" : "fail", (int)(*delay_ms));
     return ret;
 }
 
+static uint32_t qp_animation_next_delay(animation_state_t *state, uint32_t from) {
+    // Keep to the animation's schedule, but if it's fallen behind leave some time for the rest of the firmware
+    uint32_t now  = timer_read32();
+    uint32_t next = state->due_time;
+    if ((int32_t)TIMER_DIFF_32(next, now) < QUANTUM_PAINTER_ANIMATION_MIN_IDLE_MS) {
+        next = now + QUANTUM_PAINTER_ANIMATION_MIN_IDLE_MS;
+    }
+    uint32_t delay_ms = TIMER_DIFF_32(next, from);
+    return delay_ms > 0 ? delay_ms : 1;
+}
+
 static uint32_t animation_callback(uint32_t trigger_time, void *cb_arg) {
     animation_state_t *state = (animation_state_t *)cb_arg;
     uint16_t           delay_ms;
-    bool               ret = qp_render_animation_state(state, &delay_ms);
+    qp_animation_catch_up(state, timer_read32());
+    bool ret = qp_render_animation_state(state, &delay_ms);
     if (!ret) {
         // Setting the device to NULL clears the animation slot
         state->device = NULL;
     }
     // If we're successful, keep animating -- returning 0 cancels the deferred execution
-    return ret ? delay_ms : 0;
+    return ret && delay_ms > 0 ? qp_animation_next_delay(state, trigger_time) : 0;
 }
 
 deferred_token qp_animate_recolor(painter_device_t device, uint16_t x, uint16_t y, painter_image_handle_t image, uint8_t hue_fg, uint8_t sat_fg, uint8_t val_fg, uint8_t hue_bg, uint8_t sat_bg, uint8_t val_bg) {
@@ -372,7 +563,13 @@ deferred_token qp_animate_recolor(painter_device_t device, uint16_t x, uint16_t
     anim_state->image        = image;
     anim_state->fg_hsv888    = (qp_pixel_t){.hsv888 = {.h = hue_fg, .s = sat_fg, .v = val_fg}};
     anim_state->bg_hsv888    = (qp_pixel_t){.hsv888 = {.h = hue_bg, .s = sat_bg, .v = val_bg}};
-    anim_state->frame_number = 0;
+    anim_state->frame_number   = 0;
+    anim_state->start_time     = timer_read32();
+    anim_state->due_time       = anim_state->start_time;
+    anim_state->frames_drawn   = 0;
+    anim_state->frames_skipped = 0;
+    anim_state->last_frame_ms  = 0;
+    anim_state->max_frame_ms   = 0;
 
     // Draw the first frame
     uint16_t delay_ms;
@@ -383,7 +580,7 @@ deferred_token qp_animate_recolor(painter_device_t device, uint16_t x, uint16_t
     }
 
     // Set up the timer
-    anim_state->defer_token = defer_exec_advanced(animation_executors, QUANTUM_PAINTER_CONCURRENT_ANIMATIONS, delay_ms, animation_callback, anim_state);
+    anim_state->defer_token = defer_exec_advanced(animation_executors, QUANTUM_PAINTER_CONCURRENT_ANIMATIONS, delay_ms > 0 ? qp_animation_next_delay(anim_state, timer_read32()) : 0, animation_callback, anim_state);
     if (anim_state->defer_token == INVALID_DEFERRED_TOKEN) {
         anim_state->device = NULL; // disregard the allocated animation slot
         qp_dprintf("qp_animate_recolor: fail (could not set up animation executor)\n");
@@ -407,6 +604,27 @@ void qp_stop_animation(deferred_token anim_token) {
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter External API: qp_get_animation_stats
+
+bool qp_get_animation_stats(deferred_token anim_token, painter_animation_stats_t *stats) {
+    for (int i = 0; i < QUANTUM_PAINTER_CONCURRENT_ANIMATIONS; ++i) {
+        animation_state_t *state = &animation_states[i];
+        if (state->device != NULL && state->defer_token == anim_token) {
+            uint32_t elapsed      = TIMER_DIFF_32(timer_read32(), state->start_time);
+            uint64_t fps_x100     = elapsed > 0 ? (uint64_t)state->frames_drawn * 100000 / elapsed : 0;
+            stats->elapsed_ms     = elapsed;
+            stats->frames_drawn   = state->frames_drawn;
+            stats->frames_skipped = state->frames_skipped;
+            stats->fps_x100       = fps_x100 > UINT16_MAX ? UINT16_MAX : fps_x100;
+            stats->last_frame_ms  = state->last_frame_ms;
+            stats->max_frame_ms   = state->max_frame_ms;
+            return true;
+        }
+    }
+    return false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Quantum Painter Core API: qp_internal_animation_tick
 
@@ -23,6 +23,9 @@ typedef struct qff_font_handle_t {
     union {
         qp_stream_t        stream;
         qp_memory_stream_t mem_stream;
+#ifdef QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+        qp_flash_stream_t flash_stream;
+#endif // QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
 #ifdef QP_STREAM_HAS_FILE_IO
         qp_file_stream_t file_stream;
 #endif // QP_STREAM_HAS_FILE_IO
@@ -35,6 +38,105 @@ typedef struct qff_font_handle_t {
 
 static qff_font_handle_t font_descriptors[QUANTUM_PAINTER_NUM_FONTS] = {0};
 
+#if QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Glyph cache
+//
+// Decoded glyphs are held in the display's native pixel format, packed one after the other at the start of the arena in
+// the same order as their entries. Dropping an entry moves everything after it down, so the free space is always in one
+// piece at the end of the arena.
+
+_Static_assert(QUANTUM_PAINTER_GLYPH_CACHE_SIZE <= UINT16_MAX, "QUANTUM_PAINTER_GLYPH_CACHE_SIZE needs to be less than 65536");
+_Static_assert(QUANTUM_PAINTER_GLYPH_CACHE_ENTRIES > 0, "QUANTUM_PAINTER_GLYPH_CACHE_ENTRIES needs to be non-zero");
+
+typedef struct qp_glyph_cache_entry_t {
+    const qff_font_handle_t *font;
+    painter_device_t         device;
+    uint32_t                 code_point;
+    uint32_t                 last_used;
+    qp_pixel_t               fg_hsv888;
+    qp_pixel_t               bg_hsv888;
+    uint16_t                 offset;
+    uint16_t                 size;
+    uint8_t                  width;
+} qp_glyph_cache_entry_t;
+
+__attribute__((__aligned__(4))) static uint8_t glyph_cache_arena[QUANTUM_PAINTER_GLYPH_CACHE_SIZE];
+static qp_glyph_cache_entry_t                  glyph_cache_entries[QUANTUM_PAINTER_GLYPH_CACHE_ENTRIES];
+static uint16_t                                glyph_cache_count = 0;
+static uint16_t                                glyph_cache_used  = 0;
+static uint32_t                                glyph_cache_clock = 0;
+
+static inline bool qp_glyph_cache_color_matches(qp_pixel_t a, qp_pixel_t b) {
+    return a.hsv888.h == b.hsv888.h && a.hsv888.s == b.hsv888.s && a.hsv888.v == b.hsv888.v;
+}
+
+// Finds a previously decoded glyph, marking it as the most recently used
+static qp_glyph_cache_entry_t *qp_glyph_cache_find(const qff_font_handle_t *qff_font, painter_device_t device, uint32_t code_point, qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888) {
+    for (uint16_t i = 0; i < glyph_cache_count; ++i) {
+        qp_glyph_cache_entry_t *entry = &glyph_cache_entries[i];
+        if (entry->code_point == code_point && entry->font == qff_font && entry->device == device && qp_glyph_cache_color_matches(entry->fg_hsv888, fg_hsv888) && qp_glyph_cache_color_matches(entry->bg_hsv888, bg_hsv888)) {
+            entry->last_used = ++glyph_cache_clock;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// Drops an entry, moving the glyphs after it down to fill the gap
+static void qp_glyph_cache_remove(uint16_t index) {
+    uint16_t start = glyph_cache_entries[index].offset;
+    uint16_t size  = glyph_cache_entries[index].size;
+    memmove(&glyph_cache_arena[start], &glyph_cache_arena[start + size], glyph_cache_used - (start + size));
+    glyph_cache_used -= size;
+
+    for (uint16_t i = index + 1; i < glyph_cache_count; ++i) {
+        glyph_cache_entries[i - 1] = glyph_cache_entries[i];
+        glyph_cache_entries[i - 1].offset -= size;
+    }
+    --glyph_cache_count;
+}
+
+// Reserves space for a glyph, dropping the least recently used ones until it fits. Returns NULL if it can never fit.
+static qp_glyph_cache_entry_t *qp_glyph_cache_insert(const qff_font_handle_t *qff_font, painter_device_t device, uint32_t code_point, qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888, uint8_t width, uint32_t size) {
+    if (size == 0 || size > QUANTUM_PAINTER_GLYPH_CACHE_SIZE) {
+        return NULL;
+    }
+
+    while (glyph_cache_count == QUANTUM_PAINTER_GLYPH_CACHE_ENTRIES || (QUANTUM_PAINTER_GLYPH_CACHE_SIZE - glyph_cache_used) < size) {
+        uint16_t lru = 0;
+        for (uint16_t i = 1; i < glyph_cache_count; ++i) {
+            if (glyph_cache_entries[i].last_used < glyph_cache_entries[lru].last_used) {
+                lru = i;
+            }
+        }
+        qp_glyph_cache_remove(lru);
+    }
+
+    qp_glyph_cache_entry_t *entry = &glyph_cache_entries[glyph_cache_count++];
+    entry->font                   = qff_font;
+    entry->device                 = device;
+    entry->code_point             = code_point;
+    entry->last_used              = ++glyph_cache_clock;
+    entry->fg_hsv888              = fg_hsv888;
+    entry->bg_hsv888              = bg_hsv888;
+    entry->offset                 = glyph_cache_used;
+    entry->size                   = (uint16_t)size;
+    entry->width                  = width;
+    glyph_cache_used += size;
+    return entry;
+}
+
+// Drops all the glyphs belonging to a font
+static void qp_glyph_cache_invalidate_font(const qff_font_handle_t *qff_font) {
+    for (uint16_t i = glyph_cache_count; i > 0; --i) {
+        if (glyph_cache_entries[i - 1].font == qff_font) {
+            qp_glyph_cache_remove(i - 1);
+        }
+    }
+}
+#endif // QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Helper: load font from stream
 
@@ -72,13 +174,15 @@ static painter_font_handle_t qp_load_font_internal(bool (*stream_factory)(qff_fo
     font->owns_buffer = false;
     font->buffer      = NULL;
 
-    void *ram_buffer = malloc(font->mem_stream.length);
+    // Fonts can come from any kind of stream, so ask the font itself how big it is
+    uint32_t length     = qff_get_total_size(&font->stream);
+    void *   ram_buffer = malloc(length);
     if (ram_buffer == NULL) {
         qp_dprintf("qp_load_font: could not allocate enough RAM for font, falling back to original\n");
     } else {
         do {
             // Copy the data into RAM
-            if (qp_stream_read(ram_buffer, 1, font->mem_stream.length, &font->mem_stream) != font->mem_stream.length) {
+            if (qp_stream_read(ram_buffer, 1, length, &font->stream) != length) {
                 qp_dprintf("qp_load_font: could not copy from flash to RAM, falling back to original\n");
                 break;
             }
@@ -86,7 +190,7 @@ static painter_font_handle_t qp_load_font_internal(bool (*stream_factory)(qff_fo
             // Create the new stream with the new buffer
             font->buffer      = ram_buffer;
             font->owns_buffer = true;
-            font->mem_stream  = qp_make_memory_stream(font->buffer, font->mem_stream.length);
+            font->mem_stream  = qp_make_memory_stream(font->buffer, length);
         } while (0);
     }
 
@@ -131,6 +235,28 @@ painter_font_handle_t qp_load_font_mem(const void *buffer) {
     return qp_load_font_internal(font_mem_stream_factory, (void *)buffer);
 }
 
+#ifdef QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter External API: qp_load_font_flash
+
+static inline bool font_flash_stream_factory(qff_font_handle_t *font, void *arg) {
+    uint32_t address = *(uint32_t *)arg;
+
+    // Assume we can read the font descriptor
+    font->flash_stream = qp_make_flash_stream(address, sizeof(qff_font_descriptor_v1_t));
+
+    // Update the length of the stream to match, and rewind to the start
+    font->flash_stream.length   = qff_get_total_size(&font->stream);
+    font->flash_stream.position = 0;
+
+    return true;
+}
+
+painter_font_handle_t qp_load_font_flash(uint32_t address) {
+    return qp_load_font_internal(font_flash_stream_factory, &address);
+}
+#endif // QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Quantum Painter External API: qp_close_font
 
@@ -150,6 +276,11 @@ bool qp_close_font(painter_font_handle_t font) {
     }
 #endif // QUANTUM_PAINTER_LOAD_FONTS_TO_RAM
 
+#if QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+    // Anything decoded from this font is no longer valid
+    qp_glyph_cache_invalidate_font(qff_font);
+#endif // QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+
     // Free up this font for use elsewhere.
     qp_stream_close(&qff_font->stream);
     qff_font->validate_ok = false;
@@ -160,14 +291,14 @@ bool qp_close_font(painter_font_handle_t font) {
 // Helpers
 
 // Callback to be invoked for each codepoint detected in the UTF8 input string
-typedef bool (*code_point_handler)(qff_font_handle_t *qff_font, uint32_t code_point, uint8_t width, uint8_t height, void *cb_arg);
+typedef bool (*code_point_handler)(qff_font_handle_t *qff_font, uint32_t code_point, void *cb_arg);
 
-// Helper that sets up the palette (if required) and returns the offset in the stream that the data starts
-static inline bool qp_drawtext_prepare_font_for_render(painter_device_t device, qff_font_handle_t *qff_font, qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888, uint32_t *data_offset) {
+// Helper that sets up the palette and returns the offset in the stream that the data starts
+static inline bool qp_drawtext_prepare_font_for_render(painter_device_t device, qff_font_handle_t *qff_font, qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888, uint32_t *data_offset, qp_pixel_t **palette) {
     struct painter_driver_t *driver = (struct painter_driver_t *)device;
 
     // Drop out if we can't actually place the data we read out anywhere
-    if (!data_offset) {
+    if (!data_offset || !palette) {
         qp_dprintf("Failed to prepare stream for read, output info buffer unavailable\n");
         return false;
     }
@@ -181,9 +312,8 @@ static inline bool qp_drawtext_prepare_font_for_render(painter_device_t device,
         offset += sizeof(qff_unicode_glyph_table_v1_t) + (qff_font->num_unicode_glyphs * 6);
     }
 
-    // Handle palette if needed
-    const uint16_t palette_entries  = 1u << qff_font->bpp;
-    bool           needs_pixconvert = false;
+    // Handle palette
+    const uint16_t palette_entries = 1u << qff_font->bpp;
     if (qff_font->has_palette) {
         // If this font has a palette, we need to read it out and set up the pixel lookup table
         qp_stream_setpos(&qff_font->stream, offset);
@@ -193,18 +323,18 @@ static inline bool qp_drawtext_prepare_font_for_render(painter_device_t device,
 
         // Skip this block, as far as offset calculations go
         offset += sizeof(qgf_palette_v1_t) + (palette_entries * 3);
-        needs_pixconvert = true;
-    } else {
-        // Interpolate from fg/bg
-        int16_t palette_entries = 1 << qff_font->bpp;
-        needs_pixconvert        = qp_internal_interpolate_palette(fg_hsv888, bg_hsv888, palette_entries);
-    }
 
-    if (needs_pixconvert) {
         // Convert the palette to native format
         if (!driver->driver_vtable->palette_convert(device, palette_entries, qp_internal_global_pixel_lookup_table)) {
             qp_dprintf("qp_drawtext_recolor: fail (could not convert pixels to native)\n");
-            qp_comms_stop(device);
+            return false;
+        }
+        *palette = qp_internal_global_pixel_lookup_table;
+    } else {
+        // Interpolate from fg/bg, reusing a previous palette if the colors match
+        *palette = qp_internal_recolor_palette(device, fg_hsv888, bg_hsv888, qff_font->bpp);
+        if (!*palette) {
+            qp_dprintf("qp_drawtext_recolor: fail (could not convert pixels to native)\n");
             return false;
         }
     }
@@ -301,13 +431,7 @@ static inline bool qp_iterate_code_points(qff_font_handle_t *qff_font, const cha
             return false;
         }
 
-        uint8_t width;
-        if (!qp_drawtext_prepare_glyph_for_render(qff_font, code_point, &width)) {
-            qp_dprintf("Failed to prepare glyph for rendering.\n");
-            return false;
-        }
-
-        if (!handler(qff_font, code_point, width, qff_font->base.line_height, cb_arg)) {
+        if (!handler(qff_font, code_point, cb_arg)) {
             qp_dprintf("Failed to execute glyph handler.\n");
             return false;
         }
@@ -324,9 +448,15 @@ struct code_point_iter_calcwidth_state {
 };
 
 // Codepoint handler callback: width calc
-static inline bool qp_font_code_point_handler_calcwidth(qff_font_handle_t *qff_font, uint32_t code_point, uint8_t width, uint8_t height, void *cb_arg) {
+static inline bool qp_font_code_point_handler_calcwidth(qff_font_handle_t *qff_font, uint32_t code_point, void *cb_arg) {
     struct code_point_iter_calcwidth_state *state = (struct code_point_iter_calcwidth_state *)cb_arg;
 
+    uint8_t width;
+    if (!qp_drawtext_prepare_glyph_for_render(qff_font, code_point, &width)) {
+        qp_dprintf("Failed to prepare glyph for rendering.\n");
+        return false;
+    }
+
     // Increment the overall width by this glyph's width
     state->width += width;
 
@@ -341,18 +471,47 @@ struct code_point_iter_drawglyph_state {
     painter_device_t                       device;
     int16_t                                xpos;
     int16_t                                ypos;
-    qp_internal_byte_input_callback        input_callback;
+    qp_pixel_t                             fg_hsv888;
+    qp_pixel_t                             bg_hsv888;
+    qp_pixel_t *                           palette;
     struct qp_internal_byte_input_state *  input_state;
     struct qp_internal_pixel_output_state *output_state;
 };
 
 // Codepoint handler callback: drawing
-static inline bool qp_font_code_point_handler_drawglyph(qff_font_handle_t *qff_font, uint32_t code_point, uint8_t width, uint8_t height, void *cb_arg) {
+static inline bool qp_font_code_point_handler_drawglyph(qff_font_handle_t *qff_font, uint32_t code_point, void *cb_arg) {
     struct code_point_iter_drawglyph_state *state  = (struct code_point_iter_drawglyph_state *)cb_arg;
     struct painter_driver_t *               driver = (struct painter_driver_t *)state->device;
+    uint8_t                                 height = qff_font->base.line_height;
+    uint8_t                                 width;
+
+#if QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+    // Glyphs which have already been decoded are sent straight from the cache
+    qp_glyph_cache_entry_t *entry = qp_glyph_cache_find(qff_font, state->device, code_point, state->fg_hsv888, state->bg_hsv888);
+    if (entry) {
+        width = entry->width;
+        driver->driver_vtable->viewport(state->device, state->xpos, state->ypos, state->xpos + width - 1, state->ypos + height - 1);
+        state->xpos += width;
+        return driver->driver_vtable->pixdata(state->device, &glyph_cache_arena[entry->offset], ((uint32_t)width) * height);
+    }
+#endif // QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
 
-    // Reset the input state's RLE mode -- the stream should already be correctly positioned by qp_iterate_code_points()
-    state->input_state->rle.mode = MARKER_BYTE; // ignored if not using RLE
+    // The palette is only needed once something actually has to be decoded
+    if (!state->palette) {
+        uint32_t data_offset;
+        if (!qp_drawtext_prepare_font_for_render(state->device, qff_font, state->fg_hsv888, state->bg_hsv888, &data_offset, &state->palette)) {
+            qp_dprintf("Failed to prepare font for rendering.\n");
+            return false;
+        }
+    }
+
+    if (!qp_drawtext_prepare_glyph_for_render(qff_font, code_point, &width)) {
+        qp_dprintf("Failed to prepare glyph for rendering.\n");
+        return false;
+    }
+
+    // Reset the input state's decoder, as each glyph is compressed separately -- the stream should already be correctly positioned by qp_drawtext_prepare_glyph_for_render()
+    qp_internal_prepare_input_state(state->input_state, state->input_state->compression);
 
     // Reset the output state
     state->output_state->pixel_write_pos = 0;
@@ -363,9 +522,23 @@ static inline bool qp_font_code_point_handler_drawglyph(qff_font_handle_t *qff_f
     // Move the x-position for the next glyph
     state->xpos += width;
 
-    // Decode the pixel data for the glyph
     uint32_t pixel_count = ((uint32_t)width) * height;
-    bool     ret         = qp_internal_decode_palette(state->device, pixel_count, qff_font->bpp, state->input_callback, state->input_state, qp_internal_global_pixel_lookup_table, qp_internal_pixel_appender, state->output_state);
+
+#if QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+    // Decode the whole glyph into the cache instead of the pixdata buffer, so it gets transmitted from there in one go
+    entry = qp_glyph_cache_insert(qff_font, state->device, code_point, state->fg_hsv888, state->bg_hsv888, width, (pixel_count * driver->native_bits_per_pixel + 7) / 8);
+    if (entry) {
+        struct qp_internal_pixel_output_state cache_output_state = {.device = state->device, .pixel_write_pos = 0, .max_pixels = pixel_count, .buffer = &glyph_cache_arena[entry->offset]};
+        if (!qp_internal_decode_palette_block(state->device, pixel_count, qff_font->bpp, state->input_state, state->palette, &cache_output_state)) {
+            qp_glyph_cache_remove(entry - glyph_cache_entries);
+            return false;
+        }
+        return true;
+    }
+#endif // QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+
+    // Decode the pixel data for the glyph
+    bool ret = qp_internal_decode_palette_block(state->device, pixel_count, qff_font->bpp, state->input_state, state->palette, state->output_state);
 
     // Any leftovers need transmission as well.
     if (ret && state->output_state->pixel_write_pos > 0) {
@@ -434,26 +607,27 @@ int16_t qp_drawtext_recolor(painter_device_t device, uint16_t x, uint16_t y, pai
     // Set up the pixel output state
     struct qp_internal_pixel_output_state output_state = {.device = device, .pixel_write_pos = 0, .max_pixels = qp_internal_num_pixels_in_buffer(device)};
 
-    // Set up the codepoint iteration state
+    // Fonts with their own palette ignore the requested colors, so don't let them split up the glyph cache
+    qp_pixel_t fg_hsv888 = {.hsv888 = {.h = hue_fg, .s = sat_fg, .v = val_fg}};
+    qp_pixel_t bg_hsv888 = {.hsv888 = {.h = hue_bg, .s = sat_bg, .v = val_bg}};
+    if (qff_font->has_palette) {
+        fg_hsv888 = bg_hsv888 = (qp_pixel_t){.dummy = 0};
+    }
+
+    // Set up the codepoint iteration state -- the palette is set up on the first glyph which needs decoding
     struct code_point_iter_drawglyph_state state = {// Common
                                                     .device = device,
                                                     .xpos   = x,
                                                     .ypos   = y,
+                                                    // Colors
+                                                    .fg_hsv888 = fg_hsv888,
+                                                    .bg_hsv888 = bg_hsv888,
+                                                    .palette   = NULL,
                                                     // Input
-                                                    .input_callback = input_callback,
-                                                    .input_state    = &input_state,
+                                                    .input_state = &input_state,
                                                     // Output
                                                     .output_state = &output_state};
 
-    qp_pixel_t fg_hsv888 = {.hsv888 = {.h = hue_fg, .s = sat_fg, .v = val_fg}};
-    qp_pixel_t bg_hsv888 = {.hsv888 = {.h = hue_bg, .s = sat_bg, .v = val_bg}};
-    uint32_t   data_offset;
-    if (!qp_drawtext_prepare_font_for_render(driver, qff_font, fg_hsv888, bg_hsv888, &data_offset)) {
-        qp_dprintf("qp_drawtext_recolor: fail (failed to prepare font for rendering)\n");
-        qp_comms_stop(device);
-        return false;
-    }
-
     // Iterate the codepoints with the drawglyph callback
     bool ret = qp_iterate_code_points(qff_font, str, qp_font_code_point_handler_drawglyph, &state);
 
@@ -3,6 +3,10 @@
 
 #pragma once
 
+#ifdef __cplusplus
+#    define _Static_assert static_assert
+#endif
+
 #include "quantum.h"
 #include "qp.h"
 
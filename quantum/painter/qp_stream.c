@@ -1,12 +1,23 @@
 // Copyright 2021 Nick Brassel (@tzarc)
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <string.h>
+
 #include "qp_stream.h"
+#include "qp_comms.h"
+
+#ifdef QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+#    include "flash_spi.h"
+#endif // QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Stream API
 
 uint32_t qp_stream_read_impl(void *output_buf, uint32_t member_size, uint32_t num_members, qp_stream_t *stream) {
+    if (stream->read) {
+        return stream->read(stream, output_buf, num_members * member_size) / member_size;
+    }
+
     uint8_t *output_ptr = (uint8_t *)output_buf;
 
     uint32_t i;
@@ -47,6 +58,18 @@ static inline int16_t mem_get(qp_stream_t *stream) {
     return s->buffer[s->position++];
 }
 
+static inline uint32_t mem_read(qp_stream_t *stream, void *output_buf, uint32_t length) {
+    qp_memory_stream_t *s     = (qp_memory_stream_t *)stream;
+    uint32_t            avail = (s->position < s->length) ? (uint32_t)(s->length - s->position) : 0;
+    if (length > avail) {
+        length    = avail;
+        s->is_eof = true;
+    }
+    memcpy(output_buf, &s->buffer[s->position], length);
+    s->position += length;
+    return length;
+}
+
 static inline bool mem_put(qp_stream_t *stream, uint8_t c) {
     qp_memory_stream_t *s = (qp_memory_stream_t *)stream;
     if (s->position >= s->length) {
@@ -111,7 +134,7 @@ static inline void mem_close(qp_stream_t *stream) {
 
 qp_memory_stream_t qp_make_memory_stream(void *buffer, int32_t length) {
     qp_memory_stream_t stream = {
-        .base     = {.get = mem_get, .put = mem_put, .seek = mem_seek, .tell = mem_tell, .is_eof = mem_is_eof, .close = mem_close},
+        .base     = {.get = mem_get, .put = mem_put, .read = mem_read, .seek = mem_seek, .tell = mem_tell, .is_eof = mem_is_eof, .close = mem_close},
         .buffer   = (uint8_t *)buffer,
         .length   = length,
         .position = 0,
@@ -119,6 +142,210 @@ qp_memory_stream_t qp_make_memory_stream(void *buffer, int32_t length) {
     return stream;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// External flash streams
+//
+// Flash is read a block at a time into a cache shared by all flash streams, so that byte-at-a-time access costs one
+// flash transaction per block rather than one per byte. Bulk reads of whole blocks skip the cache and go straight from
+// flash into the caller's buffer in a single transaction.
+
+#ifdef QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+
+_Static_assert((QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE & (QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE - 1)) == 0, "QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE needs to be a power of two");
+_Static_assert(QUANTUM_PAINTER_FLASH_STREAM_CACHE_BLOCKS > 0, "QUANTUM_PAINTER_FLASH_STREAM_CACHE_BLOCKS needs to be non-zero");
+
+typedef struct qp_flash_cache_block_t {
+    bool     valid;
+    uint32_t address; // block-aligned flash address
+    uint32_t last_used;
+    uint8_t  data[QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE];
+} qp_flash_cache_block_t;
+
+static qp_flash_cache_block_t flash_cache[QUANTUM_PAINTER_FLASH_STREAM_CACHE_BLOCKS];
+static qp_flash_cache_block_t *flash_cache_last = &flash_cache[0];
+static uint32_t                flash_cache_clock = 0;
+
+// The flash chip is usually on the same SPI bus as the display, which can't have its chip select held at the same time,
+// so any display comms are stopped for each flash transaction and restarted afterwards
+static flash_status_t flash_read_shared(uint32_t address, void *data, uint32_t length) {
+    painter_device_t paused = qp_comms_pause();
+    flash_status_t   status = flash_read_block(address, data, length);
+    if (paused && !qp_comms_start(paused)) {
+        qp_dprintf("qp_flash_stream: fail (could not restart display comms)\n");
+        return FLASH_STATUS_ERROR;
+    }
+    return status;
+}
+
+void qp_flash_stream_invalidate_cache(void) {
+    for (uint8_t i = 0; i < QUANTUM_PAINTER_FLASH_STREAM_CACHE_BLOCKS; ++i) {
+        flash_cache[i].valid     = false;
+        flash_cache[i].last_used = 0;
+    }
+    flash_cache_clock = 0;
+}
+
+// Returns the cached block holding the supplied flash address, reading it from flash if need be
+static const qp_flash_cache_block_t *flash_cache_fetch(uint32_t address) {
+    address &= ~(uint32_t)(QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE - 1);
+
+    // Sequential reads nearly always hit the same block as last time
+    qp_flash_cache_block_t *block = flash_cache_last;
+    if (!block->valid || block->address != address) {
+        block = NULL;
+        for (uint8_t i = 0; i < QUANTUM_PAINTER_FLASH_STREAM_CACHE_BLOCKS; ++i) {
+            if (flash_cache[i].valid && flash_cache[i].address == address) {
+                block = &flash_cache[i];
+                break;
+            }
+        }
+    }
+
+    if (!block) {
+        // Replace the least recently used block, unused ones first
+        block = &flash_cache[0];
+        for (uint8_t i = 1; i < QUANTUM_PAINTER_FLASH_STREAM_CACHE_BLOCKS && block->valid; ++i) {
+            if (!flash_cache[i].valid || flash_cache[i].last_used < block->last_used) {
+                block = &flash_cache[i];
+            }
+        }
+
+        block->address = address;
+        block->valid   = flash_read_shared(address, block->data, QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE) == FLASH_STATUS_SUCCESS;
+        if (!block->valid) {
+            qp_dprintf("qp_flash_stream: fail (could not read flash at 0x%08lX)\n", (unsigned long)address);
+            return NULL;
+        }
+    }
+
+    block->last_used = ++flash_cache_clock;
+    flash_cache_last = block;
+    return block;
+}
+
+static inline int16_t flash_get(qp_stream_t *stream) {
+    qp_flash_stream_t *s = (qp_flash_stream_t *)stream;
+    if (s->position >= s->length) {
+        s->is_eof = true;
+        return STREAM_EOF;
+    }
+
+    uint32_t                      address = s->address + s->position;
+    const qp_flash_cache_block_t *block   = flash_cache_fetch(address);
+    if (!block) {
+        return STREAM_EOF;
+    }
+
+    s->position++;
+    return block->data[address & (QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE - 1)];
+}
+
+static inline uint32_t flash_read(qp_stream_t *stream, void *output_buf, uint32_t length) {
+    qp_flash_stream_t *s     = (qp_flash_stream_t *)stream;
+    uint32_t           avail = (s->position < s->length) ? (uint32_t)(s->length - s->position) : 0;
+    if (length > avail) {
+        length    = avail;
+        s->is_eof = true;
+    }
+
+    uint8_t *output_ptr = (uint8_t *)output_buf;
+    uint32_t remaining  = length;
+    while (remaining > 0) {
+        uint32_t address = s->address + s->position;
+        uint32_t offset  = address & (QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE - 1);
+        uint32_t count;
+
+        if (offset == 0 && remaining >= QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE) {
+            // Whole blocks don't need to go through the cache
+            count = remaining & ~(uint32_t)(QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE - 1);
+            if (flash_read_shared(address, output_ptr, count) != FLASH_STATUS_SUCCESS) {
+                qp_dprintf("qp_flash_stream: fail (could not read flash at 0x%08lX)\n", (unsigned long)address);
+                break;
+            }
+        } else {
+            const qp_flash_cache_block_t *block = flash_cache_fetch(address);
+            if (!block) {
+                break;
+            }
+            count = QP_MIN(remaining, QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE - offset);
+            memcpy(output_ptr, &block->data[offset], count);
+        }
+
+        output_ptr += count;
+        s->position += count;
+        remaining -= count;
+    }
+
+    return length - remaining;
+}
+
+static inline bool flash_put(qp_stream_t *stream, uint8_t c) {
+    // Flash streams are read-only
+    return false;
+}
+
+static inline int flash_seek(qp_stream_t *stream, int32_t offset, int origin) {
+    qp_flash_stream_t *s = (qp_flash_stream_t *)stream;
+
+    // Handle as per fseek
+    int32_t position = s->position;
+    switch (origin) {
+        case SEEK_SET:
+            position = offset;
+            break;
+        case SEEK_CUR:
+            position += offset;
+            break;
+        case SEEK_END:
+            position = s->length + offset;
+            break;
+        default:
+            return -1;
+    }
+
+    // Same bounds as memory streams, being at the end is okay but not after it
+    if (position < 0 || position > s->length) {
+        return -1;
+    }
+
+    s->position = position;
+    s->is_eof   = false;
+    return 0;
+}
+
+static inline int32_t flash_tell(qp_stream_t *stream) {
+    qp_flash_stream_t *s = (qp_flash_stream_t *)stream;
+    return s->position;
+}
+
+static inline bool flash_is_eof(qp_stream_t *stream) {
+    qp_flash_stream_t *s = (qp_flash_stream_t *)stream;
+    return s->is_eof;
+}
+
+static inline void flash_close(qp_stream_t *stream) {
+    // No-op, cached blocks are shared with other streams and get replaced as they're needed.
+}
+
+qp_flash_stream_t qp_make_flash_stream(uint32_t address, int32_t length) {
+    // Streams are made when images and fonts are loaded, before anything is read from flash
+    static bool flash_initialised = false;
+    if (!flash_initialised) {
+        flash_init();
+        flash_initialised = true;
+    }
+
+    qp_flash_stream_t stream = {
+        .base     = {.get = flash_get, .put = flash_put, .read = flash_read, .seek = flash_seek, .tell = flash_tell, .is_eof = flash_is_eof, .close = flash_close},
+        .address  = address,
+        .length   = length,
+        .position = 0,
+    };
+    return stream;
+}
+
+#endif // QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // FILE streams
 
@@ -136,6 +363,11 @@ static inline bool file_put(qp_stream_t *stream, uint8_t c) {
     return fputc(c, s->file) == c;
 }
 
+static inline uint32_t file_read(qp_stream_t *stream, void *output_buf, uint32_t length) {
+    qp_file_stream_t *s = (qp_file_stream_t *)stream;
+    return (uint32_t)fread(output_buf, 1, length, s->file);
+}
+
 static inline int file_seek(qp_stream_t *stream, int32_t offset, int origin) {
     qp_file_stream_t *s = (qp_file_stream_t *)stream;
     return fseek(s->file, offset, origin);
@@ -158,7 +390,7 @@ static inline void file_close(qp_stream_t *stream) {
 
 qp_file_stream_t qp_make_file_stream(FILE *f) {
     qp_file_stream_t stream = {
-        .base = {.get = file_get, .put = file_put, .seek = file_seek, .tell = file_tell, .is_eof = file_is_eof, .close = file_close},
+        .base = {.get = file_get, .put = file_put, .read = file_read, .seek = file_seek, .tell = file_tell, .is_eof = file_is_eof, .close = file_close},
         .file = f,
     };
     return stream;
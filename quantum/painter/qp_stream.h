@@ -51,6 +51,7 @@ uint32_t qp_stream_write_impl(const void *input_buf, uint32_t member_size, uint3
 struct qp_stream_t {
     int16_t (*get)(qp_stream_t *stream);
     bool (*put)(qp_stream_t *stream, uint8_t c);
+    uint32_t (*read)(qp_stream_t *stream, void *output_buf, uint32_t length); // optional, bulk alternative to get()
     int (*seek)(qp_stream_t *stream, int32_t offset, int origin);
     int32_t (*tell)(qp_stream_t *stream);
     bool (*is_eof)(qp_stream_t *stream);
@@ -70,6 +71,26 @@ typedef struct qp_memory_stream_t {
 
 qp_memory_stream_t qp_make_memory_stream(void *buffer, int32_t length);
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// External flash streams
+
+#ifdef QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+
+typedef struct qp_flash_stream_t {
+    qp_stream_t base;
+    uint32_t    address;
+    int32_t     length;
+    int32_t     position;
+    bool        is_eof;
+} qp_flash_stream_t;
+
+qp_flash_stream_t qp_make_flash_stream(uint32_t address, int32_t length);
+
+// Drops all cached flash blocks, needed after rewriting any part of the flash which streams have read from
+void qp_flash_stream_invalidate_cache(void);
+
+#endif // QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // FILE streams
 
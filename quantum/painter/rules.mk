@@ -1,6 +1,8 @@
 # Quantum Painter Configurables
 QUANTUM_PAINTER_DRIVERS ?=
 QUANTUM_PAINTER_ANIMATIONS_ENABLE ?= yes
+QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE ?= no
+QUANTUM_PAINTER_COMPOSITOR_ENABLE ?= no
 
 QUANTUM_PAINTER_LVGL_INTEGRATION ?= no
 
@@ -40,6 +42,18 @@ ifeq ($(strip $(QUANTUM_PAINTER_ANIMATIONS_ENABLE)), yes)
     OPT_DEFS += -DQUANTUM_PAINTER_ANIMATIONS_ENABLE
 endif
 
+# Check if people want to load images and fonts from external flash... enable the flash driver if so.
+ifeq ($(strip $(QUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE)), yes)
+    FLASH_DRIVER := spi
+    OPT_DEFS += -DQUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE
+endif
+
+# Check if people want the tile-based layer compositor
+ifeq ($(strip $(QUANTUM_PAINTER_COMPOSITOR_ENABLE)), yes)
+    OPT_DEFS += -DQUANTUM_PAINTER_COMPOSITOR_ENABLE
+    SRC += $(QUANTUM_DIR)/painter/qp_compositor.c
+endif
+
 # Comms flags
 QUANTUM_PAINTER_NEEDS_COMMS_SPI ?= no
 
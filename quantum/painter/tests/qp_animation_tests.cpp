@@ -0,0 +1,214 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "qp.h"
+#include "qp_internal.h"
+#include "timer.h"
+
+void advance_time(uint32_t ms);
+void qp_internal_animation_tick(void);
+}
+
+#include "qp_test_common.h"
+
+static constexpr uint16_t image_size = 16;
+
+struct frame_t {
+    bool     is_delta;
+    uint16_t delay;
+};
+
+class QuantumPainterAnimation : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        // Records which frame was drawn and when, taking a configurable time to do so
+        mock_display_setup(display, 240, 240);
+        display.on_viewport = [this](uint16_t left, uint16_t top, uint16_t right, uint16_t bottom) {
+            bool full = (right - left + 1) == image_size && (bottom - top + 1) == image_size;
+            draws.push_back({timer_read32(), 0, full});
+            frame_started = true;
+            advance_time(draw_ms);
+        };
+        display.on_append_pixels = [this](uint32_t pixel_count, const uint8_t* palette_indices) {
+            // Every pixel of a frame holds its frame number
+            if (frame_started && pixel_count > 0) {
+                draws.back().frame = palette_indices[0];
+                frame_started      = false;
+            }
+        };
+        ASSERT_TRUE(qp_init(&display, QP_ROTATION_0));
+    }
+
+    void TearDown() override {
+        qp_stop_animation(token);
+        if (image) {
+            qp_close_image(image);
+        }
+    }
+
+    // 4bpp grayscale animation laid out as the QGF encoder does, with each frame filled with its frame number. Delta
+    // frames only cover the top left quarter of the image.
+    static std::vector<uint8_t> make_animation(const std::vector<frame_t>& frames) {
+        std::vector<uint8_t> data;
+        push_block_header(data, QGF_GRAPHICS_DESCRIPTOR_TYPEID, sizeof(qgf_graphics_descriptor_v1_t) - sizeof(qgf_block_header_v1_t));
+        data.insert(data.end(), {0x51, 0x47, 0x46, 0x01}); // magic, version
+        push_u32(data, 0);                                 // total size, filled in at the end
+        push_u32(data, 0);
+        push_u16(data, image_size);
+        push_u16(data, image_size);
+        push_u16(data, frames.size());
+
+        push_block_header(data, QGF_FRAME_OFFSET_DESCRIPTOR_TYPEID, frames.size() * sizeof(uint32_t));
+        size_t offsets = data.size();
+        data.resize(data.size() + frames.size() * sizeof(uint32_t));
+
+        for (size_t i = 0; i < frames.size(); ++i) {
+            put_u32(data, offsets + i * sizeof(uint32_t), data.size());
+            push_block_header(data, QGF_FRAME_DESCRIPTOR_TYPEID, sizeof(qgf_frame_v1_t) - sizeof(qgf_block_header_v1_t));
+            data.insert(data.end(), {GRAYSCALE_4BPP, uint8_t(frames[i].is_delta ? QGF_FRAME_FLAG_DELTA : 0), IMAGE_UNCOMPRESSED, 0});
+            push_u16(data, frames[i].delay);
+
+            uint16_t size = image_size;
+            if (frames[i].is_delta) {
+                size = image_size / 2;
+                push_block_header(data, QGF_FRAME_DELTA_DESCRIPTOR_TYPEID, sizeof(qgf_delta_v1_t) - sizeof(qgf_block_header_v1_t));
+                push_u16(data, 0);
+                push_u16(data, 0);
+                push_u16(data, size);
+                push_u16(data, size);
+            }
+
+            uint32_t length = uint32_t(size) * size / 2;
+            push_block_header(data, QGF_FRAME_DATA_DESCRIPTOR_TYPEID, length);
+            data.insert(data.end(), length, uint8_t(i | (i << 4)));
+        }
+
+        put_u32(data, 9, data.size());
+        put_u32(data, 13, ~uint32_t(data.size()));
+        return data;
+    }
+
+    void start(const std::vector<frame_t>& frames, uint32_t draw_ms) {
+        image_data    = make_animation(frames);
+        image         = qp_load_image_mem(image_data.data());
+        this->draw_ms = draw_ms;
+        ASSERT_NE(image, nullptr);
+        token = qp_animate(&display, 0, 0, image);
+        ASSERT_NE(token, INVALID_DEFERRED_TOKEN);
+        start_time = draws.front().time;
+    }
+
+    void run_for(uint32_t ms) {
+        uint32_t until = timer_read32() + ms;
+        while ((int32_t)TIMER_DIFF_32(until, timer_read32()) > 0) {
+            advance_time(1);
+            qp_internal_animation_tick();
+        }
+    }
+
+    // Delta frames only make sense drawn straight after the frame before them
+    void expect_deltas_follow_their_base(const std::vector<frame_t>& frames) {
+        for (size_t i = 1; i < draws.size(); ++i) {
+            const auto& draw = draws[i];
+            EXPECT_EQ(draw.full, !frames[draw.frame].is_delta) << "draw " << i;
+            if (frames[draw.frame].is_delta) {
+                EXPECT_EQ(draws[i - 1].frame, (draw.frame + frames.size() - 1) % frames.size()) << "draw " << i;
+            }
+        }
+    }
+
+    struct draw_t {
+        uint32_t time;
+        uint8_t  frame;
+        bool     full;
+    };
+
+    mock_display_t         display;
+    std::vector<draw_t>    draws;
+    uint32_t               draw_ms       = 0;
+    bool                   frame_started = false;
+    std::vector<uint8_t>   image_data;
+    painter_image_handle_t image         = nullptr;
+    deferred_token         token         = INVALID_DEFERRED_TOKEN;
+    uint32_t               start_time    = 0;
+};
+
+TEST_F(QuantumPainterAnimation, KeepsToSchedule) {
+    std::vector<frame_t> frames(8, frame_t{false, 20});
+    start(frames, 0);
+    run_for(805);
+
+    ASSERT_EQ(draws.size(), 41u);
+    for (size_t i = 0; i < draws.size(); ++i) {
+        EXPECT_EQ(draws[i].time - start_time, i * 20) << "draw " << i;
+        EXPECT_EQ(draws[i].frame, i % frames.size()) << "draw " << i;
+    }
+
+    painter_animation_stats_t stats;
+    ASSERT_TRUE(qp_get_animation_stats(token, &stats));
+    EXPECT_EQ(stats.frames_drawn, 41u);
+    EXPECT_EQ(stats.frames_skipped, 0u);
+}
+
+TEST_F(QuantumPainterAnimation, SlowDisplaySkipsToKeyframes) {
+    // Each frame takes longer to draw than it's shown for
+    std::vector<frame_t> frames = {{false, 10}, {true, 10}, {true, 10}, {true, 10}, {false, 10}, {true, 10}, {true, 10}, {true, 10}};
+    const uint32_t       draw_ms = 25;
+    start(frames, draw_ms);
+    run_for(2000);
+
+    expect_deltas_follow_their_base(frames);
+
+    // Other work still gets a look in between frames
+    for (size_t i = 1; i < draws.size(); ++i) {
+        EXPECT_GE(draws[i].time - draws[i - 1].time, draw_ms + QUANTUM_PAINTER_ANIMATION_MIN_IDLE_MS) << "draw " << i;
+    }
+
+    // Skipping keeps the animation in time, rather than playing ever further behind
+    painter_animation_stats_t stats;
+    ASSERT_TRUE(qp_get_animation_stats(token, &stats));
+    RecordProperty("frames_drawn", std::to_string(stats.frames_drawn));
+    RecordProperty("frames_skipped", std::to_string(stats.frames_skipped));
+    EXPECT_GT(stats.frames_skipped, 0u);
+    EXPECT_NEAR(stats.frames_drawn + stats.frames_skipped, stats.elapsed_ms / 10, frames.size());
+}
+
+TEST_F(QuantumPainterAnimation, OnlySkipsToCompleteFrames) {
+    // Only the first frame is complete, so that's the only one which can be skipped to
+    std::vector<frame_t> frames(6, frame_t{true, 10});
+    frames[0].is_delta = false;
+    start(frames, 15);
+    run_for(1000);
+
+    expect_deltas_follow_their_base(frames);
+    for (size_t i = 1; i < draws.size(); ++i) {
+        if (draws[i].frame != (draws[i - 1].frame + 1) % frames.size()) {
+            EXPECT_EQ(draws[i].frame, 0) << "draw " << i;
+        }
+    }
+}
+
+TEST_F(QuantumPainterAnimation, Stats) {
+    std::vector<frame_t> frames(4, frame_t{false, 20});
+    start(frames, 7);
+    run_for(1000);
+
+    painter_animation_stats_t stats;
+    ASSERT_TRUE(qp_get_animation_stats(token, &stats));
+    EXPECT_EQ(stats.elapsed_ms, 1000u + 7);
+    EXPECT_EQ(stats.frames_drawn, draws.size());
+    EXPECT_EQ(stats.frames_skipped, 0u);
+    EXPECT_NEAR(stats.fps_x100, 5000, 100);
+    EXPECT_EQ(stats.last_frame_ms, 7);
+    EXPECT_EQ(stats.max_frame_ms, 7);
+
+    qp_stop_animation(token);
+    EXPECT_FALSE(qp_get_animation_stats(token, &stats));
+    EXPECT_FALSE(qp_get_animation_stats(INVALID_DEFERRED_TOKEN, &stats));
+}
@@ -0,0 +1,297 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "qp_internal.h"
+#include "qp_comms.h"
+#include "qp_draw.h"
+}
+
+#include "qp_test_common.h"
+
+static constexpr uint16_t surface_width  = 240;
+static constexpr uint16_t surface_height = 240;
+static constexpr uint32_t surface_pixels = uint32_t(surface_width) * surface_height;
+
+enum class DecodePath {
+    bytewise,
+    block,
+};
+
+class QuantumPainterCodec : public ::testing::Test, protected shared_surface_t<surface_width, surface_height> {
+   protected:
+    static void SetUpTestSuite() {
+        make_surface();
+    }
+
+    void SetUp() override {
+        std::fill(framebuffer.begin(), framebuffer.end(), 0);
+        ASSERT_TRUE(qp_init(surface, QP_ROTATION_0));
+
+        // Distinct native color for every palette index
+        for (int i = 0; i < 256; ++i) {
+            qp_internal_global_pixel_lookup_table[i].rgb565 = uint16_t(i * 257 + 1);
+        }
+    }
+
+    // Packs palette indices as the QGF/QFF encoders do, first pixel in the lowest bits
+    static std::vector<uint8_t> pack(const std::vector<uint8_t>& indices, uint8_t bpp) {
+        std::vector<uint8_t> packed((indices.size() * bpp + 7) / 8, 0);
+        for (size_t i = 0; i < indices.size(); ++i) {
+            size_t bit = i * bpp;
+            packed[bit / 8] |= indices[i] << (bit % 8);
+        }
+        return packed;
+    }
+
+    static std::vector<uint8_t> encode(const std::vector<uint8_t>& data, painter_compression_t compression) {
+        switch (compression) {
+            case IMAGE_COMPRESSED_RLE:
+                return rle_encode(data);
+            case IMAGE_COMPRESSED_LZ:
+                return lz_encode(data);
+            default:
+                return data;
+        }
+    }
+
+    // Something icon-like: filled and outlined shapes on a flat background, so rows repeat with small changes
+    static std::vector<uint8_t> make_icon(uint8_t bpp) {
+        std::vector<uint8_t> indices(surface_pixels, 0);
+        uint8_t              mask = (1 << bpp) - 1;
+        for (int shape = 0; shape < 6; ++shape) {
+            int cx = 30 + (shape % 3) * 90, cy = 50 + (shape / 3) * 120, r = 24 + shape * 3;
+            for (int y = 0; y < surface_height; ++y) {
+                for (int x = 0; x < surface_width; ++x) {
+                    int d = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+                    if (d < r * r) {
+                        indices[y * surface_width + x] = (d > (r - 3) * (r - 3)) ? mask : (shape + 1) & mask;
+                    }
+                }
+            }
+        }
+        return indices;
+    }
+
+    // Something image-like: horizontal runs of random length, plus some noise
+    static std::vector<uint8_t> make_indices(uint8_t bpp, uint32_t seed) {
+        std::vector<uint8_t> indices(surface_pixels);
+        uint8_t              mask = (1 << bpp) - 1;
+        uint32_t             run  = 0;
+        uint8_t              val  = 0;
+        for (auto& index : indices) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            if (run == 0) {
+                run = 1 + (seed % 24);
+                val = (seed >> 8) & mask;
+            }
+            --run;
+            index = val;
+        }
+        return indices;
+    }
+
+    bool decode(const std::vector<uint8_t>& data, painter_compression_t compression, uint8_t bpp, DecodePath path) {
+        struct painter_driver_t* driver = (struct painter_driver_t*)surface;
+        qp_memory_stream_t       stream = qp_make_memory_stream((void*)data.data(), data.size());
+
+        struct qp_internal_byte_input_state input_state = {};
+        input_state.device                              = surface;
+        input_state.src_stream                          = &stream.base;
+        qp_internal_byte_input_callback input_callback  = qp_internal_prepare_input_state(&input_state, compression);
+
+        if (!qp_comms_start(surface) || !driver->driver_vtable->viewport(surface, 0, 0, surface_width - 1, surface_height - 1)) {
+            return false;
+        }
+
+        bool ok;
+        if (bpp <= 8) {
+            struct qp_internal_pixel_output_state output_state = {surface, 0, qp_internal_num_pixels_in_buffer(surface)};
+            if (path == DecodePath::bytewise) {
+                ok = qp_internal_decode_palette(surface, surface_pixels, bpp, input_callback, &input_state, qp_internal_global_pixel_lookup_table, qp_internal_pixel_appender, &output_state);
+            } else {
+                ok = qp_internal_decode_palette_block(surface, surface_pixels, bpp, &input_state, qp_internal_global_pixel_lookup_table, &output_state);
+            }
+            if (ok && output_state.pixel_write_pos > 0) {
+                ok = driver->driver_vtable->pixdata(surface, qp_internal_global_pixdata_buffer, output_state.pixel_write_pos);
+            }
+        } else {
+            struct qp_internal_byte_output_state output_state = {surface, 0, qp_internal_num_pixels_in_buffer(surface) * driver->native_bits_per_pixel / 8};
+            uint32_t                             byte_count   = surface_pixels * bpp / 8;
+            if (path == DecodePath::bytewise) {
+                ok = qp_internal_send_bytes(surface, byte_count, input_callback, &input_state, qp_internal_byte_appender, &output_state);
+            } else {
+                ok = qp_internal_send_bytes_block(surface, byte_count, &input_state, &output_state);
+            }
+            if (ok && output_state.byte_write_pos > 0) {
+                ok = driver->driver_vtable->pixdata(surface, qp_internal_global_pixdata_buffer, output_state.byte_write_pos * 8 / driver->native_bits_per_pixel);
+            }
+        }
+
+        qp_comms_stop(surface);
+        return ok;
+    }
+
+    // Best time of several runs in microseconds, to keep the scheduler out of the results
+    template <typename F>
+    static double best_time(F&& work) {
+        double best = 1e12;
+        for (int run = 0; run < 7; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            work();
+            best = std::min(best, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    double benchmark(const std::vector<uint8_t>& data, painter_compression_t compression, uint8_t bpp, DecodePath path) {
+        return best_time([&] { EXPECT_TRUE(decode(data, compression, bpp, path)); });
+    }
+
+    // Time taken by the surface itself to accept the same amount of pixel data, which both decoders pay for
+    double benchmark_surface(void) {
+        struct painter_driver_t* driver = (struct painter_driver_t*)surface;
+        uint32_t                 chunk  = qp_internal_num_pixels_in_buffer(surface);
+        return best_time([&] {
+            qp_comms_start(surface);
+            driver->driver_vtable->viewport(surface, 0, 0, surface_width - 1, surface_height - 1);
+            for (uint32_t p = 0; p < surface_pixels; p += chunk) {
+                driver->driver_vtable->pixdata(surface, qp_internal_global_pixdata_buffer, std::min(chunk, surface_pixels - p));
+            }
+            qp_comms_stop(surface);
+        });
+    }
+
+    // Decode throughput in pixels per microsecond, leaving out the time spent in the surface
+    static double throughput(double elapsed, double surface_elapsed) {
+        return double(surface_pixels) / std::max(elapsed - surface_elapsed, 1.0);
+    }
+};
+
+TEST_F(QuantumPainterCodec, BlockDecodeMatchesBytewise) {
+    for (uint8_t bpp : {1, 2, 4, 8}) {
+        auto packed = pack(make_indices(bpp, 0x1234 + bpp), bpp);
+        for (auto compression : {IMAGE_UNCOMPRESSED, IMAGE_COMPRESSED_RLE, IMAGE_COMPRESSED_LZ}) {
+            auto data = encode(packed, compression);
+
+            ASSERT_TRUE(decode(data, compression, bpp, DecodePath::bytewise));
+            auto expected = framebuffer;
+            std::fill(framebuffer.begin(), framebuffer.end(), 0);
+            ASSERT_TRUE(decode(data, compression, bpp, DecodePath::block));
+            EXPECT_EQ(framebuffer, expected) << "bpp=" << int(bpp) << " compression=" << int(compression);
+        }
+    }
+}
+
+TEST_F(QuantumPainterCodec, BlockSendMatchesBytewise) {
+    // Two bytes per pixel, reuse the run-heavy indices so RLE has something to do
+    std::vector<uint8_t> indices = make_indices(8, 0x5678);
+    std::vector<uint8_t> native;
+    for (uint8_t index : indices) {
+        native.push_back(index);
+        native.push_back(index ^ 0x5A);
+    }
+
+    for (auto compression : {IMAGE_UNCOMPRESSED, IMAGE_COMPRESSED_RLE, IMAGE_COMPRESSED_LZ}) {
+        auto data = encode(native, compression);
+
+        ASSERT_TRUE(decode(data, compression, 16, DecodePath::bytewise));
+        auto expected = framebuffer;
+        std::fill(framebuffer.begin(), framebuffer.end(), 0);
+        ASSERT_TRUE(decode(data, compression, 16, DecodePath::block));
+        EXPECT_EQ(framebuffer, expected) << "compression=" << int(compression);
+    }
+}
+
+TEST_F(QuantumPainterCodec, BlockDecodeFailsOnTruncatedData) {
+    for (auto compression : {IMAGE_COMPRESSED_RLE, IMAGE_COMPRESSED_LZ}) {
+        auto data = encode(pack(make_indices(4, 0x9abc), 4), compression);
+        data.resize(data.size() / 2);
+        EXPECT_FALSE(decode(data, compression, 4, DecodePath::block)) << "compression=" << int(compression);
+    }
+}
+
+TEST_F(QuantumPainterCodec, LzDecodesSameAsRle) {
+    auto packed = pack(make_icon(4), 4);
+    ASSERT_TRUE(decode(rle_encode(packed), IMAGE_COMPRESSED_RLE, 4, DecodePath::block));
+    auto expected = framebuffer;
+    std::fill(framebuffer.begin(), framebuffer.end(), 0);
+    ASSERT_TRUE(decode(lz_encode(packed), IMAGE_COMPRESSED_LZ, 4, DecodePath::block));
+    EXPECT_EQ(framebuffer, expected);
+}
+
+TEST_F(QuantumPainterCodec, LzLongRunsAndMatches) {
+    // Runs and repeats far longer than a token's nibble, or the window, can hold
+    std::vector<uint8_t> native(surface_pixels * 2, 0x3C);
+    for (size_t i = 1000; i < 5000; ++i) {
+        native[i] = uint8_t(i * 2654435761u >> 24);
+    }
+    for (size_t i = 20000; i < 60000; ++i) {
+        native[i] = native[i % 200 + 1000];
+    }
+
+    auto data = lz_encode(native);
+    ASSERT_TRUE(decode(native, IMAGE_UNCOMPRESSED, 16, DecodePath::block));
+    auto expected = framebuffer;
+    for (auto path : {DecodePath::bytewise, DecodePath::block}) {
+        std::fill(framebuffer.begin(), framebuffer.end(), 0);
+        ASSERT_TRUE(decode(data, IMAGE_COMPRESSED_LZ, 16, path));
+        EXPECT_EQ(framebuffer, expected);
+    }
+}
+
+TEST_F(QuantumPainterCodec, LzCompressionRatio) {
+    for (uint8_t bpp : {1, 2, 4}) {
+        auto packed = pack(make_icon(bpp), bpp);
+        auto rle    = rle_encode(packed);
+        auto lz     = lz_encode(packed);
+        RecordProperty("rle_ratio_" + std::to_string(bpp) + "bpp", std::to_string(double(packed.size()) / rle.size()));
+        RecordProperty("lz_ratio_" + std::to_string(bpp) + "bpp", std::to_string(double(packed.size()) / lz.size()));
+        EXPECT_LT(lz.size() * 3, rle.size() * 2) << "bpp=" << int(bpp);
+    }
+}
+
+TEST_F(QuantumPainterCodec, BlockDecodeThroughput) {
+    auto packed = pack(make_indices(4, 0xdef0), 4);
+    auto rle    = rle_encode(packed);
+
+    double surface_time = benchmark_surface();
+    double bytewise_raw = throughput(benchmark(packed, IMAGE_UNCOMPRESSED, 4, DecodePath::bytewise), surface_time);
+    double block_raw    = throughput(benchmark(packed, IMAGE_UNCOMPRESSED, 4, DecodePath::block), surface_time);
+    double bytewise_rle = throughput(benchmark(rle, IMAGE_COMPRESSED_RLE, 4, DecodePath::bytewise), surface_time);
+    double block_rle    = throughput(benchmark(rle, IMAGE_COMPRESSED_RLE, 4, DecodePath::block), surface_time);
+
+    RecordProperty("bytewise_pixels_per_us", std::to_string(bytewise_raw));
+    RecordProperty("block_pixels_per_us", std::to_string(block_raw));
+    RecordProperty("bytewise_rle_pixels_per_us", std::to_string(bytewise_rle));
+    RecordProperty("block_rle_pixels_per_us", std::to_string(block_rle));
+
+    EXPECT_GT(block_raw, bytewise_raw * 1.5);
+    EXPECT_GT(block_rle, bytewise_rle * 1.5);
+}
+
+TEST_F(QuantumPainterCodec, LzDecodeThroughput) {
+    auto packed = pack(make_icon(4), 4);
+    auto rle    = rle_encode(packed);
+    auto lz     = lz_encode(packed);
+
+    double surface_time = benchmark_surface();
+    double block_rle    = throughput(benchmark(rle, IMAGE_COMPRESSED_RLE, 4, DecodePath::block), surface_time);
+    double block_lz     = throughput(benchmark(lz, IMAGE_COMPRESSED_LZ, 4, DecodePath::block), surface_time);
+
+    RecordProperty("block_rle_pixels_per_us", std::to_string(block_rle));
+    RecordProperty("block_lz_pixels_per_us", std::to_string(block_lz));
+    RecordProperty("rle_bytes_per_kpixel", std::to_string(rle.size() * 1000.0 / surface_pixels));
+    RecordProperty("lz_bytes_per_kpixel", std::to_string(lz.size() * 1000.0 / surface_pixels));
+
+    // Each byte of LZ data goes further than a byte of RLE, which is what counts when it's coming from flash
+    EXPECT_GT(block_lz * rle.size(), block_rle * lz.size());
+}
@@ -0,0 +1,302 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "qp.h"
+#include "qp_internal.h"
+}
+
+#include "qp_test_common.h"
+
+static constexpr uint16_t display_width  = 60;
+static constexpr uint16_t display_height = 40;
+static constexpr uint16_t image_width    = 20;
+static constexpr uint16_t image_height   = 16;
+static constexpr uint8_t  glyph_width    = 6;
+static constexpr uint8_t  glyph_height   = 8;
+
+struct hsv_t {
+    uint8_t h, s, v;
+};
+
+static constexpr hsv_t background = {10, 20, 30};
+static constexpr hsv_t panel      = {100, 200, 150};
+static constexpr hsv_t image_fg   = {40, 255, 255};
+static constexpr hsv_t image_bg   = {200, 80, 0};
+static constexpr hsv_t text_fg    = {0, 0, 255};
+static constexpr hsv_t text_bg    = {170, 255, 60};
+
+class QuantumPainterCompositor : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        for (auto* display : {&composited, &direct}) {
+            mock_display_setup(*display, display_width, display_height);
+            ASSERT_TRUE(qp_init(display, QP_ROTATION_0));
+        }
+
+        image_data = make_image();
+        image      = qp_load_image_mem(image_data.data());
+        ASSERT_NE(image, nullptr);
+        font_data = make_font(glyph_width, glyph_height);
+        font      = qp_load_font_mem(font_data.data());
+        ASSERT_NE(font, nullptr);
+
+        compositor = qp_compositor_make(&composited, background.h, background.s, background.v);
+        ASSERT_NE(compositor, nullptr);
+    }
+
+    void TearDown() override {
+        qp_compositor_close(compositor);
+        qp_close_image(image);
+        qp_close_font(font);
+    }
+
+    // 4bpp grayscale image laid out as the QGF encoder does, with diagonal stripes which include the background color.
+    // Pixels are packed continuously, so rows of an odd width don't start on a byte boundary.
+    static std::vector<uint8_t> make_image(uint16_t width = image_width, uint16_t height = image_height, painter_compression_t compression = IMAGE_UNCOMPRESSED) {
+        std::vector<uint8_t> pixels((uint32_t(width) * height + 1) / 2);
+        for (uint32_t i = 0; i < uint32_t(width) * height; ++i) {
+            uint16_t x = i % width, y = i / width;
+            pixels[i / 2] |= (((x + y) / 2) % 8 * 2) << ((i % 2) * 4);
+        }
+        if (compression == IMAGE_COMPRESSED_LZ) {
+            pixels = lz_encode(pixels);
+        }
+
+        const uint32_t       length     = pixels.size();
+        const uint32_t       total_size = sizeof(qgf_graphics_descriptor_v1_t) + sizeof(qgf_block_header_v1_t) + sizeof(uint32_t) + sizeof(qgf_frame_v1_t) + sizeof(qgf_block_header_v1_t) + length;
+        std::vector<uint8_t> data;
+
+        push_block_header(data, QGF_GRAPHICS_DESCRIPTOR_TYPEID, sizeof(qgf_graphics_descriptor_v1_t) - sizeof(qgf_block_header_v1_t));
+        data.insert(data.end(), {0x51, 0x47, 0x46, 0x01}); // magic, version
+        push_u32(data, total_size);
+        push_u32(data, ~total_size);
+        push_u16(data, width);
+        push_u16(data, height);
+        push_u16(data, 1);
+
+        push_block_header(data, QGF_FRAME_OFFSET_DESCRIPTOR_TYPEID, sizeof(uint32_t));
+        push_u32(data, data.size() + sizeof(uint32_t));
+
+        push_block_header(data, QGF_FRAME_DESCRIPTOR_TYPEID, sizeof(qgf_frame_v1_t) - sizeof(qgf_block_header_v1_t));
+        data.insert(data.end(), {GRAYSCALE_4BPP, 0, uint8_t(compression), 0});
+        push_u16(data, 0);
+
+        push_block_header(data, QGF_FRAME_DATA_DESCRIPTOR_TYPEID, length);
+        data.insert(data.end(), pixels.begin(), pixels.end());
+        return data;
+    }
+
+    static uint16_t native(hsv_t color) {
+        qp_pixel_t pixel = {.hsv888 = {color.h, color.s, color.v}};
+        mock_palette_convert(nullptr, 1, &pixel);
+        return pixel.rgb565;
+    }
+
+    // A status screen: a panel, an icon overlapping it and a line of text spanning two rows of tiles
+    void add_scene() {
+        panel_layer = qp_compositor_add_rect(compositor, 5, 5, 40, 30, panel.h, panel.s, panel.v);
+        image_layer = qp_compositor_add_image_recolor(compositor, image_x, image_y, image, image_fg.h, image_fg.s, image_fg.v, image_bg.h, image_bg.s, image_bg.v);
+        text_layer  = qp_compositor_add_text_recolor(compositor, 2, 28, font, text, text_fg.h, text_fg.s, text_fg.v, text_bg.h, text_bg.s, text_bg.v);
+        ASSERT_NE(panel_layer, INVALID_PAINTER_LAYER);
+        ASSERT_NE(image_layer, INVALID_PAINTER_LAYER);
+        ASSERT_NE(text_layer, INVALID_PAINTER_LAYER);
+    }
+
+    // The same scene drawn straight to the display, one layer over the other
+    void draw_scene_directly(bool with_image = true) {
+        ASSERT_TRUE(qp_rect(&direct, 0, 0, display_width - 1, display_height - 1, background.h, background.s, background.v, true));
+        ASSERT_TRUE(qp_rect(&direct, 5, 5, 40, 30, panel.h, panel.s, panel.v, true));
+        if (with_image) {
+            ASSERT_TRUE(qp_drawimage_recolor(&direct, image_x, image_y, image, image_fg.h, image_fg.s, image_fg.v, image_bg.h, image_bg.s, image_bg.v));
+        }
+        ASSERT_GT(qp_drawtext_recolor(&direct, 2, 28, font, text, text_fg.h, text_fg.s, text_fg.v, text_bg.h, text_bg.s, text_bg.v), 0);
+    }
+
+    mock_display_t         composited;
+    mock_display_t         direct;
+    painter_compositor_t   compositor = nullptr;
+    std::vector<uint8_t>   image_data;
+    painter_image_handle_t image = nullptr;
+    std::vector<uint8_t>   font_data;
+    painter_font_handle_t  font = nullptr;
+
+    uint16_t        image_x     = 30;
+    uint16_t        image_y     = 20;
+    const char*     text        = "Base 12";
+    painter_layer_t panel_layer = INVALID_PAINTER_LAYER;
+    painter_layer_t image_layer = INVALID_PAINTER_LAYER;
+    painter_layer_t text_layer  = INVALID_PAINTER_LAYER;
+};
+
+TEST_F(QuantumPainterCompositor, MatchesDirectDrawing) {
+    add_scene();
+    ASSERT_TRUE(qp_compositor_render(compositor));
+    draw_scene_directly();
+    EXPECT_EQ(composited.framebuffer, direct.framebuffer);
+
+    // Every tile is sent once, including the partial ones along the right and bottom edges
+    EXPECT_EQ(composited.viewports, 4u * 3);
+    EXPECT_EQ(composited.pixels, uint32_t(display_width) * display_height);
+}
+
+TEST_F(QuantumPainterCompositor, NothingChangedSendsNothing) {
+    add_scene();
+    ASSERT_TRUE(qp_compositor_render(compositor));
+    composited.reset_counters();
+    ASSERT_TRUE(qp_compositor_render(compositor));
+    EXPECT_EQ(composited.viewports, 0u);
+
+    // Moving to the same place isn't a change either
+    ASSERT_TRUE(qp_compositor_move(compositor, image_layer, image_x, image_y));
+    ASSERT_TRUE(qp_compositor_render(compositor));
+    EXPECT_EQ(composited.viewports, 0u);
+}
+
+TEST_F(QuantumPainterCompositor, OnlyChangedTilesAreSent) {
+    add_scene();
+    ASSERT_TRUE(qp_compositor_render(compositor));
+    composited.reset_counters();
+
+    // Covers tile columns 1-3 on rows 1-2 before the move, and 2-3 after it
+    image_x = 34;
+    ASSERT_TRUE(qp_compositor_move(compositor, image_layer, image_x, image_y));
+    ASSERT_TRUE(qp_compositor_render(compositor));
+    draw_scene_directly();
+    EXPECT_EQ(composited.framebuffer, direct.framebuffer);
+    EXPECT_EQ(composited.viewports, 6u);
+
+    RecordProperty("pixels_sent", std::to_string(composited.pixels));
+    EXPECT_LT(composited.pixels, uint32_t(display_width) * display_height / 2);
+}
+
+TEST_F(QuantumPainterCompositor, ChangedTextRedrawsWhatItCovered) {
+    add_scene();
+    ASSERT_TRUE(qp_compositor_render(compositor));
+
+    // The old string was wider, so the panel and background need to reappear from behind it
+    text = "B";
+    ASSERT_TRUE(qp_compositor_set_text(compositor, text_layer, text));
+    ASSERT_TRUE(qp_compositor_render(compositor));
+    draw_scene_directly();
+    EXPECT_EQ(composited.framebuffer, direct.framebuffer);
+}
+
+TEST_F(QuantumPainterCompositor, HiddenLayersAreNotDrawn) {
+    add_scene();
+    ASSERT_TRUE(qp_compositor_render(compositor));
+
+    ASSERT_TRUE(qp_compositor_set_visible(compositor, image_layer, false));
+    ASSERT_TRUE(qp_compositor_render(compositor));
+    draw_scene_directly(false);
+    EXPECT_EQ(composited.framebuffer, direct.framebuffer);
+
+    ASSERT_TRUE(qp_compositor_set_visible(compositor, image_layer, true));
+    ASSERT_TRUE(qp_compositor_render(compositor));
+    draw_scene_directly(true);
+    EXPECT_EQ(composited.framebuffer, direct.framebuffer);
+}
+
+TEST_F(QuantumPainterCompositor, ColorKeyShowsLayersUnderneath) {
+    add_scene();
+    ASSERT_TRUE(qp_compositor_set_color_key(compositor, image_layer, true, image_bg.h, image_bg.s, image_bg.v));
+    ASSERT_FALSE(qp_compositor_set_color_key(compositor, panel_layer, true, 0, 0, 0));
+    ASSERT_TRUE(qp_compositor_render(compositor));
+    draw_scene_directly(false);
+    auto underneath = direct.framebuffer;
+    draw_scene_directly(true);
+
+    // Within the image, background pixels show what was there before it, everything else is the image
+    uint32_t see_through = 0;
+    for (uint16_t y = image_y; y < image_y + image_height; ++y) {
+        for (uint16_t x = image_x; x < image_x + image_width; ++x) {
+            uint32_t i = y * display_width + x;
+            if (y >= 28 && y < 28 + glyph_height && x < 2 + qp_textwidth(font, text)) {
+                continue; // under the text
+            }
+            if (direct.framebuffer[i] == native(image_bg)) {
+                EXPECT_EQ(composited.framebuffer[i], underneath[i]) << x << "," << y;
+                see_through++;
+            } else {
+                EXPECT_EQ(composited.framebuffer[i], direct.framebuffer[i]) << x << "," << y;
+            }
+        }
+    }
+    EXPECT_GT(see_through, 0u);
+}
+
+TEST_F(QuantumPainterCompositor, BackgroundImagesAreNotDecodedPerTile) {
+    // Taller than a tile, with rows which don't start on a byte boundary, and tile rows starting part way down
+    const uint16_t width = display_width - 1, height = display_height - 3, y = 3;
+    const uint32_t tiles_x = 4, tiles_y = 3;
+
+    for (auto compression : {IMAGE_UNCOMPRESSED, IMAGE_COMPRESSED_LZ}) {
+        SCOPED_TRACE(compression);
+        ASSERT_TRUE(qp_compositor_clear(compositor));
+        ASSERT_TRUE(qp_compositor_render(compositor));
+
+        auto                   data     = make_image(width, height, compression);
+        painter_image_handle_t backdrop = qp_load_image_mem(data.data());
+        ASSERT_NE(backdrop, nullptr);
+        ASSERT_NE(qp_compositor_add_image_recolor(compositor, 0, y, backdrop, image_fg.h, image_fg.s, image_fg.v, image_bg.h, image_bg.s, image_bg.v), INVALID_PAINTER_LAYER);
+        composited.reset_counters();
+        ASSERT_TRUE(qp_compositor_render(compositor));
+
+        // Each column of tiles decodes the image once, plus a row backed up to for each row of tiles
+        RecordProperty("decoded_pixels", std::to_string(composited.decoded));
+        EXPECT_LE(composited.decoded, tiles_x * (height + tiles_y) * width + tiles_x * tiles_y);
+
+        ASSERT_TRUE(qp_rect(&direct, 0, 0, display_width - 1, display_height - 1, background.h, background.s, background.v, true));
+        ASSERT_TRUE(qp_drawimage_recolor(&direct, 0, y, backdrop, image_fg.h, image_fg.s, image_fg.v, image_bg.h, image_bg.s, image_bg.v));
+        EXPECT_EQ(composited.framebuffer, direct.framebuffer);
+
+        // Redrawing the bottom right tile only decodes the rows within it
+        ASSERT_NE(qp_compositor_add_rect(compositor, 50, 35, 52, 37, panel.h, panel.s, panel.v), INVALID_PAINTER_LAYER);
+        composited.reset_counters();
+        ASSERT_TRUE(qp_compositor_render(compositor));
+        EXPECT_EQ(composited.viewports, 1u);
+        EXPECT_LE(composited.decoded, (display_height - 32 + 1) * uint32_t(width) + 2);
+
+        ASSERT_TRUE(qp_rect(&direct, 50, 35, 52, 37, panel.h, panel.s, panel.v, true));
+        EXPECT_EQ(composited.framebuffer, direct.framebuffer);
+        qp_close_image(backdrop);
+    }
+}
+
+TEST_F(QuantumPainterCompositor, ClearLeavesTheBackground) {
+    add_scene();
+    ASSERT_TRUE(qp_compositor_render(compositor));
+    ASSERT_TRUE(qp_compositor_clear(compositor));
+    ASSERT_TRUE(qp_compositor_render(compositor));
+
+    std::vector<uint16_t> expected(composited.framebuffer.size(), native(background));
+    EXPECT_EQ(composited.framebuffer, expected);
+    EXPECT_FALSE(qp_compositor_move(compositor, image_layer, 0, 0));
+}
+
+TEST_F(QuantumPainterCompositor, Limits) {
+    for (int i = 0; i < QUANTUM_PAINTER_COMPOSITOR_MAX_LAYERS; ++i) {
+        ASSERT_EQ(qp_compositor_add_rect(compositor, i, i, i, i, 0, 0, 255), i);
+    }
+    EXPECT_EQ(qp_compositor_add_rect(compositor, 0, 0, 1, 1, 0, 0, 255), INVALID_PAINTER_LAYER);
+    EXPECT_FALSE(qp_compositor_set_text(compositor, 0, "not text"));
+    EXPECT_FALSE(qp_compositor_set_visible(compositor, QUANTUM_PAINTER_COMPOSITOR_MAX_LAYERS, false));
+
+    // Compositors in use aren't handed out again
+    EXPECT_EQ(qp_compositor_make(&direct, 0, 0, 0), nullptr);
+
+    // Tiles hold whole bytes per pixel
+    direct.base.native_bits_per_pixel = 4;
+    ASSERT_TRUE(qp_compositor_close(compositor));
+    EXPECT_EQ(qp_compositor_make(&direct, 0, 0, 0), nullptr);
+    EXPECT_FALSE(qp_compositor_render(compositor));
+
+    compositor = qp_compositor_make(&composited, 0, 0, 0);
+    EXPECT_NE(compositor, nullptr);
+}
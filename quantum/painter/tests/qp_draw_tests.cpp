@@ -0,0 +1,226 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "qp.h"
+#include "qp_internal.h"
+}
+
+#include "qp_test_common.h"
+
+static constexpr uint16_t display_width  = 240;
+static constexpr uint16_t display_height = 240;
+
+// What the per-point rasterizers used to send: one viewport per pixel or per line
+struct reference_t {
+    std::vector<uint8_t> writes = std::vector<uint8_t>(uint32_t(display_width) * display_height, 0);
+    uint32_t             viewports   = 0;
+    uint32_t             pixel_bytes = 0;
+
+    void rect(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+        for (int16_t y = std::min(y0, y1); y <= std::max(y0, y1); ++y) {
+            for (int16_t x = std::min(x0, x1); x <= std::max(x0, x1); ++x) {
+                writes[y * display_width + x]++;
+                pixel_bytes += sizeof(uint16_t);
+            }
+        }
+        viewports++;
+    }
+
+    void pixel(int16_t x, int16_t y) {
+        rect(x, y, x, y);
+    }
+};
+
+static reference_t reference_circle(int16_t cx, int16_t cy, int16_t radius, bool filled) {
+    reference_t ref;
+    auto        plot = [&](int16_t ox, int16_t oy) {
+        if (ox == 0) {
+            ref.pixel(cx, cy + oy);
+            ref.pixel(cx, cy - oy);
+            if (filled) {
+                ref.rect(cx + oy, cy, cx - oy, cy);
+            } else {
+                ref.pixel(cx + oy, cy);
+                ref.pixel(cx - oy, cy);
+            }
+        } else if (ox == oy) {
+            if (filled) {
+                ref.rect(cx + oy, cy + oy, cx - oy, cy + oy);
+                ref.rect(cx + oy, cy - oy, cx - oy, cy - oy);
+            } else {
+                for (int16_t sx : {1, -1}) {
+                    for (int16_t sy : {1, -1}) {
+                        ref.pixel(cx + sx * oy, cy + sy * oy);
+                    }
+                }
+            }
+        } else if (filled) {
+            ref.rect(cx + ox, cy + oy, cx - ox, cy + oy);
+            ref.rect(cx + ox, cy - oy, cx - ox, cy - oy);
+            ref.rect(cx + oy, cy + ox, cx - oy, cy + ox);
+            ref.rect(cx + oy, cy - ox, cx - oy, cy - ox);
+        } else {
+            for (int16_t sx : {1, -1}) {
+                for (int16_t sy : {1, -1}) {
+                    ref.pixel(cx + sx * ox, cy + sy * oy);
+                    ref.pixel(cx + sx * oy, cy + sy * ox);
+                }
+            }
+        }
+    };
+
+    int16_t xcalc = 0;
+    int16_t ycalc = radius;
+    int16_t err   = ((5 - (radius >> 2)) >> 2);
+    plot(xcalc, ycalc);
+    while (xcalc < ycalc) {
+        xcalc++;
+        if (err < 0) {
+            err += (xcalc << 1) + 1;
+        } else {
+            ycalc--;
+            err += ((xcalc - ycalc) << 1) + 1;
+        }
+        plot(xcalc, ycalc);
+    }
+    return ref;
+}
+
+static reference_t reference_ellipse(int16_t cx, int16_t cy, int16_t sizex, int16_t sizey, bool filled) {
+    reference_t ref;
+    auto        plot = [&](int16_t ox, int16_t oy) {
+        if (ox == 0) {
+            ref.pixel(cx, cy + oy);
+            ref.pixel(cx, cy - oy);
+        } else if (filled) {
+            ref.rect(cx + ox, cy + oy, cx - ox, cy + oy);
+            if (oy > 0) {
+                ref.rect(cx + ox, cy - oy, cx - ox, cy - oy);
+            }
+        } else {
+            ref.pixel(cx + ox, cy + oy);
+            ref.pixel(cx + ox, cy - oy);
+            ref.pixel(cx - ox, cy + oy);
+            ref.pixel(cx - ox, cy - oy);
+        }
+    };
+
+    int16_t aa = sizex * sizex;
+    int16_t bb = sizey * sizey;
+    int16_t fa = 4 * aa;
+    int16_t fb = 4 * bb;
+
+    int16_t dx = 0;
+    int16_t dy = sizey;
+    for (int16_t delta = (2 * bb) + (aa * (1 - (2 * sizey))); bb * dx <= aa * dy; dx++) {
+        plot(dx, dy);
+        if (delta >= 0) {
+            delta += fa * (1 - dy);
+            dy--;
+        }
+        delta += bb * (4 * dx + 6);
+    }
+
+    dx = sizex;
+    dy = 0;
+    for (int16_t delta = (2 * aa) + (bb * (1 - (2 * sizex))); aa * dy <= bb * dx; dy++) {
+        plot(dx, dy);
+        if (delta >= 0) {
+            delta += fb * (1 - dx);
+            dx--;
+        }
+        delta += aa * (4 * dy + 6);
+    }
+    return ref;
+}
+
+class QuantumPainterDraw : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        mock_display_setup(display, display_width, display_height);
+        ASSERT_TRUE(qp_init(&display, QP_ROTATION_0));
+        display.reset_counters();
+    }
+
+    // Same pixels as before, none of them written more often than they were
+    void expect_same_pixels(const reference_t& ref, const std::string& what) {
+        for (uint32_t i = 0; i < display.writes.size(); ++i) {
+            ASSERT_EQ(display.writes[i] > 0, ref.writes[i] > 0) << what << " at " << i % display_width << "," << i / display_width;
+            ASSERT_LE(display.writes[i], ref.writes[i]) << what << " at " << i % display_width << "," << i / display_width;
+        }
+    }
+
+    mock_display_t display;
+};
+
+TEST_F(QuantumPainterDraw, CirclesMatchPerPointRasterizer) {
+    for (bool filled : {false, true}) {
+        for (uint16_t radius : {0, 1, 2, 3, 4, 5, 7, 10, 16, 31, 50, 64, 100, 119}) {
+            display.reset_counters();
+            ASSERT_TRUE(qp_circle(&display, 120, 120, radius, 0, 0, 255, filled));
+            auto ref = reference_circle(120, 120, radius, filled);
+            expect_same_pixels(ref, "radius " + std::to_string(radius) + (filled ? " filled" : ""));
+            EXPECT_LE(display.viewports, ref.viewports);
+            EXPECT_LE(display.pixel_bytes(), ref.pixel_bytes);
+        }
+    }
+}
+
+TEST_F(QuantumPainterDraw, EllipsesMatchPerPointRasterizer) {
+    for (bool filled : {false, true}) {
+        for (auto size : std::vector<std::pair<uint16_t, uint16_t>>{{1, 1}, {3, 1}, {1, 3}, {5, 2}, {10, 10}, {20, 8}, {8, 20}, {40, 30}, {60, 15}, {15, 60}}) {
+            display.reset_counters();
+            ASSERT_TRUE(qp_ellipse(&display, 120, 120, size.first, size.second, 0, 0, 255, filled));
+            auto ref = reference_ellipse(120, 120, size.first, size.second, filled);
+            expect_same_pixels(ref, "size " + std::to_string(size.first) + "x" + std::to_string(size.second) + (filled ? " filled" : ""));
+            EXPECT_LE(display.viewports, ref.viewports);
+            EXPECT_LE(display.pixel_bytes(), ref.pixel_bytes);
+        }
+    }
+}
+
+TEST_F(QuantumPainterDraw, FilledCircleTraffic) {
+    ASSERT_TRUE(qp_circle(&display, 120, 120, 100, 0, 0, 255, true));
+    auto ref = reference_circle(120, 120, 100, true);
+
+    RecordProperty("per_point_viewports", std::to_string(ref.viewports));
+    RecordProperty("span_batch_viewports", std::to_string(display.viewports));
+    RecordProperty("per_point_traffic_bytes", std::to_string(ref.viewports * mock_viewport_bytes + ref.pixel_bytes));
+    RecordProperty("span_batch_traffic_bytes", std::to_string(display.traffic()));
+    EXPECT_LT(display.viewports * 2, ref.viewports);
+    EXPECT_LT(display.traffic(), ref.viewports * mock_viewport_bytes + ref.pixel_bytes);
+}
+
+TEST_F(QuantumPainterDraw, OutlineCircleTraffic) {
+    ASSERT_TRUE(qp_circle(&display, 120, 120, 100, 0, 0, 255, false));
+    auto ref = reference_circle(120, 120, 100, false);
+
+    RecordProperty("per_point_viewports", std::to_string(ref.viewports));
+    RecordProperty("span_batch_viewports", std::to_string(display.viewports));
+    EXPECT_LT(display.viewports * 2, ref.viewports);
+}
+
+TEST_F(QuantumPainterDraw, FilledEllipseTraffic) {
+    ASSERT_TRUE(qp_ellipse(&display, 120, 120, 100, 40, 0, 0, 255, true));
+    auto ref = reference_ellipse(120, 120, 100, 40, true);
+
+    RecordProperty("per_point_viewports", std::to_string(ref.viewports));
+    RecordProperty("span_batch_viewports", std::to_string(display.viewports));
+    RecordProperty("per_point_traffic_bytes", std::to_string(ref.viewports * mock_viewport_bytes + ref.pixel_bytes));
+    RecordProperty("span_batch_traffic_bytes", std::to_string(display.traffic()));
+    EXPECT_LT(display.viewports * 3, ref.viewports * 2);
+    EXPECT_LT(display.traffic(), ref.viewports * mock_viewport_bytes + ref.pixel_bytes);
+}
+
+TEST_F(QuantumPainterDraw, FilledRectIsOneViewport) {
+    ASSERT_TRUE(qp_rect(&display, 20, 30, 219, 209, 0, 0, 255, true));
+    EXPECT_EQ(display.viewports, 1u);
+    EXPECT_EQ(display.pixel_bytes(), 200u * 180 * sizeof(uint16_t));
+}
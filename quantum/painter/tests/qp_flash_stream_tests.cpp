@@ -0,0 +1,264 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "qp.h"
+#include "qp_internal.h"
+#include "qp_stream.h"
+#include "qp_comms.h"
+#include "flash_spi.h"
+}
+
+#include "qp_test_common.h"
+
+static constexpr uint32_t flash_size      = 64 * 1024;
+static constexpr uint32_t block_size      = QUANTUM_PAINTER_FLASH_STREAM_BLOCK_SIZE;
+static constexpr uint16_t surface_width   = 120;
+static constexpr uint16_t surface_height  = 20;
+static constexpr uint8_t  glyph_width     = 6;
+static constexpr uint8_t  glyph_height    = 8;
+static constexpr uint32_t font_flash_addr = 0x1234;
+
+// External flash, as seen through the flash driver
+static std::vector<uint8_t> flash_contents;
+static uint32_t             flash_transactions;
+static uint32_t             flash_bytes;
+static bool                 flash_fails;
+static bool                 flash_initialised;
+
+// Display whose chip select is held on the SPI bus shared with the flash, as with spi_start(), only one can be at once
+static painter_device_t bus_selected;
+static uint32_t         bus_conflicts;
+
+extern "C" void flash_init(void) {
+    flash_initialised = true;
+}
+
+extern "C" flash_status_t flash_read_block(uint32_t addr, void* buf, size_t len) {
+    if (bus_selected) {
+        bus_conflicts++;
+        return FLASH_STATUS_ERROR;
+    }
+    if (flash_fails || addr + len > flash_contents.size()) {
+        return FLASH_STATUS_ERROR;
+    }
+    memcpy(buf, &flash_contents[addr], len);
+    flash_transactions++;
+    flash_bytes += len;
+    return FLASH_STATUS_SUCCESS;
+}
+
+class QuantumPainterFlashStream : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        flash_contents.assign(flash_size, 0xFF);
+        uint32_t seed = 0x1234567;
+        for (auto& byte : flash_contents) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            byte = seed & 0xFF;
+        }
+        flash_fails = false;
+        qp_flash_stream_invalidate_cache();
+        reset_counters();
+    }
+
+    void reset_counters() {
+        flash_transactions = 0;
+        flash_bytes        = 0;
+    }
+};
+
+TEST_F(QuantumPainterFlashStream, MatchesMemoryStream) {
+    const uint32_t     address = 1000;
+    const int32_t      length  = 4000;
+    qp_flash_stream_t  flash   = qp_make_flash_stream(address, length);
+    qp_memory_stream_t mem     = qp_make_memory_stream(&flash_contents[address], length);
+
+    // Random mix of seeks, single bytes and bulk reads of all sizes, including past the end
+    uint32_t seed = 42;
+    for (int op = 0; op < 2000; ++op) {
+        seed      = seed * 1103515245 + 12345;
+        int32_t n = (seed >> 8) % 300;
+        switch ((seed >> 20) % 3) {
+            case 0:
+                ASSERT_EQ(qp_stream_seek(&flash, n * 13 - 50, SEEK_SET), qp_stream_seek(&mem, n * 13 - 50, SEEK_SET));
+                break;
+            case 1:
+                for (int32_t i = 0; i < n % 40; ++i) {
+                    ASSERT_EQ(qp_stream_get(&flash), qp_stream_get(&mem)) << "op " << op;
+                }
+                break;
+            case 2: {
+                std::vector<uint8_t> a(n), b(n);
+                ASSERT_EQ(qp_stream_read(a.data(), 1, n, &flash), qp_stream_read(b.data(), 1, n, &mem)) << "op " << op;
+                ASSERT_EQ(a, b) << "op " << op;
+                break;
+            }
+        }
+        ASSERT_EQ(qp_stream_tell(&flash), qp_stream_tell(&mem));
+        ASSERT_EQ(qp_stream_eof(&flash), qp_stream_eof(&mem));
+    }
+    EXPECT_FALSE(qp_stream_put(&flash, 0));
+}
+
+TEST_F(QuantumPainterFlashStream, SequentialBytesReadEachBlockOnce) {
+    qp_flash_stream_t flash = qp_make_flash_stream(block_size * 4, 1024);
+    for (int i = 0; i < 1024; ++i) {
+        ASSERT_EQ(qp_stream_get(&flash), flash_contents[block_size * 4 + i]);
+    }
+    EXPECT_EQ(qp_stream_get(&flash), STREAM_EOF);
+    EXPECT_EQ(flash_transactions, 1024 / block_size);
+    EXPECT_EQ(flash_bytes, 1024u);
+}
+
+TEST_F(QuantumPainterFlashStream, RepeatedAccessIsCached) {
+    qp_flash_stream_t flash = qp_make_flash_stream(100, 200);
+    for (int pass = 0; pass < 10; ++pass) {
+        ASSERT_EQ(qp_stream_setpos(&flash, 0), 0);
+        for (int i = 0; i < 200; ++i) {
+            ASSERT_EQ(qp_stream_get(&flash), flash_contents[100 + i]);
+        }
+    }
+
+    // Spans four blocks, which all fit in the cache, so only the first pass reads from flash
+    RecordProperty("flash_transactions", std::to_string(flash_transactions));
+    EXPECT_EQ(flash_transactions, 4u);
+}
+
+TEST_F(QuantumPainterFlashStream, BulkReadsGoStraightToFlash) {
+    // Unaligned at both ends, so a partial block either side of one long transaction
+    const uint32_t       address = block_size * 3 + 5;
+    const uint32_t       length  = block_size * 40;
+    qp_flash_stream_t    flash   = qp_make_flash_stream(address, length);
+    std::vector<uint8_t> data(length);
+    ASSERT_EQ(qp_stream_read(data.data(), 1, length, &flash), length);
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), flash_contents.begin() + address));
+    EXPECT_EQ(flash_transactions, 3u);
+}
+
+TEST_F(QuantumPainterFlashStream, ReadErrorsEndTheStream) {
+    qp_flash_stream_t flash = qp_make_flash_stream(0, 1024);
+    flash_fails             = true;
+    uint8_t buf[256];
+    EXPECT_EQ(qp_stream_get(&flash), STREAM_EOF);
+    EXPECT_EQ(qp_stream_read(buf, 1, sizeof(buf), &flash), 0u);
+
+    // Nothing from the failed reads was left behind in the cache
+    flash_fails = false;
+    EXPECT_EQ(qp_stream_get(&flash), flash_contents[0]);
+}
+
+// Wraps a surface's comms so that it behaves like a display on the same SPI bus as the flash
+static const struct painter_comms_vtable_t*  surface_comms;
+static const struct painter_driver_vtable_t* surface_driver;
+static uint32_t                              pixdata_unselected;
+
+static bool bus_comms_start(painter_device_t device) {
+    if (bus_selected) {
+        bus_conflicts++;
+        return false;
+    }
+    bus_selected = device;
+    return surface_comms->comms_start(device);
+}
+
+static void bus_comms_stop(painter_device_t device) {
+    surface_comms->comms_stop(device);
+    bus_selected = nullptr;
+}
+
+static bool bus_pixdata(painter_device_t device, const void* pixel_data, uint32_t native_pixel_count) {
+    if (bus_selected != device) {
+        pixdata_unselected++;
+    }
+    return surface_driver->pixdata(device, pixel_data, native_pixel_count);
+}
+
+class QuantumPainterFlashFont : public QuantumPainterFlashStream, protected shared_surface_t<surface_width, surface_height> {
+   protected:
+    static void SetUpTestSuite() {
+        make_surface();
+    }
+
+    void SetUp() override {
+        QuantumPainterFlashStream::SetUp();
+        ASSERT_TRUE(qp_init(surface, QP_ROTATION_0));
+        font_data = make_font(glyph_width, glyph_height);
+        std::copy(font_data.begin(), font_data.end(), flash_contents.begin() + font_flash_addr);
+    }
+
+    std::vector<uint16_t> render(painter_font_handle_t font, const char* str) {
+        std::fill(framebuffer.begin(), framebuffer.end(), 0);
+        EXPECT_GT(qp_drawtext(surface, 0, 0, font, str), 0);
+        return framebuffer;
+    }
+
+    std::vector<uint8_t> font_data;
+};
+
+TEST_F(QuantumPainterFlashFont, DrawsSameAsMemoryFont) {
+    const char* str = "Layer: Base 123";
+
+    painter_font_handle_t mem_font = qp_load_font_mem(font_data.data());
+    ASSERT_NE(mem_font, nullptr);
+    auto expected = render(mem_font, str);
+    ASSERT_TRUE(qp_close_font(mem_font));
+
+    painter_font_handle_t flash_font = qp_load_font_flash(font_flash_addr);
+    ASSERT_NE(flash_font, nullptr);
+    reset_counters();
+    EXPECT_EQ(render(flash_font, str), expected);
+    RecordProperty("flash_transactions", std::to_string(flash_transactions));
+    RecordProperty("flash_bytes", std::to_string(flash_bytes));
+    ASSERT_TRUE(qp_close_font(flash_font));
+}
+
+TEST_F(QuantumPainterFlashFont, SharesTheBusWithTheDisplay) {
+    const char* str = "Shared bus";
+
+    painter_font_handle_t mem_font = qp_load_font_mem(font_data.data());
+    ASSERT_NE(mem_font, nullptr);
+    auto expected = render(mem_font, str);
+    ASSERT_TRUE(qp_close_font(mem_font));
+
+    painter_font_handle_t flash_font = qp_load_font_flash(font_flash_addr);
+    ASSERT_NE(flash_font, nullptr);
+    EXPECT_TRUE(flash_initialised);
+
+    // Glyphs are read from flash part way through drawing, which has to release the display's chip select to do so
+    struct painter_driver_t* driver = (struct painter_driver_t*)surface;
+    surface_comms                   = driver->comms_vtable;
+    surface_driver                  = driver->driver_vtable;
+    struct painter_comms_vtable_t  bus_comms  = {surface_comms->comms_init, bus_comms_start, bus_comms_stop, surface_comms->comms_send};
+    struct painter_driver_vtable_t bus_driver = *surface_driver;
+    bus_driver.pixdata                        = bus_pixdata;
+    driver->comms_vtable                      = &bus_comms;
+    driver->driver_vtable                     = &bus_driver;
+    qp_flash_stream_invalidate_cache();
+    reset_counters();
+    bus_conflicts      = 0;
+    pixdata_unselected = 0;
+
+    auto actual           = render(flash_font, str);
+    driver->comms_vtable  = surface_comms;
+    driver->driver_vtable = surface_driver;
+    EXPECT_EQ(actual, expected);
+    EXPECT_GT(flash_transactions, 0u);
+    EXPECT_EQ(bus_conflicts, 0u);
+    EXPECT_EQ(pixdata_unselected, 0u);
+    EXPECT_EQ(bus_selected, nullptr);
+    ASSERT_TRUE(qp_close_font(flash_font));
+}
+
+TEST_F(QuantumPainterFlashFont, BadAddressFailsToLoad) {
+    EXPECT_EQ(qp_load_font_flash(font_flash_addr + 1), nullptr);
+    EXPECT_EQ(qp_load_font_flash(flash_size - 4), nullptr);
+}
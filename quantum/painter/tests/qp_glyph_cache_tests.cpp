@@ -0,0 +1,181 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "qp.h"
+#include "qp_internal.h"
+}
+
+#include "qp_test_common.h"
+
+static constexpr uint16_t surface_width  = 240;
+static constexpr uint16_t surface_height = 80;
+static constexpr uint8_t  glyph_width    = 6;
+static constexpr uint8_t  glyph_height   = 8;
+static constexpr uint32_t glyph_bytes    = glyph_width * glyph_height / 8;
+
+class QuantumPainterGlyphCache : public ::testing::Test, protected shared_surface_t<surface_width, surface_height> {
+   protected:
+    static void SetUpTestSuite() {
+        make_surface();
+    }
+
+    void SetUp() override {
+        ASSERT_TRUE(qp_init(surface, QP_ROTATION_0));
+        std::fill(framebuffer.begin(), framebuffer.end(), 0);
+        font_data = make_font(glyph_width, glyph_height, make_glyphs());
+        font      = qp_load_font_mem(font_data.data());
+        ASSERT_NE(font, nullptr);
+    }
+
+    void TearDown() override {
+        if (font) {
+            qp_close_font(font);
+        }
+    }
+
+    // Pixels of a glyph, a different pattern for each character
+    static bool glyph_pixel(char c, uint32_t x, uint32_t y) {
+        uint32_t hash = (uint8_t)c * 2654435761u ^ (y * glyph_width + x) * 40503u;
+        return ((hash >> 13) & 1) != 0;
+    }
+
+    // Glyph bitmaps for the full ascii table, packed as the QFF encoder does
+    static std::vector<uint8_t> make_glyphs() {
+        std::vector<uint8_t> data;
+        for (char c = 0x20; c < 0x7F; ++c) {
+            uint8_t packed[glyph_bytes] = {0};
+            for (uint32_t p = 0; p < uint32_t(glyph_width) * glyph_height; ++p) {
+                if (glyph_pixel(c, p % glyph_width, p / glyph_width)) {
+                    packed[p / 8] |= 1 << (p % 8);
+                }
+            }
+            data.insert(data.end(), packed, packed + glyph_bytes);
+        }
+        return data;
+    }
+
+    uint16_t native_color(uint8_t hue, uint8_t sat, uint8_t val) {
+        uint16_t saved = framebuffer.back();
+        qp_setpixel(surface, surface_width - 1, surface_height - 1, hue, sat, val);
+        uint16_t color     = framebuffer.back();
+        framebuffer.back() = saved;
+        return color;
+    }
+
+    // Checks the surface holds the string as the font describes it, in the given native colors
+    void expect_text(const std::string& str, uint16_t x, uint16_t y, uint16_t fg, uint16_t bg) {
+        for (size_t i = 0; i < str.size(); ++i) {
+            for (uint32_t gy = 0; gy < glyph_height; ++gy) {
+                for (uint32_t gx = 0; gx < glyph_width; ++gx) {
+                    uint16_t expected = glyph_pixel(str[i], gx, gy) ? fg : bg;
+                    uint16_t actual   = framebuffer[(y + gy) * surface_width + x + i * glyph_width + gx];
+                    ASSERT_EQ(actual, expected) << "glyph " << i << " ('" << str[i] << "') at " << gx << "," << gy;
+                }
+            }
+        }
+    }
+
+    int16_t draw(const std::string& str, uint16_t x, uint16_t y, uint8_t val_fg = 255, uint8_t val_bg = 0) {
+        return qp_drawtext_recolor(surface, x, y, font, str.c_str(), 0, 0, val_fg, 0, 0, val_bg);
+    }
+
+    std::vector<uint8_t>  font_data;
+    painter_font_handle_t font = nullptr;
+};
+
+TEST_F(QuantumPainterGlyphCache, CachedGlyphsMatchDecoded) {
+    uint16_t white = native_color(0, 0, 255);
+    uint16_t black = native_color(0, 0, 0);
+
+    EXPECT_EQ(draw("12:34 WPM", 0, 0), 9 * glyph_width);
+    expect_text("12:34 WPM", 0, 0, white, black);
+
+    // Second time around, everything comes from the cache
+    EXPECT_EQ(draw("43:21 MPW", 0, 10), 9 * glyph_width);
+    expect_text("43:21 MPW", 0, 10, white, black);
+}
+
+TEST_F(QuantumPainterGlyphCache, RepeatedTextDoesNotReadFont) {
+    uint16_t white = native_color(0, 0, 255);
+    uint16_t black = native_color(0, 0, 0);
+    ASSERT_GT(draw("Layer: Base", 0, 0), 0);
+
+    // Wipe the glyph bitmaps, anything still read from the font now comes out blank
+    std::fill(font_data.begin() + font_glyph_data_offset(), font_data.end(), 0);
+    ASSERT_GT(draw("Layer: Base", 0, 10), 0);
+    expect_text("Layer: Base", 0, 10, white, black);
+}
+
+TEST_F(QuantumPainterGlyphCache, ColorsAreCachedSeparately) {
+    ASSERT_GT(draw("OK", 0, 0, 255, 0), 0);
+    ASSERT_GT(draw("OK", 0, 10, 0, 255), 0);
+    expect_text("OK", 0, 10, native_color(0, 0, 0), native_color(0, 0, 255));
+}
+
+TEST_F(QuantumPainterGlyphCache, EvictsLeastRecentlyUsed) {
+    uint16_t white = native_color(0, 0, 255);
+    uint16_t black = native_color(0, 0, 0);
+
+    // A line's worth of distinct glyphs, more than the cache can hold
+    std::string all;
+    for (char c = 0x21; all.size() < surface_width / glyph_width; ++c) {
+        all += c;
+    }
+    ASSERT_GT(all.size() * glyph_width * glyph_height * sizeof(uint16_t), size_t(QUANTUM_PAINTER_GLYPH_CACHE_SIZE));
+    for (uint16_t line = 0; line < 4; ++line) {
+        ASSERT_GT(draw(all, 0, line * 10), 0);
+        expect_text(all, 0, line * 10, white, black);
+    }
+
+    // The most recent ones should still be around
+    std::string recent = all.substr(all.size() - 4);
+    std::fill(font_data.begin() + font_glyph_data_offset(), font_data.end(), 0);
+    ASSERT_GT(draw(recent, 0, 50), 0);
+    expect_text(recent, 0, 50, white, black);
+}
+
+TEST_F(QuantumPainterGlyphCache, ClosingFontDropsGlyphs) {
+    ASSERT_GT(draw("Hi", 0, 0), 0);
+    ASSERT_TRUE(qp_close_font(font));
+
+    // Same memory and handle, different glyphs
+    std::fill(font_data.begin() + font_glyph_data_offset(), font_data.end(), 0);
+    font = qp_load_font_mem(font_data.data());
+    ASSERT_NE(font, nullptr);
+    ASSERT_GT(draw("Hi", 0, 10), 0);
+
+    uint16_t black = native_color(0, 0, 0);
+    expect_text("Hi", 0, 10, black, black);
+}
+
+TEST_F(QuantumPainterGlyphCache, RepeatedTextThroughput) {
+    const std::string status = "WPM: 123  Layer: Base  Caps";
+
+    // Best time of several runs in microseconds, to keep the scheduler out of the results. Changing the colors on every
+    // line means nothing can come from the cache, while still doing the same drawing.
+    auto best_time = [&](bool cached) {
+        double best = 1e12;
+        for (int run = 0; run < 7; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            for (uint8_t line = 0; line < 8; ++line) {
+                draw(status, 0, line * 10, cached ? 255 : 255 - run * 8 - line);
+            }
+            best = std::min(best, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    };
+
+    double uncached = best_time(false);
+    double cached   = best_time(true);
+    RecordProperty("uncached_us", std::to_string(uncached));
+    RecordProperty("cached_us", std::to_string(cached));
+    EXPECT_LT(cached * 1.3, uncached);
+}
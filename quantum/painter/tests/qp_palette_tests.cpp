@@ -0,0 +1,135 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "qp_internal.h"
+#include "qp_draw.h"
+#include "qgf.h"
+}
+
+// Display which only counts palette conversions
+struct mock_display_t {
+    struct painter_driver_t base; // must be first, so it can be cast to/from the painter_device_t* type
+
+    uint32_t conversions;
+    uint32_t converted_entries;
+};
+
+static bool mock_palette_convert(painter_device_t device, int16_t palette_size, qp_pixel_t* palette) {
+    mock_display_t* display = (mock_display_t*)device;
+    for (int16_t i = 0; i < palette_size; ++i) {
+        uint16_t native   = (palette[i].hsv888.h << 8) | palette[i].hsv888.v;
+        palette[i].dummy  = 0;
+        palette[i].rgb565 = native;
+    }
+    display->conversions++;
+    display->converted_entries += palette_size;
+    return true;
+}
+
+static const struct painter_driver_vtable_t mock_driver_vtable = {.palette_convert = mock_palette_convert};
+
+class QuantumPainterPalette : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        for (auto* display : {&display_a, &display_b}) {
+            *display                    = mock_display_t{};
+            display->base.driver_vtable = &mock_driver_vtable;
+        }
+        qp_internal_invalidate_palette();
+    }
+
+    static qp_pixel_t hsv(uint8_t h, uint8_t s, uint8_t v) {
+        qp_pixel_t pixel = {.hsv888 = {h, s, v}};
+        return pixel;
+    }
+
+    qp_pixel_t* recolor(mock_display_t& display, uint8_t fg, uint8_t bg, uint8_t bpp) {
+        return qp_internal_recolor_palette(&display, hsv(0, 0, fg), hsv(0, 0, bg), bpp);
+    }
+
+    mock_display_t display_a;
+    mock_display_t display_b;
+};
+
+TEST_F(QuantumPainterPalette, InterpolatesFromBackgroundToForeground) {
+    qp_pixel_t* palette = qp_internal_recolor_palette(&display_a, hsv(10, 255, 255), hsv(10, 255, 0), 2);
+    ASSERT_NE(palette, nullptr);
+    EXPECT_EQ(palette[0].rgb565, (10 << 8) | 0);
+    EXPECT_EQ(palette[1].rgb565, (10 << 8) | 85);
+    EXPECT_EQ(palette[2].rgb565, (10 << 8) | 170);
+    EXPECT_EQ(palette[3].rgb565, (10 << 8) | 255);
+}
+
+TEST_F(QuantumPainterPalette, SameColorsReuseConvertedPalette) {
+    qp_pixel_t* first  = recolor(display_a, 255, 0, 4);
+    qp_pixel_t* second = recolor(display_a, 255, 0, 4);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(display_a.conversions, 1u);
+}
+
+TEST_F(QuantumPainterPalette, InterleavedColorsDontThrash) {
+    // Text, icons and a highlight drawn in turn, as a typical status screen does
+    for (int frame = 0; frame < 10; ++frame) {
+        ASSERT_NE(recolor(display_a, 255, 0, 1), nullptr);
+        ASSERT_NE(recolor(display_a, 128, 0, 4), nullptr);
+        ASSERT_NE(recolor(display_a, 0, 255, 1), nullptr);
+    }
+    RecordProperty("converted_entries", std::to_string(display_a.converted_entries));
+    EXPECT_EQ(display_a.conversions, 3u);
+}
+
+TEST_F(QuantumPainterPalette, KeyedByBppAndDevice) {
+    qp_pixel_t* one_bpp  = recolor(display_a, 255, 0, 1);
+    qp_pixel_t* four_bpp = recolor(display_a, 255, 0, 4);
+    qp_pixel_t* other    = recolor(display_b, 255, 0, 1);
+    EXPECT_NE(one_bpp, four_bpp);
+    EXPECT_NE(one_bpp, other);
+    EXPECT_EQ(display_a.conversions, 2u);
+    EXPECT_EQ(display_b.conversions, 1u);
+}
+
+TEST_F(QuantumPainterPalette, LeastRecentlyUsedIsReplaced) {
+    for (uint8_t i = 0; i < QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES; ++i) {
+        recolor(display_a, i, 0, 1);
+    }
+    // Touch the oldest so the second oldest goes instead
+    recolor(display_a, 0, 0, 1);
+    recolor(display_a, 200, 0, 1);
+    EXPECT_EQ(display_a.conversions, QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES + 1u);
+
+    recolor(display_a, 0, 0, 1);
+    EXPECT_EQ(display_a.conversions, QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES + 1u);
+    recolor(display_a, 1, 0, 1);
+    EXPECT_EQ(display_a.conversions, QUANTUM_PAINTER_PALETTE_CACHE_ENTRIES + 2u);
+}
+
+TEST_F(QuantumPainterPalette, LoadedPaletteReplacesLargePalette) {
+    ASSERT_EQ(recolor(display_a, 255, 0, 8), qp_internal_global_pixel_lookup_table);
+    ASSERT_EQ(recolor(display_a, 255, 0, 8), qp_internal_global_pixel_lookup_table);
+    EXPECT_EQ(display_a.conversions, 1u);
+
+    // A QGF palette block loaded into the global lookup table
+    std::vector<uint8_t> block = {QGF_FRAME_PALETTE_DESCRIPTOR_TYPEID, uint8_t(~QGF_FRAME_PALETTE_DESCRIPTOR_TYPEID), 6, 0, 0, 1, 2, 3, 4, 5, 6};
+    qp_memory_stream_t   stream = qp_make_memory_stream(block.data(), block.size());
+    ASSERT_TRUE(qp_internal_load_qgf_palette(&stream.base, 1));
+
+    // Small palettes live elsewhere and survive, large ones need regenerating
+    qp_pixel_t* small = recolor(display_a, 255, 0, 1);
+    ASSERT_EQ(recolor(display_a, 255, 0, 8), qp_internal_global_pixel_lookup_table);
+    EXPECT_NE(small, qp_internal_global_pixel_lookup_table);
+    EXPECT_EQ(display_a.conversions, 3u);
+}
+
+TEST_F(QuantumPainterPalette, InvalidateDropsEverything) {
+    recolor(display_a, 255, 0, 1);
+    recolor(display_a, 255, 0, 8);
+    qp_internal_invalidate_palette();
+    recolor(display_a, 255, 0, 1);
+    recolor(display_a, 255, 0, 8);
+    EXPECT_EQ(display_a.conversions, 4u);
+}
@@ -0,0 +1,127 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "qp_internal.h"
+#include "qp_draw.h"
+}
+
+#include "qp_test_common.h"
+
+static constexpr uint16_t surface_width  = 240;
+static constexpr uint16_t surface_height = 240;
+
+class QuantumPainterSurface : public ::testing::Test, protected shared_surface_t<surface_width, surface_height> {
+   protected:
+    static void SetUpTestSuite() {
+        make_surface();
+    }
+
+    void SetUp() override {
+        mock_display_setup(display, surface_width, surface_height, 0xFFFF);
+        ASSERT_TRUE(qp_init(&display, QP_ROTATION_0));
+
+        ASSERT_TRUE(qp_init(surface, QP_ROTATION_0));
+        ASSERT_TRUE(qp_rgb565_surface_set_flush_target(surface, nullptr, 0, 0));
+
+        // Get the display in sync with the surface
+        ASSERT_TRUE(qp_rgb565_surface_draw(surface, &display, 0, 0));
+        display.reset_counters();
+    }
+
+    mock_display_t display;
+};
+
+TEST_F(QuantumPainterSurface, InitSendsWholeSurface) {
+    ASSERT_TRUE(qp_init(surface, QP_ROTATION_0));
+    ASSERT_TRUE(qp_rgb565_surface_draw(surface, &display, 0, 0));
+    EXPECT_EQ(display.viewports, 1u);
+    EXPECT_EQ(display.pixel_bytes(), framebuffer.size() * sizeof(uint16_t));
+}
+
+TEST_F(QuantumPainterSurface, SmallWidgetSendsOnlyItsArea) {
+    // Something the size of a WPM counter, on a full-screen surface
+    ASSERT_TRUE(qp_rect(surface, 100, 200, 123, 215, 0, 0, 255, true));
+    ASSERT_TRUE(qp_rgb565_surface_draw(surface, &display, 0, 0));
+
+    RecordProperty("widget_traffic_bytes", std::to_string(display.traffic()));
+    EXPECT_EQ(display.viewports, 1u);
+    EXPECT_EQ(display.pixel_bytes(), 24u * 16 * sizeof(uint16_t));
+    EXPECT_EQ(display.framebuffer, framebuffer);
+}
+
+TEST_F(QuantumPainterSurface, UnchangedRedrawSendsNothing) {
+    ASSERT_TRUE(qp_rect(surface, 100, 200, 123, 215, 0, 0, 255, true));
+    ASSERT_TRUE(qp_rgb565_surface_draw(surface, &display, 0, 0));
+    display.reset_counters();
+
+    ASSERT_TRUE(qp_rect(surface, 100, 200, 123, 215, 0, 0, 255, true));
+    ASSERT_TRUE(qp_rgb565_surface_draw(surface, &display, 0, 0));
+    EXPECT_EQ(display.traffic(), 0u);
+}
+
+TEST_F(QuantumPainterSurface, DistantChangesAreSentSeparately) {
+    ASSERT_TRUE(qp_rect(surface, 0, 0, 9, 9, 0, 0, 255, true));
+    ASSERT_TRUE(qp_rect(surface, 230, 230, 239, 239, 0, 0, 255, true));
+    ASSERT_TRUE(qp_rgb565_surface_draw(surface, &display, 0, 0));
+
+    EXPECT_EQ(display.viewports, 2u);
+    EXPECT_EQ(display.pixel_bytes(), 2u * 10 * 10 * sizeof(uint16_t));
+    EXPECT_EQ(display.framebuffer, framebuffer);
+}
+
+TEST_F(QuantumPainterSurface, NearbyChangesAreSentTogether) {
+    ASSERT_TRUE(qp_rect(surface, 50, 50, 59, 59, 0, 0, 255, true));
+    ASSERT_TRUE(qp_rect(surface, 62, 50, 71, 59, 0, 0, 255, true));
+    ASSERT_TRUE(qp_rgb565_surface_draw(surface, &display, 0, 0));
+
+    EXPECT_EQ(display.viewports, 1u);
+    EXPECT_EQ(display.pixel_bytes(), 22u * 10 * sizeof(uint16_t));
+    EXPECT_EQ(display.framebuffer, framebuffer);
+}
+
+TEST_F(QuantumPainterSurface, RegionsBeyondLimitAreMerged) {
+    for (uint16_t i = 0; i < RGB565_SURFACE_DIRTY_RECTS + 2; ++i) {
+        uint16_t x = i * 30;
+        ASSERT_TRUE(qp_rect(surface, x, x, x + 4, x + 4, 0, 0, 255, true));
+    }
+    ASSERT_TRUE(qp_rgb565_surface_draw(surface, &display, 0, 0));
+
+    EXPECT_LE(display.viewports, uint32_t(RGB565_SURFACE_DIRTY_RECTS));
+    EXPECT_EQ(display.framebuffer, framebuffer);
+}
+
+TEST_F(QuantumPainterSurface, OutlinesAndLines) {
+    ASSERT_TRUE(qp_rect(surface, 20, 20, 80, 60, 0, 255, 255, false));
+    ASSERT_TRUE(qp_line(surface, 150, 10, 220, 100, 85, 255, 255));
+    ASSERT_TRUE(qp_circle(surface, 120, 180, 30, 170, 255, 255, false));
+    ASSERT_TRUE(qp_rgb565_surface_draw(surface, &display, 0, 0));
+
+    EXPECT_EQ(display.framebuffer, framebuffer);
+    EXPECT_LT(display.pixel_bytes(), framebuffer.size() * sizeof(uint16_t) / 4);
+}
+
+TEST_F(QuantumPainterSurface, FlushTargetReceivesChangesOnFlush) {
+    ASSERT_TRUE(qp_rgb565_surface_set_flush_target(surface, &display, 0, 0));
+    ASSERT_TRUE(qp_rect(surface, 100, 200, 123, 215, 0, 0, 255, true));
+    EXPECT_EQ(display.traffic(), 0u);
+
+    ASSERT_TRUE(qp_flush(surface));
+    EXPECT_EQ(display.pixel_bytes(), 24u * 16 * sizeof(uint16_t));
+    EXPECT_EQ(display.framebuffer, framebuffer);
+
+    display.reset_counters();
+    ASSERT_TRUE(qp_flush(surface));
+    EXPECT_EQ(display.traffic(), 0u);
+}
+
+TEST_F(QuantumPainterSurface, FlushWithoutTargetOnlyResets) {
+    ASSERT_TRUE(qp_rect(surface, 100, 200, 123, 215, 0, 0, 255, true));
+    ASSERT_TRUE(qp_flush(surface));
+    ASSERT_TRUE(qp_rgb565_surface_draw(surface, &display, 0, 0));
+    EXPECT_EQ(display.traffic(), 0u);
+}
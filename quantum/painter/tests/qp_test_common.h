@@ -0,0 +1,316 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+extern "C" {
+#include "qp_internal.h"
+#include "qp_comms.h"
+#include "qgf.h"
+#include "qff.h"
+}
+
+// Bytes a typical SPI panel needs to set a viewport: CASET and RASET with four bytes each, then RAMWR
+static constexpr uint32_t mock_viewport_bytes = 11;
+
+// 16bpp display which keeps its own framebuffer, and counts what an SPI panel would have been sent. Tests which need to
+// see more of what's drawn can hook the viewport and palette index calls.
+struct mock_display_t {
+    struct painter_driver_t base; // must be first, so it can be cast to/from the painter_device_t* type
+
+    std::vector<uint16_t> framebuffer;
+    std::vector<uint8_t>  writes; // how many times each pixel was written
+    uint16_t              viewport_l, viewport_t, viewport_r, viewport_b;
+    uint16_t              pixdata_x, pixdata_y;
+    uint32_t              viewports;
+    uint32_t              pixels;
+    uint32_t              decoded; // pixels converted from palette indices, by the display or anything drawing for it
+
+    std::function<void(uint16_t left, uint16_t top, uint16_t right, uint16_t bottom)> on_viewport;
+    std::function<void(uint32_t pixel_count, const uint8_t* palette_indices)>          on_append_pixels;
+
+    uint32_t pixel_bytes() const {
+        return pixels * sizeof(uint16_t);
+    }
+
+    uint32_t traffic() const {
+        return viewports * mock_viewport_bytes + pixel_bytes();
+    }
+
+    void reset_counters() {
+        std::fill(writes.begin(), writes.end(), 0);
+        viewports = 0;
+        pixels    = 0;
+        decoded   = 0;
+    }
+};
+
+static inline bool mock_init(painter_device_t device, painter_rotation_t rotation) {
+    return true;
+}
+
+static inline bool mock_power(painter_device_t device, bool power_on) {
+    return true;
+}
+
+static inline bool mock_clear(painter_device_t device) {
+    return true;
+}
+
+static inline bool mock_flush(painter_device_t device) {
+    return true;
+}
+
+static inline bool mock_viewport(painter_device_t device, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom) {
+    mock_display_t* display = (mock_display_t*)device;
+    display->viewport_l     = left;
+    display->viewport_t     = top;
+    display->viewport_r     = right;
+    display->viewport_b     = bottom;
+    display->pixdata_x      = left;
+    display->pixdata_y      = top;
+    display->viewports++;
+    if (display->on_viewport) {
+        display->on_viewport(left, top, right, bottom);
+    }
+    return true;
+}
+
+static inline bool mock_pixdata(painter_device_t device, const void* pixel_data, uint32_t native_pixel_count) {
+    mock_display_t* display = (mock_display_t*)device;
+    const uint16_t* data    = (const uint16_t*)pixel_data;
+    for (uint32_t i = 0; i < native_pixel_count; ++i) {
+        if (display->pixdata_x < display->base.panel_width && display->pixdata_y < display->base.panel_height) {
+            uint32_t index              = display->pixdata_y * display->base.panel_width + display->pixdata_x;
+            display->framebuffer[index] = data[i];
+            display->writes[index]++;
+        }
+        if (++display->pixdata_x > display->viewport_r) {
+            display->pixdata_x = display->viewport_l;
+            if (++display->pixdata_y > display->viewport_b) {
+                display->pixdata_y = display->viewport_t;
+            }
+        }
+    }
+    display->pixels += native_pixel_count;
+    return true;
+}
+
+// Stands in for an RGB565 conversion, keeping each HSV component recognisable
+static inline bool mock_palette_convert(painter_device_t device, int16_t palette_size, qp_pixel_t* palette) {
+    for (int16_t i = 0; i < palette_size; ++i) {
+        uint16_t native   = ((palette[i].hsv888.h >> 3) << 11) | ((palette[i].hsv888.s >> 2) << 5) | (palette[i].hsv888.v >> 3);
+        palette[i].dummy  = 0;
+        palette[i].rgb565 = native;
+    }
+    return true;
+}
+
+static inline bool mock_append_pixels(painter_device_t device, uint8_t* target_buffer, qp_pixel_t* palette, uint32_t pixel_offset, uint32_t pixel_count, uint8_t* palette_indices) {
+    mock_display_t* display = (mock_display_t*)device;
+    display->decoded += pixel_count;
+    uint16_t* buf = (uint16_t*)target_buffer;
+    for (uint32_t i = 0; i < pixel_count; ++i) {
+        buf[pixel_offset + i] = palette[palette_indices[i]].rgb565;
+    }
+    if (display->on_append_pixels) {
+        display->on_append_pixels(pixel_count, palette_indices);
+    }
+    return true;
+}
+
+static inline bool mock_append_pixdata(painter_device_t device, uint8_t* target_buffer, uint32_t pixdata_offset, uint8_t pixdata_byte) {
+    target_buffer[pixdata_offset] = pixdata_byte;
+    return true;
+}
+
+static inline bool mock_comms_init(painter_device_t device) {
+    return true;
+}
+
+static inline bool mock_comms_start(painter_device_t device) {
+    return true;
+}
+
+static inline void mock_comms_stop(painter_device_t device) {}
+
+static inline uint32_t mock_comms_send(painter_device_t device, const void* data, uint32_t byte_count) {
+    return byte_count;
+}
+
+static const struct painter_driver_vtable_t mock_driver_vtable = {mock_init, mock_power, mock_clear, mock_flush, mock_viewport, mock_pixdata, mock_palette_convert, mock_append_pixels, mock_append_pixdata};
+static const struct painter_comms_vtable_t  mock_comms_vtable  = {mock_comms_init, mock_comms_start, mock_comms_stop, mock_comms_send};
+
+// Resets the display to a blank panel of the given size, ready for qp_init()
+static inline void mock_display_setup(mock_display_t& display, uint16_t width, uint16_t height, uint16_t fill = 0) {
+    display                            = mock_display_t{};
+    display.base.driver_vtable         = &mock_driver_vtable;
+    display.base.comms_vtable          = &mock_comms_vtable;
+    display.base.panel_width           = width;
+    display.base.panel_height          = height;
+    display.base.native_bits_per_pixel = 16;
+    display.framebuffer.assign(uint32_t(width) * height, fill);
+    display.writes.assign(uint32_t(width) * height, 0);
+}
+
+// RGB565 surface for tests to draw on. Surfaces can't be released, so every fixture using one of the same size shares it.
+template <uint16_t width, uint16_t height>
+struct shared_surface_t {
+    static std::vector<uint16_t> framebuffer;
+    static painter_device_t      surface;
+
+    static void make_surface() {
+        if (!surface) {
+            framebuffer.assign(uint32_t(width) * height, 0);
+            surface = qp_rgb565_make_surface(width, height, framebuffer.data());
+        }
+    }
+};
+
+template <uint16_t width, uint16_t height>
+std::vector<uint16_t> shared_surface_t<width, height>::framebuffer;
+template <uint16_t width, uint16_t height>
+painter_device_t shared_surface_t<width, height>::surface = nullptr;
+
+static inline void push_block_header(std::vector<uint8_t>& data, uint8_t type_id, uint32_t length) {
+    data.push_back(type_id);
+    data.push_back(~type_id);
+    data.push_back(length & 0xFF);
+    data.push_back((length >> 8) & 0xFF);
+    data.push_back((length >> 16) & 0xFF);
+}
+
+static inline void push_u16(std::vector<uint8_t>& data, uint16_t value) {
+    data.push_back(value & 0xFF);
+    data.push_back(value >> 8);
+}
+
+static inline void push_u32(std::vector<uint8_t>& data, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        data.push_back((value >> (i * 8)) & 0xFF);
+    }
+}
+
+static inline void put_u32(std::vector<uint8_t>& data, size_t offset, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        data[offset + i] = (value >> (i * 8)) & 0xFF;
+    }
+}
+
+// Same RLE scheme as the QGF/QFF encoders
+static inline std::vector<uint8_t> rle_encode(const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> out;
+    size_t               i = 0;
+    while (i < data.size()) {
+        size_t run = 1;
+        while (i + run < data.size() && run < 127 && data[i + run] == data[i]) {
+            ++run;
+        }
+        if (run >= 2) {
+            out.push_back(uint8_t(run));
+            out.push_back(data[i]);
+            i += run;
+            continue;
+        }
+        size_t start = i;
+        while (i < data.size() && i - start < 128 && !(i + 1 < data.size() && data[i + 1] == data[i])) {
+            ++i;
+        }
+        out.push_back(uint8_t(127 + (i - start)));
+        out.insert(out.end(), data.begin() + start, data.begin() + i);
+    }
+    return out;
+}
+
+// Same LZ scheme as the QGF encoder: greedy matches of at least 3 bytes, up to 256 bytes back
+static inline std::vector<uint8_t> lz_encode(const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> out;
+    auto                 put_length = [&](size_t length) {
+        for (; length >= 255; length -= 255) {
+            out.push_back(255);
+        }
+        out.push_back(uint8_t(length));
+    };
+    auto emit = [&](size_t literal_start, size_t literal_end, size_t match, size_t offset) {
+        size_t literals = literal_end - literal_start;
+        size_t m        = match ? match - 2 : 0;
+        out.push_back(uint8_t((std::min<size_t>(literals, 15) << 4) | std::min<size_t>(m, 15)));
+        if (literals >= 15) {
+            put_length(literals - 15);
+        }
+        out.insert(out.end(), data.begin() + literal_start, data.begin() + literal_end);
+        if (match) {
+            out.push_back(uint8_t(offset - 1));
+            if (m >= 15) {
+                put_length(m - 15);
+            }
+        }
+    };
+
+    size_t literal_start = 0;
+    size_t i             = 0;
+    while (i < data.size()) {
+        size_t best = 0, best_offset = 0;
+        for (size_t offset = 1; offset <= std::min<size_t>(i, 256); ++offset) {
+            size_t length = 0;
+            while (i + length < data.size() && data[i + length] == data[i + length - offset]) {
+                ++length;
+            }
+            if (length > best) {
+                best        = length;
+                best_offset = offset;
+            }
+        }
+        if (best >= 3) {
+            emit(literal_start, i, best, best_offset);
+            i += best;
+            literal_start = i;
+        } else {
+            ++i;
+        }
+    }
+    if (literal_start < data.size()) {
+        emit(literal_start, data.size(), 0, 0);
+    }
+    return out;
+}
+
+// Monospace 1bpp grayscale font with the full ascii table, laid out as the QFF encoder does. Glyph bitmaps are packed
+// one after the other starting from the space character, and are filled with noise if none are given.
+static inline std::vector<uint8_t> make_font(uint8_t glyph_width, uint8_t glyph_height, std::vector<uint8_t> glyphs = {}) {
+    const uint32_t glyph_bytes = (uint32_t(glyph_width) * glyph_height + 7) / 8;
+    const uint32_t data_length = 95 * glyph_bytes;
+    if (glyphs.empty()) {
+        for (uint32_t i = 0; i < data_length; ++i) {
+            glyphs.push_back(uint8_t(i * 2654435761u >> 13));
+        }
+    }
+
+    const uint32_t       total_size = sizeof(qff_font_descriptor_v1_t) + sizeof(qff_ascii_glyph_table_v1_t) + sizeof(qgf_block_header_v1_t) + data_length;
+    std::vector<uint8_t> data;
+
+    push_block_header(data, QFF_FONT_DESCRIPTOR_TYPEID, sizeof(qff_font_descriptor_v1_t) - sizeof(qgf_block_header_v1_t));
+    data.insert(data.end(), {0x51, 0x46, 0x46, 0x01}); // magic, version
+    push_u32(data, total_size);
+    push_u32(data, ~total_size);
+    data.insert(data.end(), {glyph_height, 1, 0, 0, GRAYSCALE_1BPP, 0, IMAGE_UNCOMPRESSED, 0xFF});
+
+    push_block_header(data, QFF_ASCII_GLYPH_DESCRIPTOR_TYPEID, 95 * sizeof(qff_ascii_glyph_v1_t));
+    for (uint32_t i = 0; i < 95; ++i) {
+        uint32_t value = glyph_width | ((i * glyph_bytes) << QFF_GLYPH_WIDTH_BITS);
+        data.insert(data.end(), {uint8_t(value), uint8_t(value >> 8), uint8_t(value >> 16)});
+    }
+
+    push_block_header(data, QGF_FRAME_DATA_DESCRIPTOR_TYPEID, data_length);
+    data.insert(data.end(), glyphs.begin(), glyphs.begin() + data_length);
+    return data;
+}
+
+// Offset of the glyph bitmaps within a font from make_font()
+static inline size_t font_glyph_data_offset() {
+    return sizeof(qff_font_descriptor_v1_t) + sizeof(qff_ascii_glyph_table_v1_t) + sizeof(qgf_block_header_v1_t);
+}
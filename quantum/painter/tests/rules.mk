@@ -0,0 +1,96 @@
+painter_common_DEFS := \
+	-DQUANTUM_PAINTER_ENABLE \
+	-DQUANTUM_PAINTER_RGB565_SURFACE_ENABLE \
+	-DQUANTUM_PAINTER_SUPPORTS_256_PALETTE=1 \
+	-DQUANTUM_PAINTER_SUPPORTS_NATIVE_COLORS=1 \
+	-DNO_DEBUG
+painter_common_CONFIG := $(QUANTUM_PATH)/painter/tests/config_mock.h
+painter_common_INC := \
+	$(QUANTUM_PATH)/painter \
+	$(QUANTUM_PATH)/unicode \
+	$(DRIVER_PATH)/painter/generic
+painter_common_SRC := \
+	$(QUANTUM_PATH)/painter/qp.c \
+	$(QUANTUM_PATH)/painter/qp_comms.c \
+	$(QUANTUM_PATH)/painter/qp_stream.c \
+	$(QUANTUM_PATH)/painter/qgf.c \
+	$(QUANTUM_PATH)/painter/qff.c \
+	$(QUANTUM_PATH)/painter/qp_draw_core.c \
+	$(QUANTUM_PATH)/painter/qp_draw_codec.c \
+	$(QUANTUM_PATH)/painter/qp_draw_circle.c \
+	$(QUANTUM_PATH)/painter/qp_draw_ellipse.c \
+	$(QUANTUM_PATH)/painter/qp_draw_image.c \
+	$(QUANTUM_PATH)/painter/qp_draw_text.c \
+	$(QUANTUM_PATH)/unicode/utf8.c \
+	$(QUANTUM_PATH)/color.c \
+	$(QUANTUM_PATH)/deferred_exec.c \
+	$(DRIVER_PATH)/painter/generic/qp_rgb565_surface.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
+
+painter_animation_DEFS := $(painter_common_DEFS)
+painter_animation_CONFIG := $(painter_common_CONFIG)
+painter_animation_INC := $(painter_common_INC)
+painter_animation_SRC := \
+	$(painter_common_SRC) \
+	$(QUANTUM_PATH)/painter/tests/qp_animation_tests.cpp
+
+painter_codec_DEFS := $(painter_common_DEFS)
+painter_codec_CONFIG := $(painter_common_CONFIG)
+painter_codec_INC := $(painter_common_INC)
+painter_codec_SRC := \
+	$(painter_common_SRC) \
+	$(QUANTUM_PATH)/painter/tests/qp_codec_tests.cpp
+
+painter_compositor_DEFS := \
+	$(painter_common_DEFS) \
+	-DQUANTUM_PAINTER_COMPOSITOR_ENABLE
+painter_compositor_CONFIG := $(painter_common_CONFIG)
+painter_compositor_INC := $(painter_common_INC)
+painter_compositor_SRC := \
+	$(painter_common_SRC) \
+	$(QUANTUM_PATH)/painter/qp_compositor.c \
+	$(QUANTUM_PATH)/painter/tests/qp_compositor_tests.cpp
+
+painter_draw_DEFS := $(painter_common_DEFS)
+painter_draw_CONFIG := $(painter_common_CONFIG)
+painter_draw_INC := $(painter_common_INC)
+painter_draw_SRC := \
+	$(painter_common_SRC) \
+	$(QUANTUM_PATH)/painter/tests/qp_draw_tests.cpp
+
+painter_palette_DEFS := \
+	$(painter_common_DEFS) \
+	-DQUANTUM_PAINTER_PALETTE_CACHE_ENTRIES=4
+painter_palette_CONFIG := $(painter_common_CONFIG)
+painter_palette_INC := $(painter_common_INC)
+painter_palette_SRC := \
+	$(painter_common_SRC) \
+	$(QUANTUM_PATH)/painter/tests/qp_palette_tests.cpp
+
+painter_surface_DEFS := $(painter_common_DEFS)
+painter_surface_CONFIG := $(painter_common_CONFIG)
+painter_surface_INC := $(painter_common_INC)
+painter_surface_SRC := \
+	$(painter_common_SRC) \
+	$(QUANTUM_PATH)/painter/tests/qp_rgb565_surface_tests.cpp
+
+painter_flash_stream_DEFS := \
+	$(painter_common_DEFS) \
+	-DQUANTUM_PAINTER_EXTERNAL_FLASH_ENABLE \
+	-DEXTERNAL_FLASH_SPI_SLAVE_SELECT_PIN=0
+painter_flash_stream_CONFIG := $(painter_common_CONFIG)
+painter_flash_stream_INC := \
+	$(painter_common_INC) \
+	$(DRIVER_PATH)/flash
+painter_flash_stream_SRC := \
+	$(painter_common_SRC) \
+	$(QUANTUM_PATH)/painter/tests/qp_flash_stream_tests.cpp
+
+painter_glyph_cache_DEFS := \
+	$(painter_common_DEFS) \
+	-DQUANTUM_PAINTER_GLYPH_CACHE_SIZE=2048
+painter_glyph_cache_CONFIG := $(painter_common_CONFIG)
+painter_glyph_cache_INC := $(painter_common_INC)
+painter_glyph_cache_SRC := \
+	$(painter_common_SRC) \
+	$(QUANTUM_PATH)/painter/tests/qp_glyph_cache_tests.cpp
@@ -0,0 +1,9 @@
+TEST_LIST += \
+	painter_animation \
+	painter_codec \
+	painter_compositor \
+	painter_draw \
+	painter_flash_stream \
+	painter_glyph_cache \
+	painter_palette \
+	painter_surface
@@ -7,9 +7,12 @@ RGB_MATRIX_EFFECT(PIXEL_FLOW)
 
 static bool PIXEL_FLOW(effect_params_t* params) {
     // LED state array
-    static RGB led[RGB_MATRIX_LED_COUNT];
+    RGB* led = rgb_effect_state.pixel_flow.led;
 
     static uint32_t wait_timer = 0;
+    if (params->init) {
+        wait_timer = 0;
+    }
     if (wait_timer > g_rgb_timer) {
         return false;
     }
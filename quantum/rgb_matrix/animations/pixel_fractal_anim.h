@@ -8,7 +8,7 @@ RGB_MATRIX_EFFECT(PIXEL_FRACTAL)
 
 static bool PIXEL_FRACTAL(effect_params_t* params) {
 #        define MID_COL MATRIX_COLS / 2
-    static bool     led[MATRIX_ROWS][MID_COL];
+    bool(*led)[MID_COL]        = rgb_effect_state.pixel_fractal.led;
     static uint32_t wait_timer = 0;
 
     inline uint32_t interval(void) {
@@ -17,6 +17,7 @@ static bool PIXEL_FRACTAL(effect_params_t* params) {
 
     if (params->init) {
         rgb_matrix_set_color_all(0, 0, 0);
+        wait_timer = 0;
     }
 
     RGB_MATRIX_USE_LIMITS(led_min, led_max);
@@ -34,6 +34,25 @@ __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) {
     return hsv_to_rgb(hsv);
 }
 
+// Effect-private state. Only one effect renders at a time, so effects which
+// need more than a few bytes of state share this storage. It is cleared
+// whenever the effect changes, before the effect's first init frame.
+typedef union {
+#ifdef ENABLE_RGB_MATRIX_PIXEL_FLOW
+    struct {
+        RGB led[RGB_MATRIX_LED_COUNT];
+    } pixel_flow;
+#endif
+#ifdef ENABLE_RGB_MATRIX_PIXEL_FRACTAL
+    struct {
+        bool led[MATRIX_ROWS][MATRIX_COLS / 2];
+    } pixel_fractal;
+#endif
+    uint8_t none;
+} rgb_matrix_effect_state_t;
+
+static rgb_matrix_effect_state_t rgb_effect_state;
+
 // Generic effect runners
 #include "rgb_matrix_runners.inc"
 
@@ -113,7 +132,10 @@ uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS] = {{0}};
 #endif // RGB_MATRIX_FRAMEBUFFER_EFFECTS
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 last_hit_t g_last_hit_tracker;
-#endif // RGB_MATRIX_KEYREACTIVE_ENABLED
+#    ifdef RGB_MATRIX_KEYREACTIVE_DISTANCE_CACHE
+uint8_t g_last_hit_distance[LED_HITS_TO_REMEMBER][RGB_MATRIX_LED_COUNT];
+#    endif // RGB_MATRIX_KEYREACTIVE_DISTANCE_CACHE
+#endif     // RGB_MATRIX_KEYREACTIVE_ENABLED
 
 // internals
 static bool            suspend_state     = false;
@@ -125,11 +147,43 @@ static rgb_task_states rgb_task_state    = SYNCING;
 static uint32_t rgb_anykey_timer;
 #endif // RGB_MATRIX_TIMEOUT > 0
 
+#ifdef RGB_MATRIX_TARGET_FPS
+uint8_t                         g_rgb_led_process_limit = RGB_MATRIX_LED_COUNT;
+static uint32_t                 rgb_frame_deadline;
+static uint8_t                  rgb_frame_remainder;
+static uint32_t                 rgb_frame_start;
+static uint16_t                 rgb_frame_task_calls;
+static uint32_t                 rgb_stats_timer;
+static uint16_t                 rgb_stats_frames;
+static uint16_t                 rgb_stats_dropped;
+static uint8_t                  rgb_stats_frame_time_max;
+static rgb_matrix_frame_stats_t rgb_frame_stats;
+#endif // RGB_MATRIX_TARGET_FPS
+
 // double buffers
 static uint32_t rgb_timer_buffer;
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
-static last_hit_t last_hit_buffer;
-#endif // RGB_MATRIX_KEYREACTIVE_ENABLED
+// Hits are stored in a time-ordered ring with the sync timer value at which
+// they happened, and only aged and copied into g_last_hit_tracker once per
+// frame. The oldest hit is always at the head, so expiry stops at the first
+// live hit instead of scanning the whole buffer.
+typedef struct {
+    uint32_t time;
+    uint8_t  x;
+    uint8_t  y;
+    uint8_t  index;
+} rgb_hit_t;
+
+static rgb_hit_t rgb_hit_ring[LED_HITS_TO_REMEMBER];
+static uint8_t   rgb_hit_head;
+static uint8_t   rgb_hit_count;
+#    ifdef RGB_MATRIX_KEYREACTIVE_DISTANCE_CACHE
+// Sequence numbers of the oldest hit in the ring and in g_last_hit_tracker,
+// used to carry cached distance rows over between frames.
+static uint16_t rgb_hit_seq;
+static uint16_t rgb_hit_tracker_seq;
+#    endif // RGB_MATRIX_KEYREACTIVE_DISTANCE_CACHE
+#endif     // RGB_MATRIX_KEYREACTIVE_ENABLED
 
 // split rgb matrix
 #if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
@@ -225,21 +279,24 @@ void process_rgb_matrix(uint8_t row, uint8_t col, bool pressed) {
         led_count = rgb_matrix_map_row_column_to_led(row, col, led);
     }
 
-    if (last_hit_buffer.count + led_count > LED_HITS_TO_REMEMBER) {
-        memcpy(&last_hit_buffer.x[0], &last_hit_buffer.x[led_count], LED_HITS_TO_REMEMBER - led_count);
-        memcpy(&last_hit_buffer.y[0], &last_hit_buffer.y[led_count], LED_HITS_TO_REMEMBER - led_count);
-        memcpy(&last_hit_buffer.tick[0], &last_hit_buffer.tick[led_count], (LED_HITS_TO_REMEMBER - led_count) * 2); // 16 bit
-        memcpy(&last_hit_buffer.index[0], &last_hit_buffer.index[led_count], LED_HITS_TO_REMEMBER - led_count);
-        last_hit_buffer.count = LED_HITS_TO_REMEMBER - led_count;
-    }
-
+    uint32_t now = sync_timer_read32();
     for (uint8_t i = 0; i < led_count; i++) {
-        uint8_t index                = last_hit_buffer.count;
-        last_hit_buffer.x[index]     = g_led_config.point[led[i]].x;
-        last_hit_buffer.y[index]     = g_led_config.point[led[i]].y;
-        last_hit_buffer.index[index] = led[i];
-        last_hit_buffer.tick[index]  = 0;
-        last_hit_buffer.count++;
+        // drop the oldest hit when full
+        if (rgb_hit_count == LED_HITS_TO_REMEMBER) {
+            if (++rgb_hit_head == LED_HITS_TO_REMEMBER) rgb_hit_head = 0;
+            rgb_hit_count--;
+#    ifdef RGB_MATRIX_KEYREACTIVE_DISTANCE_CACHE
+            rgb_hit_seq++;
+#    endif // RGB_MATRIX_KEYREACTIVE_DISTANCE_CACHE
+        }
+
+        uint16_t slot = rgb_hit_head + rgb_hit_count;
+        if (slot >= LED_HITS_TO_REMEMBER) slot -= LED_HITS_TO_REMEMBER;
+        rgb_hit_ring[slot].time  = now;
+        rgb_hit_ring[slot].x     = g_led_config.point[led[i]].x;
+        rgb_hit_ring[slot].y     = g_led_config.point[led[i]].y;
+        rgb_hit_ring[slot].index = led[i];
+        rgb_hit_count++;
     }
 #endif // RGB_MATRIX_KEYREACTIVE_ENABLED
 
@@ -291,9 +348,9 @@ static bool rgb_matrix_none(effect_params_t *params) {
 }
 
 static void rgb_task_timers(void) {
-#if defined(RGB_MATRIX_KEYREACTIVE_ENABLED) || RGB_MATRIX_TIMEOUT > 0
+#if RGB_MATRIX_TIMEOUT > 0
     uint32_t deltaTime = sync_timer_elapsed32(rgb_timer_buffer);
-#endif // defined(RGB_MATRIX_KEYREACTIVE_ENABLED) || RGB_MATRIX_TIMEOUT > 0
+#endif // RGB_MATRIX_TIMEOUT > 0
     rgb_timer_buffer = sync_timer_read32();
 
     // Update double buffer timers
@@ -302,69 +359,185 @@ static void rgb_task_timers(void) {
         rgb_anykey_timer += deltaTime;
     }
 #endif // RGB_MATRIX_TIMEOUT > 0
+}
 
-    // Update double buffer last hit timers
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
-    uint8_t count = last_hit_buffer.count;
-    for (uint8_t i = 0; i < count; ++i) {
-        if (UINT16_MAX - deltaTime < last_hit_buffer.tick[i]) {
-            last_hit_buffer.count--;
-            continue;
+#    ifdef RGB_MATRIX_KEYREACTIVE_DISTANCE_CACHE
+static void rgb_hit_distance_update(void) {
+    // Rows for hits which were already in the previous snapshot are moved to
+    // their new position, only new hits need their distances calculated.
+    uint8_t  reused = 0;
+    uint16_t skip   = rgb_hit_seq - rgb_hit_tracker_seq;
+    if (skip < g_last_hit_tracker.count) {
+        reused = g_last_hit_tracker.count - skip;
+        if (skip) {
+            memmove(g_last_hit_distance[0], g_last_hit_distance[skip], reused * RGB_MATRIX_LED_COUNT);
+        }
+    }
+    rgb_hit_tracker_seq = rgb_hit_seq;
+
+    for (uint8_t j = reused; j < rgb_hit_count; j++) {
+        for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+            int16_t dx                = g_led_config.point[i].x - g_last_hit_tracker.x[j];
+            int16_t dy                = g_led_config.point[i].y - g_last_hit_tracker.y[j];
+            g_last_hit_distance[j][i] = sqrt16(dx * dx + dy * dy);
         }
-        last_hit_buffer.tick[i] += deltaTime;
     }
+}
+#    endif // RGB_MATRIX_KEYREACTIVE_DISTANCE_CACHE
+
+static void rgb_hit_snapshot(uint32_t now) {
+    // expire the oldest hits first, the ring is ordered by time
+    while (rgb_hit_count && (now - rgb_hit_ring[rgb_hit_head].time) >= RGB_MATRIX_KEYREACTIVE_HIT_LIFETIME) {
+        if (++rgb_hit_head == LED_HITS_TO_REMEMBER) rgb_hit_head = 0;
+        rgb_hit_count--;
+#    ifdef RGB_MATRIX_KEYREACTIVE_DISTANCE_CACHE
+        rgb_hit_seq++;
+#    endif // RGB_MATRIX_KEYREACTIVE_DISTANCE_CACHE
+    }
+
+    // g_last_hit_tracker.count still holds the previous snapshot size until
+    // the distance rows have been carried over
+    uint8_t slot = rgb_hit_head;
+    for (uint8_t j = 0; j < rgb_hit_count; j++) {
+        g_last_hit_tracker.x[j]     = rgb_hit_ring[slot].x;
+        g_last_hit_tracker.y[j]     = rgb_hit_ring[slot].y;
+        g_last_hit_tracker.index[j] = rgb_hit_ring[slot].index;
+        g_last_hit_tracker.tick[j]  = now - rgb_hit_ring[slot].time;
+        if (++slot == LED_HITS_TO_REMEMBER) slot = 0;
+    }
+#    ifdef RGB_MATRIX_KEYREACTIVE_DISTANCE_CACHE
+    rgb_hit_distance_update();
+#    endif // RGB_MATRIX_KEYREACTIVE_DISTANCE_CACHE
+    g_last_hit_tracker.count = rgb_hit_count;
+}
 #endif // RGB_MATRIX_KEYREACTIVE_ENABLED
+
+#ifdef RGB_MATRIX_TARGET_FPS
+static void rgb_frame_stats_update(void) {
+    if (sync_timer_elapsed32(rgb_stats_timer) < 1000) {
+        return;
+    }
+    rgb_stats_timer                = sync_timer_read32();
+    rgb_frame_stats.fps            = rgb_stats_frames;
+    rgb_frame_stats.dropped_frames = rgb_stats_dropped;
+    rgb_frame_stats.frame_time_max = rgb_stats_frame_time_max;
+    rgb_stats_frames               = 0;
+    rgb_stats_dropped              = 0;
+    rgb_stats_frame_time_max       = 0;
+}
+
+// Starts the frame clock from now, so time spent before init or while
+// suspended isn't counted as dropped frames.
+static void rgb_frame_reset(void) {
+    rgb_frame_deadline   = sync_timer_read32();
+    rgb_frame_remainder  = 0;
+    rgb_frame_start      = rgb_frame_deadline;
+    rgb_frame_task_calls = 0;
+    rgb_stats_timer      = rgb_frame_deadline;
+    rgb_stats_frames     = 0;
+    rgb_stats_dropped    = 0;
+}
+
+static bool rgb_frame_due(void) {
+    uint32_t now = sync_timer_read32();
+    if (!timer_expired32(now, rgb_frame_deadline)) {
+        return false;
+    }
+
+    // Advance by exactly one period, carrying the sub-millisecond remainder
+    // so the average frame rate matches RGB_MATRIX_TARGET_FPS.
+    rgb_frame_deadline += RGB_MATRIX_LED_FLUSH_LIMIT;
+    rgb_frame_remainder += 1000 % RGB_MATRIX_TARGET_FPS;
+    if (rgb_frame_remainder >= RGB_MATRIX_TARGET_FPS) {
+        rgb_frame_remainder -= RGB_MATRIX_TARGET_FPS;
+        rgb_frame_deadline++;
+    }
+
+    // More than a whole period behind, drop the missed frames instead of
+    // rendering them back to back.
+    if (timer_expired32(now, rgb_frame_deadline)) {
+        rgb_stats_dropped += TIMER_DIFF_32(now, rgb_frame_deadline) / RGB_MATRIX_LED_FLUSH_LIMIT + 1;
+        rgb_frame_deadline = now + RGB_MATRIX_LED_FLUSH_LIMIT;
+    }
+    return true;
+}
+
+static void rgb_frame_schedule(void) {
+    uint32_t elapsed     = sync_timer_elapsed32(rgb_frame_start);
+    uint16_t task_calls  = rgb_frame_task_calls;
+    rgb_frame_start      = sync_timer_read32();
+    rgb_frame_task_calls = 0;
+
+    // Estimate how many task iterations fit in the render budget from the
+    // scan rate seen during the previous frame, keeping one for the flush.
+    uint32_t budget_calls = elapsed ? ((uint32_t)task_calls * RGB_MATRIX_FRAME_BUDGET_MS) / elapsed : 0;
+    if (budget_calls > 1) {
+        budget_calls--;
+    }
+    if (budget_calls < 1) {
+        budget_calls = 1;
+    }
+
+    uint16_t limit = (RGB_MATRIX_LED_COUNT + budget_calls - 1) / budget_calls;
+    if (limit < 1) {
+        limit = 1;
+    }
+    if (limit > RGB_MATRIX_LED_COUNT) {
+        limit = RGB_MATRIX_LED_COUNT;
+    }
+    g_rgb_led_process_limit           = limit;
+    rgb_frame_stats.led_process_limit = limit;
+}
+
+void rgb_matrix_get_frame_stats(rgb_matrix_frame_stats_t *stats) {
+    *stats = rgb_frame_stats;
 }
+#endif // RGB_MATRIX_TARGET_FPS
 
 static void rgb_task_sync(void) {
     eeconfig_flush_rgb_matrix(false);
     // next task
+#ifdef RGB_MATRIX_TARGET_FPS
+    rgb_frame_stats_update();
+    if (rgb_frame_due()) rgb_task_state = STARTING;
+#else
     if (sync_timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
+#endif // RGB_MATRIX_TARGET_FPS
 }
 
 static void rgb_task_start(void) {
     // reset iter
     rgb_effect_params.iter = 0;
+#ifdef RGB_MATRIX_TARGET_FPS
+    rgb_frame_schedule();
+#endif // RGB_MATRIX_TARGET_FPS
 
     // update double buffers
     g_rgb_timer = rgb_timer_buffer;
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
-    g_last_hit_tracker = last_hit_buffer;
+    rgb_hit_snapshot(rgb_timer_buffer);
 #endif // RGB_MATRIX_KEYREACTIVE_ENABLED
 
     // next task
     rgb_task_state = RENDERING;
 }
 
-static void rgb_task_render(uint8_t effect) {
-    bool rendering         = false;
-    rgb_effect_params.init = (effect != rgb_last_effect) || (rgb_matrix_config.enable != rgb_last_enable);
-    if (rgb_effect_params.flags != rgb_matrix_config.flags) {
-        rgb_effect_params.flags = rgb_matrix_config.flags;
-        rgb_matrix_set_color_all(0, 0, 0);
-    }
+typedef bool (*rgb_matrix_effect_func_t)(effect_params_t *params);
 
-    // each effect can opt to do calculations
-    // and/or request PWM buffer updates.
-    switch (effect) {
-        case RGB_MATRIX_NONE:
-            rendering = rgb_matrix_none(&rgb_effect_params);
-            break;
+// Only effects enabled at compile time are part of the enum, so the table is
+// dense and indexed directly by mode.
+static const rgb_matrix_effect_func_t rgb_matrix_effect_funcs[RGB_MATRIX_EFFECT_MAX] PROGMEM = {
+    [RGB_MATRIX_NONE] = rgb_matrix_none,
 
-// ---------------------------------------------
-// -----Begin rgb effect switch case macros-----
-#define RGB_MATRIX_EFFECT(name, ...)          \
-    case RGB_MATRIX_##name:                   \
-        rendering = name(&rgb_effect_params); \
-        break;
+// ----------------------------------------------
+// -----Begin rgb effect table entry macros-----
+#define RGB_MATRIX_EFFECT(name, ...) [RGB_MATRIX_##name] = name,
 #include "rgb_matrix_effects.inc"
 #undef RGB_MATRIX_EFFECT
 
 #if defined(RGB_MATRIX_CUSTOM_KB) || defined(RGB_MATRIX_CUSTOM_USER)
-#    define RGB_MATRIX_EFFECT(name, ...)          \
-        case RGB_MATRIX_CUSTOM_##name:            \
-            rendering = name(&rgb_effect_params); \
-            break;
+#    define RGB_MATRIX_EFFECT(name, ...) [RGB_MATRIX_CUSTOM_##name] = name,
 #    ifdef RGB_MATRIX_CUSTOM_KB
 #        include "rgb_matrix_kb.inc"
 #    endif
@@ -373,15 +546,34 @@ static void rgb_task_render(uint8_t effect) {
 #    endif
 #    undef RGB_MATRIX_EFFECT
 #endif
-            // -----End rgb effect switch case macros-------
-            // ---------------------------------------------
+    // -----End rgb effect table entry macros-------
+    // ----------------------------------------------
+};
 
-        // Factory default magic value
-        case UINT8_MAX: {
-            rgb_matrix_test();
-            rgb_task_state = FLUSHING;
-        }
-            return;
+static void rgb_task_render(uint8_t effect) {
+    bool rendering         = false;
+    rgb_effect_params.init = (effect != rgb_last_effect) || (rgb_matrix_config.enable != rgb_last_enable);
+    if (rgb_effect_params.flags != rgb_matrix_config.flags) {
+        rgb_effect_params.flags = rgb_matrix_config.flags;
+        rgb_matrix_set_color_all(0, 0, 0);
+    }
+
+    // Factory default magic value
+    if (effect == UINT8_MAX) {
+        rgb_matrix_test();
+        rgb_task_state = FLUSHING;
+        return;
+    }
+
+    if (rgb_effect_params.init && rgb_effect_params.iter == 0) {
+        memset(&rgb_effect_state, 0, sizeof(rgb_effect_state));
+    }
+
+    // each effect can opt to do calculations
+    // and/or request PWM buffer updates.
+    if (effect < RGB_MATRIX_EFFECT_MAX) {
+        rgb_matrix_effect_func_t effect_func = (rgb_matrix_effect_func_t)pgm_read_ptr(&rgb_matrix_effect_funcs[effect]);
+        rendering                            = effect_func(&rgb_effect_params);
     }
 
     rgb_effect_params.iter++;
@@ -404,12 +596,27 @@ static void rgb_task_flush(uint8_t effect) {
     // update pwm buffers
     rgb_matrix_update_pwm_buffers();
 
+#ifdef RGB_MATRIX_TARGET_FPS
+    uint32_t frame_time               = sync_timer_elapsed32(rgb_frame_start);
+    rgb_frame_stats.frame_time        = frame_time > UINT8_MAX ? UINT8_MAX : frame_time;
+    rgb_frame_stats.render_iterations = rgb_effect_params.iter;
+    if (rgb_frame_stats.frame_time > rgb_stats_frame_time_max) {
+        rgb_stats_frame_time_max = rgb_frame_stats.frame_time;
+    }
+    rgb_stats_frames++;
+#endif // RGB_MATRIX_TARGET_FPS
+
     // next task
     rgb_task_state = SYNCING;
 }
 
 void rgb_matrix_task(void) {
     rgb_task_timers();
+#ifdef RGB_MATRIX_TARGET_FPS
+    if (rgb_frame_task_calls < UINT16_MAX) {
+        rgb_frame_task_calls++;
+    }
+#endif // RGB_MATRIX_TARGET_FPS
 
     // Ideally we would also stop sending zeros to the LED driver PWM buffers
     // while suspended and just do a software shutdown. This is a cheap hack for now.
@@ -433,6 +640,10 @@ void rgb_matrix_task(void) {
             }
             break;
         case FLUSHING:
+#if defined(WS2812)
+            // the previous frame is still being sent, try again next iteration
+            if (ws2812_busy()) break;
+#endif
             rgb_task_flush(effect);
             break;
         case SYNCING:
@@ -459,7 +670,7 @@ void rgb_matrix_indicators_advanced(effect_params_t *params) {
      * and not sure which would be better. Otherwise, this should be called from
      * rgb_task_render, right before the iter++ line.
      */
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < RGB_MATRIX_LED_COUNT
+#if defined(RGB_MATRIX_TARGET_FPS) || (defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < RGB_MATRIX_LED_COUNT)
     uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * (params->iter - 1);
     uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;
     if (max > RGB_MATRIX_LED_COUNT) max = RGB_MATRIX_LED_COUNT;
@@ -487,10 +698,8 @@ void rgb_matrix_init(void) {
         g_last_hit_tracker.tick[i] = UINT16_MAX;
     }
 
-    last_hit_buffer.count = 0;
-    for (uint8_t i = 0; i < LED_HITS_TO_REMEMBER; ++i) {
-        last_hit_buffer.tick[i] = UINT16_MAX;
-    }
+    rgb_hit_head  = 0;
+    rgb_hit_count = 0;
 #endif // RGB_MATRIX_KEYREACTIVE_ENABLED
 
     if (!eeconfig_is_enabled()) {
@@ -505,6 +714,10 @@ void rgb_matrix_init(void) {
         eeconfig_update_rgb_matrix_default();
     }
     eeconfig_debug_rgb_matrix(); // display current eeprom values
+
+#ifdef RGB_MATRIX_TARGET_FPS
+    rgb_frame_reset();
+#endif // RGB_MATRIX_TARGET_FPS
 }
 
 void rgb_matrix_set_suspend_state(bool state) {
@@ -515,6 +728,11 @@ void rgb_matrix_set_suspend_state(bool state) {
     }
     suspend_state = state;
 #endif
+#ifdef RGB_MATRIX_TARGET_FPS
+    if (!state) {
+        rgb_frame_reset();
+    }
+#endif // RGB_MATRIX_TARGET_FPS
 }
 
 bool rgb_matrix_get_suspend_state(void) {
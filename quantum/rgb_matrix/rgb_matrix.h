@@ -42,6 +42,25 @@
 #    include "ws2812.h"
 #endif
 
+#if defined(RGB_MATRIX_TARGET_FPS)
+#    if defined(RGB_MATRIX_LED_FLUSH_LIMIT) || defined(RGB_MATRIX_LED_PROCESS_LIMIT)
+#        error "RGB_MATRIX_LED_FLUSH_LIMIT and RGB_MATRIX_LED_PROCESS_LIMIT are calculated by the frame scheduler when RGB_MATRIX_TARGET_FPS is defined"
+#    endif
+#    if RGB_MATRIX_TARGET_FPS < 1 || RGB_MATRIX_TARGET_FPS > 200
+#        error "RGB_MATRIX_TARGET_FPS must be between 1 and 200"
+#    endif
+#    define RGB_MATRIX_LED_FLUSH_LIMIT (1000 / RGB_MATRIX_TARGET_FPS)
+// Number of milliseconds of each frame that rendering may be spread across
+#    ifndef RGB_MATRIX_FRAME_BUDGET_MS
+#        define RGB_MATRIX_FRAME_BUDGET_MS (RGB_MATRIX_LED_FLUSH_LIMIT / 2)
+#    endif
+#    if RGB_MATRIX_FRAME_BUDGET_MS < 1 || RGB_MATRIX_FRAME_BUDGET_MS > RGB_MATRIX_LED_FLUSH_LIMIT
+#        error "RGB_MATRIX_FRAME_BUDGET_MS must be between 1 and the frame period (1000 / RGB_MATRIX_TARGET_FPS)"
+#    endif
+// Chosen per frame by the scheduler, constant for the duration of a frame
+#    define RGB_MATRIX_LED_PROCESS_LIMIT g_rgb_led_process_limit
+#endif
+
 #ifndef RGB_MATRIX_LED_FLUSH_LIMIT
 #    define RGB_MATRIX_LED_FLUSH_LIMIT 16
 #endif
@@ -50,7 +69,7 @@
 #    define RGB_MATRIX_LED_PROCESS_LIMIT (RGB_MATRIX_LED_COUNT + 4) / 5
 #endif
 
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < RGB_MATRIX_LED_COUNT
+#if defined(RGB_MATRIX_TARGET_FPS) || (defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < RGB_MATRIX_LED_COUNT)
 #    if defined(RGB_MATRIX_SPLIT)
 #        define RGB_MATRIX_USE_LIMITS(min, max)                                                   \
             uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * params->iter;                            \
@@ -184,6 +203,9 @@ void        rgb_matrix_decrease_speed_noeeprom(void);
 led_flags_t rgb_matrix_get_flags(void);
 void        rgb_matrix_set_flags(led_flags_t flags);
 void        rgb_matrix_set_flags_noeeprom(led_flags_t flags);
+#ifdef RGB_MATRIX_TARGET_FPS
+void rgb_matrix_get_frame_stats(rgb_matrix_frame_stats_t *stats);
+#endif
 
 #ifndef RGBLIGHT_ENABLE
 #    define eeconfig_update_rgblight_current eeconfig_update_rgb_matrix
@@ -258,8 +280,14 @@ extern rgb_config_t rgb_matrix_config;
 
 extern uint32_t     g_rgb_timer;
 extern led_config_t g_led_config;
+#ifdef RGB_MATRIX_TARGET_FPS
+extern uint8_t g_rgb_led_process_limit;
+#endif
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 extern last_hit_t g_last_hit_tracker;
+#    ifdef RGB_MATRIX_KEYREACTIVE_DISTANCE_CACHE
+extern uint8_t g_last_hit_distance[LED_HITS_TO_REMEMBER][RGB_MATRIX_LED_COUNT];
+#    endif
 #endif
 #ifdef RGB_MATRIX_FRAMEBUFFER_EFFECTS
 extern uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS];
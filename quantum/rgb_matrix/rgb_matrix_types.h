@@ -39,6 +39,13 @@
 #    define LED_HITS_TO_REMEMBER 8
 #endif // LED_HITS_TO_REMEMBER
 
+// Milliseconds after which a hit is dropped from the tracker
+#ifndef RGB_MATRIX_KEYREACTIVE_HIT_LIFETIME
+#    define RGB_MATRIX_KEYREACTIVE_HIT_LIFETIME UINT16_MAX
+#elif RGB_MATRIX_KEYREACTIVE_HIT_LIFETIME > UINT16_MAX
+#    error "RGB_MATRIX_KEYREACTIVE_HIT_LIFETIME must not be greater than UINT16_MAX"
+#endif
+
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 typedef struct PACKED {
     uint8_t  count;
@@ -51,6 +58,15 @@ typedef struct PACKED {
 
 typedef enum rgb_task_states { STARTING, RENDERING, FLUSHING, SYNCING } rgb_task_states;
 
+typedef struct {
+    uint16_t fps;               // frames flushed during the last second
+    uint16_t dropped_frames;    // frames skipped because rendering overran the frame period, during the last second
+    uint8_t  frame_time;        // milliseconds from the start of the last frame until it was flushed
+    uint8_t  frame_time_max;    // longest frame time during the last second
+    uint8_t  render_iterations; // task iterations the last frame was rendered across
+    uint8_t  led_process_limit; // LEDs rendered per task iteration for the current frame
+} rgb_matrix_frame_stats_t;
+
 typedef uint8_t led_flags_t;
 
 typedef struct PACKED {
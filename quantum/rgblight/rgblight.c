@@ -118,6 +118,9 @@ static bool pre_suspend_enabled;
 
 #ifdef RGBLIGHT_USE_TIMER
 animation_status_t animation_status = {};
+#    if defined(RGBLIGHT_SPLIT) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
+static uint16_t animation_interval; // time between steps of the running effect
+#    endif
 #endif
 
 #ifndef LED_ARRAY
@@ -961,40 +964,67 @@ void rgblight_clear_change_flags(void) {
 }
 
 void rgblight_get_syncinfo(rgblight_syncinfo_t *syncinfo) {
-    syncinfo->config = rgblight_config;
-    syncinfo->status = rgblight_status;
+    syncinfo->change_flags  = rgblight_status.change_flags;
+    syncinfo->enable        = rgblight_config.enable;
+    syncinfo->mode          = rgblight_config.mode;
+    syncinfo->hue           = rgblight_config.hue;
+    syncinfo->sat           = rgblight_config.sat;
+    syncinfo->val           = rgblight_config.val;
+    syncinfo->timer_enabled = rgblight_status.timer_enabled;
+#    ifdef RGBLIGHT_USE_TIMER
+    syncinfo->anim_timer = animation_status.last_timer;
+    syncinfo->anim_pos   = animation_status.pos16;
+#    endif
+#    ifdef RGBLIGHT_LAYERS
+    syncinfo->enabled_layer_mask = rgblight_status.enabled_layer_mask;
+#    endif
 }
 
 /* for split keyboard slave side */
 void rgblight_update_sync(rgblight_syncinfo_t *syncinfo, bool write_to_eeprom) {
 #    ifdef RGBLIGHT_LAYERS
-    if (syncinfo->status.change_flags & RGBLIGHT_STATUS_CHANGE_LAYERS) {
-        rgblight_status.enabled_layer_mask = syncinfo->status.enabled_layer_mask;
+    if (syncinfo->change_flags & RGBLIGHT_STATUS_CHANGE_LAYERS) {
+        rgblight_status.enabled_layer_mask = syncinfo->enabled_layer_mask;
     }
 #    endif
-    if (syncinfo->status.change_flags & RGBLIGHT_STATUS_CHANGE_MODE) {
-        if (syncinfo->config.enable) {
-            rgblight_config.enable = 1; // == rgblight_enable_noeeprom();
-            rgblight_mode_eeprom_helper(syncinfo->config.mode, write_to_eeprom);
-        } else {
+    // The master periodically resends its full state, so only act on what actually differs
+    if (syncinfo->change_flags & RGBLIGHT_STATUS_CHANGE_MODE) {
+        if (syncinfo->enable) {
+            if (!rgblight_config.enable || rgblight_config.mode != syncinfo->mode) {
+                rgblight_config.enable = 1; // == rgblight_enable_noeeprom();
+                rgblight_mode_eeprom_helper(syncinfo->mode, write_to_eeprom);
+            }
+        } else if (rgblight_config.enable) {
             rgblight_disable_noeeprom();
         }
     }
-    if (syncinfo->status.change_flags & RGBLIGHT_STATUS_CHANGE_HSVS) {
-        rgblight_sethsv_eeprom_helper(syncinfo->config.hue, syncinfo->config.sat, syncinfo->config.val, write_to_eeprom);
-        // rgblight_config.speed = config->speed; // NEED???
+    if (syncinfo->change_flags & RGBLIGHT_STATUS_CHANGE_HSVS) {
+        if (rgblight_config.hue != syncinfo->hue || rgblight_config.sat != syncinfo->sat || rgblight_config.val != syncinfo->val) {
+            rgblight_sethsv_eeprom_helper(syncinfo->hue, syncinfo->sat, syncinfo->val, write_to_eeprom);
+        }
     }
 #    ifdef RGBLIGHT_USE_TIMER
-    if (syncinfo->status.change_flags & RGBLIGHT_STATUS_CHANGE_TIMER) {
-        if (syncinfo->status.timer_enabled) {
+    if (syncinfo->change_flags & RGBLIGHT_STATUS_CHANGE_TIMER) {
+        if (syncinfo->timer_enabled && !rgblight_status.timer_enabled) {
             rgblight_timer_enable();
-        } else {
+        } else if (!syncinfo->timer_enabled && rgblight_status.timer_enabled) {
             rgblight_timer_disable();
         }
     }
 #        ifndef RGBLIGHT_SPLIT_NO_ANIMATION_SYNC
-    if (syncinfo->status.change_flags & RGBLIGHT_STATUS_ANIMATION_TICK) {
-        animation_status.restart = true;
+    if (syncinfo->change_flags & RGBLIGHT_STATUS_ANIMATION_TICK) {
+        // Pick the animation up where the master has it, so both halves step on
+        // the same sync_timer deadlines, even after the slave was reset. The
+        // snapshot can be a step old by the time it arrives, so a slave at most
+        // one step ahead of it keeps its own position rather than stepping back.
+        uint16_t ahead        = animation_status.last_timer - syncinfo->anim_timer;
+        bool     one_step_on  = (int16_t)ahead > 0 && ahead <= animation_interval;
+        bool     out_of_phase = ahead != 0 || animation_status.pos16 != syncinfo->anim_pos;
+        if (animation_status.restart || (out_of_phase && !one_step_on)) {
+            animation_status.restart    = false;
+            animation_status.last_timer = syncinfo->anim_timer;
+            animation_status.pos16      = syncinfo->anim_pos;
+        }
     }
 #        endif /* RGBLIGHT_SPLIT_NO_ANIMATION_SYNC */
 #    endif     /* RGBLIGHT_USE_TIMER */
@@ -1120,35 +1150,28 @@ void rgblight_task(void) {
             interval_time = get_interval_time(&RGBLED_TWINKLE_INTERVALS[delta % 3], 5, 30);
             effect_func   = (effect_func_t)rgblight_effect_twinkle;
         }
+#    endif
+#    if defined(RGBLIGHT_SPLIT) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
+        animation_interval = interval_time;
 #    endif
         if (animation_status.restart) {
             animation_status.restart    = false;
             animation_status.last_timer = sync_timer_read();
             animation_status.pos16      = 0; // restart signal to local each effect
+#    if defined(RGBLIGHT_SPLIT) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
+            // the slave takes over this step deadline and position from the master
+            RGBLIGHT_SPLIT_ANIMATION_TICK;
+#    endif
         }
         uint16_t now = sync_timer_read();
-        if (timer_expired(now, animation_status.last_timer)) {
-#    if defined(RGBLIGHT_SPLIT) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
-            static uint16_t report_last_timer = 0;
-            static bool     tick_flag         = false;
-            uint16_t        oldpos16;
-            if (tick_flag) {
-                tick_flag = false;
-                if (timer_expired(now, report_last_timer)) {
-                    report_last_timer += 30000;
-                    dprintf("rgblight animation tick report to slave\n");
-                    RGBLIGHT_SPLIT_ANIMATION_TICK;
-                }
-            }
-            oldpos16 = animation_status.pos16;
+        if (timer_expired(now, animation_status.last_timer)
+#    ifdef RGBLIGHT_WS2812
+            // the previous frame is still being sent, step the animation next iteration
+            && !ws2812_busy()
 #    endif
+        ) {
             animation_status.last_timer += interval_time;
             effect_func(&animation_status);
-#    if defined(RGBLIGHT_SPLIT) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
-            if (animation_status.pos16 == 0 && oldpos16 != 0) {
-                tick_flag = true;
-            }
-#    endif
         }
     }
 
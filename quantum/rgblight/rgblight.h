@@ -397,12 +397,27 @@ void rgblight_timer_toggle(void);
 #    define RGBLIGHT_STATUS_CHANGE_MODE (1 << 0)
 #    define RGBLIGHT_STATUS_CHANGE_HSVS (1 << 1)
 #    define RGBLIGHT_STATUS_CHANGE_TIMER (1 << 2)
-#    define RGBLIGHT_STATUS_ANIMATION_TICK (1 << 3)
+#    define RGBLIGHT_STATUS_ANIMATION_TICK (1 << 3) /* animation step in anim_timer and anim_pos */
 #    define RGBLIGHT_STATUS_CHANGE_LAYERS (1 << 4)
+#    define RGBLIGHT_STATUS_CHANGE_ALL (RGBLIGHT_STATUS_CHANGE_MODE | RGBLIGHT_STATUS_CHANGE_HSVS | RGBLIGHT_STATUS_CHANGE_TIMER | RGBLIGHT_STATUS_ANIMATION_TICK | RGBLIGHT_STATUS_CHANGE_LAYERS)
 
+/*
+ * Delta sent from master to slave. Only the sections named in change_flags
+ * are meaningful, and applying the same delta twice has no visible effect.
+ */
 typedef struct _rgblight_syncinfo_t {
-    rgblight_config_t config;
-    rgblight_status_t status;
+    uint8_t  change_flags;
+    bool     enable : 1;
+    uint8_t  mode : 7;
+    uint8_t  hue;
+    uint8_t  sat;
+    uint8_t  val;
+    bool     timer_enabled;
+    uint16_t anim_timer; /* sync_timer deadline of the next animation step */
+    uint16_t anim_pos;   /* animation position that step starts from */
+#    ifdef RGBLIGHT_LAYERS
+    rgblight_layer_mask_t enabled_layer_mask;
+#    endif
 } rgblight_syncinfo_t;
 
 /* for split keyboard master side */
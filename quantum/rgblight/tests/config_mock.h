@@ -0,0 +1,10 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#define MATRIX_ROWS 1
+#define MATRIX_COLS 1
+
+#define RGBLED_NUM 4
+#define RGBLIGHT_SPLIT
+#define RGBLIGHT_EFFECT_BREATHING
@@ -0,0 +1,123 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+extern "C" {
+#include "rgblight.h"
+#include "timer.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+
+bool eeconfig_is_enabled(void) {
+    return true;
+}
+
+void eeconfig_init(void) {}
+
+void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds) {}
+}
+
+class RgblightSplit : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        set_time(0);
+        reset();
+        rgblight_enable_noeeprom();
+        rgblight_mode_noeeprom(RGBLIGHT_MODE_BREATHING);
+        rgblight_clear_change_flags();
+    }
+
+    // Both halves share this process, so a reset slave is the same rgblight starting over
+    void reset(void) {
+        is_rgblight_initialized = false;
+        memset(&animation_status, 0, sizeof(animation_status));
+        rgblight_init();
+    }
+
+    void run(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; ++i) {
+            advance_time(1);
+            rgblight_task();
+        }
+    }
+};
+
+TEST_F(RgblightSplit, ResyncRestoresAnimationPhase) {
+    run(1000);
+
+    // What the master's periodic refresh carries
+    rgblight_syncinfo_t sync;
+    rgblight_get_syncinfo(&sync);
+    sync.change_flags        = RGBLIGHT_STATUS_CHANGE_ALL;
+    uint32_t now             = timer_read32();
+    uint16_t next_step       = animation_status.last_timer;
+    uint16_t master_position = animation_status.pos16;
+    ASSERT_NE(master_position, 0);
+
+    // The master's next few frames
+    LED_TYPE master_leds[RGBLED_NUM];
+    run(100);
+    memcpy(master_leds, led, sizeof(master_leds));
+
+    // The slave comes back up at the same moment with its own idea of the animation
+    set_time(now);
+    reset();
+    rgblight_update_sync(&sync, false);
+    EXPECT_EQ(animation_status.last_timer, next_step);
+    EXPECT_EQ(animation_status.pos16, master_position);
+
+    run(100);
+    EXPECT_EQ(memcmp(led, master_leds, sizeof(master_leds)), 0);
+}
+
+TEST_F(RgblightSplit, ResyncInPhaseDoesNotRestart) {
+    run(1000);
+    rgblight_syncinfo_t sync;
+    rgblight_get_syncinfo(&sync);
+    sync.change_flags = RGBLIGHT_STATUS_CHANGE_ALL;
+
+    animation_status_t before = animation_status;
+    rgblight_update_sync(&sync, false);
+    EXPECT_EQ(memcmp(&animation_status, &before, sizeof(before)), 0);
+}
+
+TEST_F(RgblightSplit, ResyncDoesNotStepSlaveBack) {
+    run(1000);
+    rgblight_syncinfo_t sync;
+    rgblight_get_syncinfo(&sync);
+    sync.change_flags = RGBLIGHT_STATUS_CHANGE_ALL;
+
+    // The slave takes its next step before the master's snapshot arrives
+    uint16_t next_step = animation_status.last_timer;
+    while (animation_status.last_timer == next_step) {
+        run(1);
+    }
+    animation_status_t before = animation_status;
+    rgblight_update_sync(&sync, false);
+    EXPECT_EQ(memcmp(&animation_status, &before, sizeof(before)), 0);
+}
+
+TEST_F(RgblightSplit, ResyncCorrectsSlaveOutOfStep) {
+    run(1000);
+    rgblight_syncinfo_t sync;
+    rgblight_get_syncinfo(&sync);
+    sync.change_flags = RGBLIGHT_STATUS_CHANGE_ALL;
+
+    // Several steps ahead of the master
+    animation_status_t before = animation_status;
+    run(500);
+    rgblight_update_sync(&sync, false);
+    EXPECT_EQ(animation_status.last_timer, sync.anim_timer);
+    EXPECT_EQ(animation_status.pos16, sync.anim_pos);
+
+    // Behind the master
+    animation_status = before;
+    animation_status.last_timer -= 100;
+    rgblight_update_sync(&sync, false);
+    EXPECT_EQ(animation_status.last_timer, sync.anim_timer);
+    EXPECT_EQ(animation_status.pos16, sync.anim_pos);
+}
@@ -0,0 +1,9 @@
+rgblight_split_DEFS := -DRGBLIGHT_ENABLE -DNO_DEBUG
+rgblight_split_CONFIG := $(QUANTUM_PATH)/rgblight/tests/config_mock.h
+rgblight_split_INC := $(QUANTUM_PATH)/rgblight
+
+rgblight_split_SRC := \
+	$(QUANTUM_PATH)/rgblight/tests/rgblight_split_tests.cpp \
+	$(QUANTUM_PATH)/rgblight/rgblight.c \
+	$(QUANTUM_PATH)/color.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
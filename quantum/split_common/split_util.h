@@ -17,4 +17,9 @@ bool is_transport_connected(void);
 
 void split_watchdog_update(bool done);
 void split_watchdog_task(void);
-bool split_watchdog_check(void);
\ No newline at end of file
+bool split_watchdog_check(void);
+
+#ifdef SPLIT_USER_STATE_SIZE
+void        split_user_state_set(const void *state, size_t size);
+const void *split_user_state_get(void);
+#endif // SPLIT_USER_STATE_SIZE
@@ -0,0 +1,7 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+// Large enough that the mirrored master matrix is worth sending as a delta
+#define MATRIX_ROWS 16
+#define MATRIX_COLS 32
@@ -0,0 +1,32 @@
+split_transport_DEFS := -DSPLIT_KEYBOARD -DDISABLE_SYNC_TIMER -DNO_DEBUG -DSPLIT_TRANSACTION_IDS_USER=USER_STREAM -DSPLIT_USER_STATE_SIZE=4
+split_transport_CONFIG := $(QUANTUM_PATH)/split_common/tests/config_mock.h
+split_transport_INC := $(QUANTUM_PATH)/split_common
+
+split_transport_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/split_transport_tests.cpp \
+	$(QUANTUM_PATH)/split_common/transactions.c \
+	$(QUANTUM_PATH)/crc.c \
+	$(PLATFORM_PATH)/synchronization_util.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/split_loopback_transport.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
+
+split_transport_batch_DEFS := $(split_transport_DEFS) -DSPLIT_TRANSPORT_BATCH
+split_transport_batch_CONFIG := $(split_transport_CONFIG)
+split_transport_batch_INC := $(split_transport_INC)
+split_transport_batch_SRC := $(split_transport_SRC)
+
+split_transport_events_DEFS := $(split_transport_DEFS) -DSPLIT_MATRIX_EVENTS_ENABLE
+split_transport_events_CONFIG := $(split_transport_CONFIG)
+split_transport_events_INC := $(split_transport_INC)
+split_transport_events_SRC := $(split_transport_SRC)
+
+# User state just under the size where the old delta encoding started to pay off
+split_transport_delta_DEFS := $(filter-out -DSPLIT_USER_STATE_SIZE=%,$(split_transport_DEFS)) -DSPLIT_USER_STATE_SIZE=8 -DSPLIT_TRANSPORT_DELTA -DSPLIT_TRANSPORT_MIRROR
+split_transport_delta_CONFIG := $(QUANTUM_PATH)/split_common/tests/config_mock_mirror.h
+split_transport_delta_INC := $(split_transport_INC)
+split_transport_delta_SRC := $(split_transport_SRC)
+
+split_transport_caps_word_DEFS := $(split_transport_DEFS) -DCAPS_WORD_ENABLE -DSPLIT_CAPS_WORD_ENABLE
+split_transport_caps_word_CONFIG := $(split_transport_CONFIG)
+split_transport_caps_word_INC := $(split_transport_INC)
+split_transport_caps_word_SRC := $(split_transport_SRC)
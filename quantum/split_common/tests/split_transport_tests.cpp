@@ -0,0 +1,562 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+extern "C" {
+#include "transport.h"
+#include "transactions.h"
+#include "split_loopback_transport.h"
+#include "split_util.h"
+#include "timer.h"
+#ifdef CAPS_WORD_ENABLE
+#    include "caps_word.h"
+#endif // CAPS_WORD_ENABLE
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+
+bool is_transport_connected(void) {
+    return true;
+}
+}
+
+#ifndef FORCED_SYNC_THROTTLE_MS
+#    define FORCED_SYNC_THROTTLE_MS 100
+#endif // FORCED_SYNC_THROTTLE_MS
+
+#define SLAVE_ROWS ((MATRIX_ROWS) / 2)
+
+class SplitTransport : public ::testing::Test {
+   protected:
+    matrix_row_t slave_scan[SLAVE_ROWS];   // what the slave half reads from its switches
+    matrix_row_t received[SLAVE_ROWS];     // the master's copy of the slave half
+    matrix_row_t master_scan[SLAVE_ROWS];  // the master half, only used for mirroring
+    matrix_row_t mirrored[SLAVE_ROWS];     // the slave's copy of the master half
+    uint32_t     key_state = 0x12345678;
+
+    void SetUp() override {
+        split_loopback_clear_faults();
+        memset(slave_scan, 0, sizeof(slave_scan));
+        memset(received, 0, sizeof(received));
+        memset(master_scan, 0, sizeof(master_scan));
+        memset(mirrored, 0, sizeof(mirrored));
+        // Anything left over from an earlier test is flushed by a few clean scans
+        for (int i = 0; i < 10; ++i) {
+            scan();
+        }
+        split_loopback_clear_stats();
+        split_link_stats_clear();
+    }
+
+    void slave_task(void) {
+        transport_slave(mirrored, slave_scan);
+    }
+
+    bool master_task(void) {
+        return transport_master(master_scan, received);
+    }
+
+    bool scan(void) {
+        advance_time(1);
+        slave_task();
+        return master_task();
+    }
+
+    bool in_sync(void) {
+        return memcmp(slave_scan, received, sizeof(received)) == 0;
+    }
+
+    void change_random_key(void) {
+        key_state ^= key_state << 13;
+        key_state ^= key_state >> 17;
+        key_state ^= key_state << 5;
+        slave_scan[key_state % SLAVE_ROWS] ^= MATRIX_ROW_SHIFTER << ((key_state >> 8) % MATRIX_COLS);
+    }
+};
+
+TEST_F(SplitTransport, CleanLinkSyncsInOneScan) {
+    slave_scan[0] = 0b0101;
+    slave_scan[1] = 0b1000;
+    EXPECT_TRUE(scan());
+    EXPECT_TRUE(in_sync());
+    EXPECT_EQ(split_loopback_get_stats()->failures, 0);
+}
+
+TEST_F(SplitTransport, CorruptionKeepsLastGoodMatrix) {
+    slave_scan[0] = 0b0011;
+    ASSERT_TRUE(scan());
+    matrix_row_t last_good[SLAVE_ROWS];
+    memcpy(last_good, received, sizeof(last_good));
+
+    split_loopback_faults_t faults = {.bit_error_rate = UINT16_MAX, .seed = 1};
+    split_loopback_set_faults(&faults);
+    slave_scan[0] = 0b1100;
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_FALSE(scan());
+        EXPECT_EQ(memcmp(received, last_good, sizeof(received)), 0);
+    }
+    EXPECT_GT(split_loopback_get_stats()->bit_errors, 0);
+
+    split_loopback_clear_faults();
+    EXPECT_TRUE(scan());
+    EXPECT_TRUE(in_sync());
+}
+
+TEST_F(SplitTransport, DroppedTransactionsAreRetried) {
+    split_loopback_faults_t faults = {.drop_rate = UINT16_MAX, .seed = 1};
+    split_loopback_set_faults(&faults);
+    slave_scan[1] = 0b0110;
+    EXPECT_FALSE(scan());
+    EXPECT_FALSE(in_sync());
+    // A clean link gets ten attempts before the scan gives up
+    EXPECT_EQ(split_loopback_get_stats()->transactions, 10);
+    EXPECT_EQ(split_loopback_get_stats()->failures, 10);
+
+    split_loopback_clear_faults();
+    EXPECT_TRUE(scan());
+    EXPECT_TRUE(in_sync());
+}
+
+TEST_F(SplitTransport, IdleLinkTransactionsPerScan) {
+    const uint32_t scans = 10 * FORCED_SYNC_THROTTLE_MS;
+    for (uint32_t i = 0; i < scans; ++i) {
+        ASSERT_TRUE(scan());
+    }
+    uint32_t transactions = split_loopback_get_stats()->transactions;
+    RecordProperty("transactions_per_idle_scan", std::to_string((double)transactions / scans));
+#ifdef SPLIT_TRANSPORT_BATCH
+    EXPECT_EQ(transactions, scans);
+#else
+    // Items resent every FORCED_SYNC_THROTTLE_MS even when nothing changed
+    uint32_t forced = 0;
+#    ifndef SPLIT_MATRIX_EVENTS_ENABLE
+    forced++; // the slave matrix itself
+#    endif
+#    ifdef SPLIT_TRANSPORT_MIRROR
+    forced++;
+#    endif
+#    ifdef SPLIT_USER_STATE_SIZE
+    forced++;
+#    endif
+#    ifdef SPLIT_CAPS_WORD_ENABLE
+    forced++;
+#    endif
+    // A checksum or event read every scan, plus the forced syncs
+    EXPECT_LE(transactions, scans + forced * (scans / FORCED_SYNC_THROTTLE_MS + 1));
+#endif
+}
+
+TEST_F(SplitTransport, SyncRateWithBitErrors) {
+    // Roughly one byte in two hundred damaged on the wire
+    split_loopback_faults_t faults = {.latency_ms = 1, .bit_error_rate = 328, .seed = 0xC0FFEE};
+    split_loopback_set_faults(&faults);
+
+    const int scans  = 1000;
+    int       synced = 0;
+    for (int i = 0; i < scans; ++i) {
+        if (i % 5 == 0) {
+            change_random_key();
+        }
+        scan();
+        synced += in_sync();
+    }
+    RecordProperty("sync_rate_percent", synced * 100 / scans);
+    RecordProperty("bit_errors", split_loopback_get_stats()->bit_errors);
+    EXPECT_GT(split_loopback_get_stats()->bit_errors, 0);
+    EXPECT_GE(synced * 100 / scans, 90);
+}
+
+TEST_F(SplitTransport, RecoveryTimeAfterOutage) {
+    split_loopback_faults_t faults = {.latency_ms = 1, .drop_rate = UINT16_MAX, .seed = 1};
+    split_loopback_set_faults(&faults);
+    // Keys keep changing while the link is down, more than any event log can hold
+    for (int i = 0; i < 50; ++i) {
+        change_random_key();
+        scan();
+    }
+
+    faults.drop_rate = 0;
+    split_loopback_set_faults(&faults);
+    uint32_t start = timer_read32();
+    int      scans = 0;
+    while (scans < 100) {
+        ++scans;
+        if (scan() && in_sync()) break;
+    }
+    RecordProperty("recovery_scans", scans);
+    RecordProperty("recovery_ms", timer_elapsed32(start));
+    EXPECT_EQ(scans, 1);
+    EXPECT_LT(timer_elapsed32(start), FORCED_SYNC_THROTTLE_MS);
+}
+
+TEST_F(SplitTransport, LinkStatsOnCleanLink) {
+    split_loopback_faults_t faults = {.latency_ms = 1};
+    split_loopback_set_faults(&faults);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(scan());
+    }
+    const split_link_stats_t *stats = split_link_stats_get();
+    RecordProperty("round_trip_us", stats->round_trip_us);
+    EXPECT_EQ(stats->error_rate, 0);
+    EXPECT_EQ(stats->failures, 0);
+    EXPECT_EQ(stats->retries[0], stats->attempts);
+    // Mostly a single 1ms transaction per scan
+    EXPECT_GE(stats->round_trip_us, 900);
+    EXPECT_LE(stats->round_trip_us, 2000);
+}
+
+TEST_F(SplitTransport, LinkStatsPackedForHost) {
+    split_loopback_faults_t faults = {.latency_ms = 1, .drop_rate = 8192, .seed = 0xF1A4};
+    split_loopback_set_faults(&faults);
+    for (int i = 0; i < 100; ++i) {
+        scan();
+    }
+    const split_link_stats_t *stats = split_link_stats_get();
+
+    // Room for all but the last counter
+    uint8_t buffer[3 + 4 * (2 + SPLIT_LINK_RETRY_BUCKETS) + 3];
+    EXPECT_EQ(split_link_stats_pack(buffer, sizeof(buffer)), sizeof(buffer) - 3);
+    EXPECT_EQ(buffer[0], stats->error_rate);
+    EXPECT_EQ(buffer[1] << 8 | buffer[2], stats->round_trip_us);
+    EXPECT_EQ((uint32_t)buffer[3] << 24 | buffer[4] << 16 | buffer[5] << 8 | buffer[6], stats->attempts);
+    EXPECT_EQ((uint32_t)buffer[7] << 24 | buffer[8] << 16 | buffer[9] << 8 | buffer[10], stats->failures);
+    EXPECT_GT(stats->failures, 0);
+
+    // Reading the stats leaves them as they were
+    split_link_stats_t before = *stats;
+    split_link_stats_get();
+    EXPECT_EQ(memcmp(split_link_stats_get(), &before, sizeof(before)), 0);
+}
+
+TEST_F(SplitTransport, OccasionalLossIsRetried) {
+    // One in eight frames lost each way
+    split_loopback_faults_t faults = {.latency_ms = 1, .drop_rate = 8192, .seed = 0xF1A4};
+    split_loopback_set_faults(&faults);
+
+    const int scans  = 1000;
+    int       synced = 0;
+    for (int i = 0; i < scans; ++i) {
+        if (i % 5 == 0) {
+            change_random_key();
+        }
+        scan();
+        synced += in_sync();
+    }
+    const split_link_stats_t *stats = split_link_stats_get();
+    RecordProperty("sync_rate_percent", synced * 100 / scans);
+    RecordProperty("error_rate", stats->error_rate);
+    for (int i = 0; i < SPLIT_LINK_RETRY_BUCKETS; ++i) {
+        RecordProperty("retries_" + std::to_string(i), stats->retries[i]);
+    }
+    EXPECT_GT(stats->retries[1], 0);
+    EXPECT_GE(synced * 100 / scans, 95);
+}
+
+TEST_F(SplitTransport, FlakyLinkDoesNotStallScans) {
+    // Half the frames lost each way, every transaction costing 1ms like a serial timeout would
+    split_loopback_faults_t faults = {.latency_ms = 1, .drop_rate = 32768, .seed = 0xF1A4};
+    split_loopback_set_faults(&faults);
+    // Let the error rate settle
+    for (int i = 0; i < 50; ++i) {
+        scan();
+    }
+
+    const int scans  = 1000;
+    int       synced = 0;
+    uint32_t  worst  = 0;
+    uint32_t  begin  = timer_read32();
+    for (int i = 0; i < scans; ++i) {
+        if (i % 5 == 0) {
+            change_random_key();
+        }
+        uint32_t start = timer_read32();
+        scan();
+        uint32_t elapsed = timer_elapsed32(start);
+        worst            = elapsed > worst ? elapsed : worst;
+        synced += in_sync();
+    }
+    const split_link_stats_t *stats = split_link_stats_get();
+    RecordProperty("sync_rate_percent", synced * 100 / scans);
+    RecordProperty("mean_scan_us", timer_elapsed32(begin) * 1000 / scans);
+    RecordProperty("worst_scan_ms", worst);
+    RecordProperty("error_rate", stats->error_rate);
+    RecordProperty("give_ups", stats->give_ups);
+    EXPECT_GT(stats->error_rate, 128);
+    EXPECT_GT(synced, 0);
+    // Ten attempts of a two transaction handler would take 20ms, on top of the 1ms scan
+    EXPECT_LT(worst, 20);
+    EXPECT_LT(timer_elapsed32(begin), 4 * scans);
+}
+
+#ifdef SPLIT_MATRIX_EVENTS_ENABLE
+TEST_F(SplitTransport, TapBetweenScansIsDelivered) {
+    slave_scan[0] = 0b0001;
+    slave_task();
+    slave_scan[0] = 0b0000;
+    slave_task();
+
+    EXPECT_TRUE(master_task());
+    EXPECT_EQ(received[0], 0b0001);
+    EXPECT_TRUE(master_task());
+    EXPECT_EQ(received[0], 0b0000);
+}
+#endif // SPLIT_MATRIX_EVENTS_ENABLE
+
+#ifdef SPLIT_TRANSPORT_DELTA
+TEST_F(SplitTransport, SmallMirrorChangeSentAsDelta) {
+    master_scan[3] = MATRIX_ROW_SHIFTER << 5;
+    EXPECT_TRUE(scan());
+    slave_task();
+    EXPECT_EQ(memcmp(mirrored, master_scan, sizeof(mirrored)), 0);
+    RecordProperty("bytes_per_change", split_loopback_get_stats()->bytes);
+    // One checksum from the slave, the delta frame and its acknowledgement
+    EXPECT_LT(split_loopback_get_stats()->bytes, sizeof(master_scan));
+}
+
+TEST_F(SplitTransport, DistantMirrorChangeSentAsDelta) {
+    // Far enough into the section that the run needs a long skip
+    master_scan[SLAVE_ROWS - 1] = MATRIX_ROW_SHIFTER << 9;
+    EXPECT_TRUE(scan());
+    slave_task();
+    EXPECT_EQ(memcmp(mirrored, master_scan, sizeof(mirrored)), 0);
+    EXPECT_LT(split_loopback_get_stats()->bytes, sizeof(master_scan));
+}
+
+TEST_F(SplitTransport, DeltaFallsBackWhenSlaveOutOfStep) {
+    split_loopback_faults_t faults = {.bit_error_rate = 4096, .seed = 7};
+    split_loopback_set_faults(&faults);
+    for (int i = 0; i < 200; ++i) {
+        master_scan[i % SLAVE_ROWS] ^= MATRIX_ROW_SHIFTER << (i % MATRIX_COLS);
+        scan();
+    }
+
+    split_loopback_clear_faults();
+    master_scan[0] ^= MATRIX_ROW_SHIFTER;
+    EXPECT_TRUE(scan());
+    slave_task();
+    EXPECT_EQ(memcmp(mirrored, master_scan, sizeof(mirrored)), 0);
+}
+
+#    ifdef SPLIT_USER_STATE_SIZE
+TEST_F(SplitTransport, SmallSectionChangeSentAsDelta) {
+    uint8_t state[SPLIT_USER_STATE_SIZE] = {0};
+    split_user_state_set(state, sizeof(state));
+    // Anything due to be resent goes out first
+    EXPECT_TRUE(master_task());
+    split_loopback_clear_stats();
+    EXPECT_TRUE(master_task());
+    uint32_t unchanged = split_loopback_get_stats()->bytes;
+
+    state[5] = 0x40;
+    split_user_state_set(state, sizeof(state));
+    split_loopback_clear_stats();
+    EXPECT_TRUE(master_task());
+    uint32_t changed = split_loopback_get_stats()->bytes - unchanged;
+    RecordProperty("bytes_per_change", changed);
+    EXPECT_GT(changed, 0);
+    EXPECT_LT(changed, sizeof(state));
+
+    const uint8_t unsent[SPLIT_USER_STATE_SIZE] = {0};
+    split_user_state_set(unsent, sizeof(unsent));
+    slave_task();
+    EXPECT_EQ(memcmp(split_user_state_get(), state, sizeof(state)), 0);
+}
+#    endif // SPLIT_USER_STATE_SIZE
+#endif     // SPLIT_TRANSPORT_DELTA
+
+#ifdef SPLIT_USER_STATE_SIZE
+TEST_F(SplitTransport, UserStateReplicatedOnce) {
+    const uint8_t state[SPLIT_USER_STATE_SIZE] = {1, 2, 3, 4};
+    split_user_state_set(state, sizeof(state));
+    EXPECT_TRUE(master_task());
+    uint32_t transactions = split_loopback_get_stats()->transactions;
+#ifdef SPLIT_TRANSPORT_BATCH
+    // Staged writes go out with the next exchange
+    EXPECT_TRUE(master_task());
+#endif // SPLIT_TRANSPORT_BATCH
+
+    // Both halves share this process, so change the master's copy before the slave reads its own
+    const uint8_t unsent[SPLIT_USER_STATE_SIZE] = {0};
+    split_user_state_set(unsent, sizeof(unsent));
+    slave_task();
+    EXPECT_EQ(memcmp(split_user_state_get(), state, sizeof(state)), 0);
+
+    // Unchanged state costs nothing until the next forced sync
+    split_user_state_set(state, sizeof(state));
+    split_loopback_clear_stats();
+    EXPECT_TRUE(master_task());
+#ifdef SPLIT_TRANSPORT_BATCH
+    // Still the one exchange every scan
+    EXPECT_EQ(split_loopback_get_stats()->transactions, transactions);
+#else
+    EXPECT_LT(split_loopback_get_stats()->transactions, transactions);
+#endif // SPLIT_TRANSPORT_BATCH
+}
+#endif // SPLIT_USER_STATE_SIZE
+
+#ifdef SPLIT_CAPS_WORD_ENABLE
+// Both halves share this process, so each gets its own Caps Word, with the same idle timeout as caps_word.c
+struct caps_word_half_t {
+    bool     active;
+    uint16_t idle_timer;
+    uint32_t turned_off;
+};
+
+static caps_word_half_t  caps_word_master;
+static caps_word_half_t  caps_word_slave;
+static caps_word_half_t *caps_word_half = &caps_word_master;
+
+extern "C" {
+bool is_caps_word_on(void) {
+    return caps_word_half->active;
+}
+
+void caps_word_reset_idle_timer(void) {
+    caps_word_half->idle_timer = timer_read() + CAPS_WORD_IDLE_TIMEOUT;
+}
+
+void caps_word_on(void) {
+    if (!caps_word_half->active) {
+        caps_word_reset_idle_timer();
+        caps_word_half->active = true;
+    }
+}
+
+void caps_word_off(void) {
+    if (caps_word_half->active) {
+        caps_word_half->active = false;
+        caps_word_half->turned_off++;
+    }
+}
+
+void caps_word_task(void) {
+    if (caps_word_half->active && timer_expired(timer_read(), caps_word_half->idle_timer)) {
+        caps_word_off();
+    }
+}
+}
+
+class SplitTransportCapsWord : public SplitTransport {
+   protected:
+    void SetUp() override {
+        caps_word_master = {};
+        caps_word_slave  = {};
+        SplitTransport::SetUp();
+    }
+
+    // Runs each half the way keyboard_task() does, with Caps Word's own task alongside the transport
+    void caps_word_scan(void) {
+        advance_time(1);
+        caps_word_half = &caps_word_slave;
+        caps_word_task();
+        slave_task();
+        caps_word_half = &caps_word_master;
+        caps_word_task();
+        master_task();
+    }
+};
+
+TEST_F(SplitTransportCapsWord, SlaveFollowsMasterTimeout) {
+    caps_word_on();
+    caps_word_scan();
+    caps_word_scan();
+    ASSERT_TRUE(caps_word_slave.active);
+
+    // Typing keeps the master's Caps Word on well past the idle timeout
+    for (uint32_t i = 0; i < 2 * CAPS_WORD_IDLE_TIMEOUT; ++i) {
+        if (i % 100 == 0) {
+            caps_word_reset_idle_timer();
+        }
+        caps_word_scan();
+        ASSERT_TRUE(caps_word_slave.active) << "after " << i << " ms";
+    }
+    EXPECT_EQ(caps_word_slave.turned_off, 0);
+
+    // Once the master times out, the slave follows it exactly once
+    for (uint32_t i = 0; i < CAPS_WORD_IDLE_TIMEOUT + 10; ++i) {
+        caps_word_scan();
+    }
+    EXPECT_FALSE(caps_word_master.active);
+    EXPECT_FALSE(caps_word_slave.active);
+    EXPECT_EQ(caps_word_slave.turned_off, 1);
+}
+#endif // SPLIT_CAPS_WORD_ENABLE
+
+#ifdef SPLIT_TRANSACTION_IDS_USER
+static uint8_t  stream_received[1024];
+static uint16_t stream_length = 0;
+
+static void stream_receive(uint16_t offset, uint8_t length, const void *data, uint16_t total_length) {
+    memcpy(&stream_received[offset], data, length);
+    stream_length = offset + length;
+}
+
+class SplitTransportStream : public SplitTransport {
+   protected:
+    uint8_t payload[sizeof(stream_received)];
+
+    void SetUp() override {
+        SplitTransport::SetUp();
+        transaction_register_rpc_stream(USER_STREAM, stream_receive);
+        memset(stream_received, 0, sizeof(stream_received));
+        stream_length = 0;
+        for (size_t i = 0; i < sizeof(payload); ++i) {
+            payload[i] = i * 7 + (i >> 8);
+        }
+    }
+
+    bool delivered(void) {
+        return stream_length == sizeof(payload) && memcmp(stream_received, payload, sizeof(payload)) == 0;
+    }
+};
+
+TEST_F(SplitTransportStream, BulkTransferThroughput) {
+    split_loopback_faults_t faults = {.latency_ms = 1};
+    split_loopback_set_faults(&faults);
+    uint32_t start = timer_read32();
+    EXPECT_TRUE(transaction_rpc_stream(USER_STREAM, sizeof(payload), payload));
+    EXPECT_TRUE(delivered());
+
+    uint32_t transactions = split_loopback_get_stats()->transactions;
+    uint32_t elapsed      = timer_elapsed32(start);
+    RecordProperty("transactions", transactions);
+    RecordProperty("bytes_on_wire", split_loopback_get_stats()->bytes);
+    RecordProperty("bytes_per_ms", sizeof(payload) / elapsed);
+    // One exchange per chunk, where transaction_rpc_exec needs four per RPC_M2S_BUFFER_SIZE
+    EXPECT_EQ(transactions, (sizeof(payload) + RPC_STREAM_CHUNK_SIZE - 1) / RPC_STREAM_CHUNK_SIZE);
+}
+
+TEST_F(SplitTransportStream, SurvivesDropsAndBitErrors) {
+    split_loopback_faults_t faults = {.bit_error_rate = 164, .drop_rate = 8192, .seed = 0xBEEF};
+    split_loopback_set_faults(&faults);
+    EXPECT_TRUE(transaction_rpc_stream(USER_STREAM, sizeof(payload), payload));
+    EXPECT_TRUE(delivered());
+    RecordProperty("transactions", split_loopback_get_stats()->transactions);
+    EXPECT_GT(split_loopback_get_stats()->failures, 0);
+}
+
+TEST_F(SplitTransportStream, StaleAckDoesNotCompleteNextStream) {
+    ASSERT_TRUE(transaction_rpc_stream(USER_STREAM, sizeof(payload), payload));
+    ASSERT_TRUE(delivered());
+
+    // With the first chunk of the next stream corrupted, the slave's reply still describes the finished one
+    for (size_t i = 0; i < sizeof(payload); ++i) {
+        payload[i] ^= 0xFF;
+    }
+    split_loopback_faults_t faults = {.corrupt_after = split_loopback_get_stats()->transactions};
+    split_loopback_set_faults(&faults);
+    EXPECT_TRUE(transaction_rpc_stream(USER_STREAM, sizeof(payload), payload));
+    EXPECT_EQ(split_loopback_get_stats()->bit_errors, 1u);
+    EXPECT_TRUE(delivered());
+}
+
+TEST_F(SplitTransportStream, GivesUpOnDeadLink) {
+    split_loopback_faults_t faults = {.drop_rate = UINT16_MAX, .seed = 1};
+    split_loopback_set_faults(&faults);
+    EXPECT_FALSE(transaction_rpc_stream(USER_STREAM, sizeof(payload), payload));
+    EXPECT_FALSE(delivered());
+}
+#endif // SPLIT_TRANSACTION_IDS_USER
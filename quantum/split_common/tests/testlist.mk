@@ -0,0 +1,6 @@
+TEST_LIST += \
+	split_transport \
+	split_transport_batch \
+	split_transport_events \
+	split_transport_delta \
+	split_transport_caps_word
@@ -24,6 +24,10 @@ enum serial_transaction_id {
     GET_SLAVE_MATRIX_CHECKSUM,
     GET_SLAVE_MATRIX_DATA,
 
+#ifdef SPLIT_MATRIX_EVENTS_ENABLE
+    GET_SLAVE_EVENTS,
+#endif // SPLIT_MATRIX_EVENTS_ENABLE
+
 #ifdef SPLIT_TRANSPORT_MIRROR
     PUT_MASTER_MATRIX,
 #endif // SPLIT_TRANSPORT_MIRROR
@@ -78,6 +82,14 @@ enum serial_transaction_id {
     PUT_ST7565,
 #endif // defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
 
+#if defined(CAPS_WORD_ENABLE) && defined(SPLIT_CAPS_WORD_ENABLE)
+    PUT_CAPS_WORD,
+#endif // defined(CAPS_WORD_ENABLE) && defined(SPLIT_CAPS_WORD_ENABLE)
+
+#ifdef SPLIT_USER_STATE_SIZE
+    PUT_USER_STATE,
+#endif // SPLIT_USER_STATE_SIZE
+
 #if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
     GET_POINTING_CHECKSUM,
     GET_POINTING_DATA,
@@ -92,11 +104,20 @@ enum serial_transaction_id {
     PUT_HAPTIC,
 #endif // defined(HAPTIC_ENABLE) && defined(SPLIT_HAPTIC_ENABLE)
 
+#ifdef SPLIT_TRANSPORT_BATCH
+    PUT_GET_BATCH,
+#endif // SPLIT_TRANSPORT_BATCH
+
+#ifdef SPLIT_TRANSPORT_DELTA
+    PUT_DELTA,
+#endif // SPLIT_TRANSPORT_DELTA
+
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
     PUT_RPC_INFO,
     PUT_RPC_REQ_DATA,
     EXECUTE_RPC,
     GET_RPC_RESP_DATA,
+    PUT_GET_RPC_STREAM,
 #endif // defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 
 // keyboard-specific
@@ -111,6 +132,3 @@ enum serial_transaction_id {
 
     NUM_TOTAL_TRANSACTIONS
 };
-
-// Ensure we only use 5 bits for transaction
-_Static_assert(NUM_TOTAL_TRANSACTIONS <= (1 << 5), "Max number of usable transactions exceeded");
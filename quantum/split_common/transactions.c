@@ -27,6 +27,9 @@
 #include "split_util.h"
 #include "synchronization_util.h"
 
+// Ensure we only use 5 bits for transaction
+_Static_assert(NUM_TOTAL_TRANSACTIONS <= (1 << 5), "Max number of usable transactions exceeded");
+
 #define SYNC_TIMER_OFFSET 2
 
 #ifndef FORCED_SYNC_THROTTLE_MS
@@ -43,31 +46,468 @@
     { 0, 0, sizeof_member(split_shared_memory_t, member), offsetof(split_shared_memory_t, member), cb }
 #define trans_target2initiator_initializer(member) trans_target2initiator_initializer_cb(member, NULL)
 
-#define transport_write(id, data, length) transport_execute_transaction(id, data, length, NULL, 0)
-#define transport_read(id, data, length) transport_execute_transaction(id, NULL, 0, data, length)
+// Counts exchanges that actually used the link, as handlers with nothing to send say nothing about its quality
+static uint32_t split_link_exchanges = 0;
+
+static bool split_link_exchange(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length) {
+    split_link_exchanges++;
+    return transport_execute_transaction(id, initiator2target_buf, initiator2target_length, target2initiator_buf, target2initiator_length);
+}
+
+#if defined(SPLIT_TRANSPORT_BATCH) && defined(SPLIT_TRANSPORT_DELTA)
+#    error SPLIT_TRANSPORT_BATCH and SPLIT_TRANSPORT_DELTA cannot be used together
+#endif
+
+#if defined(SPLIT_TRANSPORT_BATCH)
+#    define transport_write(id, data, length) split_batch_write(id, data, length)
+#    define transport_read(id, data, length) split_batch_read(id, data, length)
+#elif defined(SPLIT_TRANSPORT_DELTA)
+#    define transport_write(id, data, length) split_delta_write(id, data, length)
+#    define transport_read(id, data, length) split_link_exchange(id, NULL, 0, data, length)
+#else
+#    define transport_write(id, data, length) split_link_exchange(id, data, length, NULL, 0)
+#    define transport_read(id, data, length) split_link_exchange(id, NULL, 0, data, length)
+#endif
 
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 // Forward-declare the RPC callback handlers
 void slave_rpc_info_callback(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer);
 void slave_rpc_exec_callback(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer);
+void slave_rpc_stream_callback(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer);
 #endif // defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 
+////////////////////////////////////////////////////
+// Batching
+
+#ifdef SPLIT_TRANSPORT_BATCH
+
+/*
+ * Every transaction with an ID below PUT_GET_BATCH can travel inside a single
+ * PUT_GET_BATCH exchange per scan. Both directions use the same frame layout:
+ *
+ *   uint32_t sections   bit n set if transaction n is present
+ *   payloads            each present transaction's buffer, in ID order
+ *   uint8_t  crc8       over everything before it
+ *
+ * Writes are staged in the master's copy of the shared memory and go out with
+ * the next exchange. Reads are served from the reply to the last exchange,
+ * which happens at the start of every scan so slave data is always fresh.
+ */
+
+#    define SPLIT_BATCH_HEADER_SIZE (sizeof(uint32_t))
+#    define SPLIT_BATCH_OVERHEAD (SPLIT_BATCH_HEADER_SIZE + sizeof(uint8_t))
+
+_Static_assert(SPLIT_TRANSPORT_BATCH_SIZE <= UINT8_MAX, "SPLIT_TRANSPORT_BATCH_SIZE must fit in a transaction buffer");
+
+static uint32_t split_batch_pending     = 0;
+static uint8_t  split_batch_pending_len = 0;
+static uint32_t split_batch_received    = 0;
+
+static bool split_batch_write(int8_t id, const void *data, size_t length) {
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+    uint32_t                  bit   = 1UL << id;
+    if (id >= PUT_GET_BATCH || trans->slave_callback || (!(split_batch_pending & bit) && SPLIT_BATCH_OVERHEAD + split_batch_pending_len + trans->initiator2target_buffer_size > SPLIT_TRANSPORT_BATCH_SIZE)) {
+        // Not batchable, or no room left in the frame, so send it on its own
+        return split_link_exchange(id, data, length, NULL, 0);
+    }
+
+    size_t len = trans->initiator2target_buffer_size < length ? trans->initiator2target_buffer_size : length;
+    memcpy(split_trans_initiator2target_buffer(trans), data, len);
+    if (!(split_batch_pending & bit)) {
+        split_batch_pending |= bit;
+        split_batch_pending_len += trans->initiator2target_buffer_size;
+    }
+    return true;
+}
+
+static bool split_batch_read(int8_t id, void *data, size_t length) {
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+    if (!(split_batch_received & (1UL << id))) {
+        return split_link_exchange(id, NULL, 0, data, length);
+    }
+
+    size_t len = trans->target2initiator_buffer_size < length ? trans->target2initiator_buffer_size : length;
+    memcpy(data, split_trans_target2initiator_buffer(trans), len);
+    return true;
+}
+
+static uint8_t split_batch_pack(uint8_t *frame, uint8_t frame_size, uint32_t sections, bool initiator2target) {
+    uint8_t len = SPLIT_BATCH_HEADER_SIZE;
+    for (int8_t id = 0; id < PUT_GET_BATCH; ++id) {
+        if (!(sections & (1UL << id))) continue;
+        split_transaction_desc_t *trans = &split_transaction_table[id];
+        uint8_t                   size  = initiator2target ? trans->initiator2target_buffer_size : trans->target2initiator_buffer_size;
+        if (len + size + sizeof(uint8_t) > frame_size) {
+            sections &= ~(1UL << id);
+            continue;
+        }
+        memcpy(&frame[len], initiator2target ? split_trans_initiator2target_buffer(trans) : split_trans_target2initiator_buffer(trans), size);
+        len += size;
+    }
+    memcpy(frame, &sections, SPLIT_BATCH_HEADER_SIZE);
+    frame[len] = crc8(frame, len);
+    return len + sizeof(uint8_t);
+}
+
+static bool split_batch_unpack(const uint8_t *frame, uint8_t frame_size, uint32_t *sections, bool initiator2target) {
+    uint8_t len = SPLIT_BATCH_HEADER_SIZE;
+    memcpy(sections, frame, SPLIT_BATCH_HEADER_SIZE);
+    for (int8_t id = 0; id < PUT_GET_BATCH; ++id) {
+        if (!(*sections & (1UL << id))) continue;
+        split_transaction_desc_t *trans = &split_transaction_table[id];
+        len += initiator2target ? trans->initiator2target_buffer_size : trans->target2initiator_buffer_size;
+        if (len + sizeof(uint8_t) > frame_size) return false;
+    }
+    if (frame[len] != crc8(frame, len)) return false;
+
+    // Frame is intact, copy each section to where its own transaction would have put it
+    len = SPLIT_BATCH_HEADER_SIZE;
+    for (int8_t id = 0; id < PUT_GET_BATCH; ++id) {
+        if (!(*sections & (1UL << id))) continue;
+        split_transaction_desc_t *trans = &split_transaction_table[id];
+        uint8_t                   size  = initiator2target ? trans->initiator2target_buffer_size : trans->target2initiator_buffer_size;
+        memcpy(initiator2target ? split_trans_initiator2target_buffer(trans) : split_trans_target2initiator_buffer(trans), &frame[len], size);
+        len += size;
+    }
+    return true;
+}
+
+static void split_batch_slave_callback(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer) {
+    uint32_t sections;
+    if (!split_batch_unpack(initiator2target_buffer, initiator2target_buffer_size, &sections, true)) {
+        // An empty reply tells the master to resend
+        split_batch_pack(target2initiator_buffer, target2initiator_buffer_size, 0, false);
+        return;
+    }
+
+    uint32_t replies = 0;
+    for (int8_t id = 0; id < PUT_GET_BATCH; ++id) {
+        if (split_transaction_table[id].target2initiator_buffer_size) {
+            replies |= 1UL << id;
+        }
+    }
+    split_batch_pack(target2initiator_buffer, target2initiator_buffer_size, replies, false);
+}
+
+static bool split_batch_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    uint8_t  frame[SPLIT_TRANSPORT_BATCH_SIZE];
+    uint8_t  reply[SPLIT_TRANSPORT_BATCH_SIZE];
+    uint32_t sections;
+
+#    ifndef DISABLE_SYNC_TIMER
+    if (split_batch_pending & (1UL << PUT_SYNC_TIMER)) {
+        // Staged during the previous scan, so bring it up to date before it goes out
+        split_shmem->sync_timer = sync_timer_read32() + SYNC_TIMER_OFFSET;
+    }
+#    endif // DISABLE_SYNC_TIMER
+
+    split_batch_received = 0;
+    uint8_t len          = split_batch_pack(frame, sizeof(frame), split_batch_pending, true);
+    if (!split_link_exchange(PUT_GET_BATCH, frame, len, reply, sizeof(reply))) {
+        return false;
+    }
+    // Anything staged stays pending until the slave has accepted the frame
+    if (!split_batch_unpack(reply, sizeof(reply), &sections, false) || sections == 0) {
+        return false;
+    }
+
+    split_batch_pending     = 0;
+    split_batch_pending_len = 0;
+    split_batch_received    = sections;
+    return true;
+}
+
+// clang-format off
+#    define TRANSACTIONS_BATCH_MASTER() TRANSACTION_HANDLER_MASTER(split_batch)
+#    define TRANSACTIONS_BATCH_REGISTRATIONS \
+    [PUT_GET_BATCH] = { \
+        sizeof_member(split_shared_memory_t, batch_m2s), offsetof(split_shared_memory_t, batch_m2s), \
+        sizeof_member(split_shared_memory_t, batch_s2m), offsetof(split_shared_memory_t, batch_s2m), \
+        split_batch_slave_callback \
+    },
+// clang-format on
+
+#else // SPLIT_TRANSPORT_BATCH
+
+#    define TRANSACTIONS_BATCH_MASTER()
+#    define TRANSACTIONS_BATCH_REGISTRATIONS
+
+#endif // SPLIT_TRANSPORT_BATCH
+
+////////////////////////////////////////////////////
+// Delta encoding
+
+#ifdef SPLIT_TRANSPORT_DELTA
+
+/*
+ * The master's copy of a section in the shared memory always holds what it
+ * last sent, which is what the slave should have too. A changed section can
+ * therefore go out as the XOR of old and new contents, as a PUT_DELTA frame:
+ *
+ *   uint8_t  id | (runs - 1) << 5   transaction the section belongs to, and how many runs follow
+ *   uint16_t checksum               Fletcher-16 of the whole section once the delta is applied
+ *   runs                            uint8_t skip << 4 | (count - 1), then count XOR bytes
+ *
+ * skip counts unchanged bytes since the end of the previous run. Longer skips
+ * set its nibble to SPLIT_DELTA_LONG_SKIP and follow it with a byte holding
+ * the whole skip. If the slave ends up with a different checksum its copy was
+ * out of step, so it keeps the old contents and the master sends the whole
+ * section instead.
+ */
+
+#    define SPLIT_DELTA_HEADER_SIZE 3
+#    define SPLIT_DELTA_MAX_RUNS 8
+#    define SPLIT_DELTA_MAX_RUN_LENGTH 16
+#    define SPLIT_DELTA_LONG_SKIP 15
+
+#    ifdef USE_I2C
+#        define SPLIT_DELTA_WIRE_SIZE(len) (len)
+#    else
+// Serial transports always send the whole buffer
+#        define SPLIT_DELTA_WIRE_SIZE(len) (SPLIT_TRANSPORT_DELTA_SIZE)
+#    endif
+
+_Static_assert(SPLIT_TRANSPORT_DELTA_SIZE <= UINT8_MAX, "SPLIT_TRANSPORT_DELTA_SIZE must fit in a transaction buffer");
+_Static_assert(SPLIT_TRANSPORT_DELTA_SIZE >= SPLIT_DELTA_HEADER_SIZE + 2 + 1, "SPLIT_TRANSPORT_DELTA_SIZE too small to hold a single change");
+
+static uint16_t split_delta_checksum(const uint8_t *data, uint8_t length) {
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+    for (uint8_t i = 0; i < length; ++i) {
+        sum1 = (sum1 + data[i]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    return sum2 << 8 | sum1;
+}
+
+static uint8_t split_delta_encode(uint8_t *frame, int8_t id, const uint8_t *source, const uint8_t *base, uint8_t length) {
+    uint8_t len  = SPLIT_DELTA_HEADER_SIZE;
+    uint8_t runs = 0;
+    uint8_t pos  = 0;
+    while (pos < length) {
+        uint8_t skip = 0;
+        while (pos < length && source[pos] == base[pos]) {
+            pos++;
+            skip++;
+        }
+        if (pos == length) break;
+
+        // A single unchanged byte stays in the run, as a new run header costs as much
+        uint8_t start = pos;
+        uint8_t end   = pos;
+        while (pos < length && pos - end <= 1 && pos - start < SPLIT_DELTA_MAX_RUN_LENGTH) {
+            if (source[pos] != base[pos]) {
+                end = pos + 1;
+            }
+            pos++;
+        }
+        pos = end;
+
+        uint8_t count  = end - start;
+        uint8_t header = skip < SPLIT_DELTA_LONG_SKIP ? 1 : 2;
+        if (runs == SPLIT_DELTA_MAX_RUNS || len + header + count > SPLIT_TRANSPORT_DELTA_SIZE) {
+            return 0;
+        }
+        if (skip < SPLIT_DELTA_LONG_SKIP) {
+            frame[len++] = skip << 4 | (count - 1);
+        } else {
+            frame[len++] = SPLIT_DELTA_LONG_SKIP << 4 | (count - 1);
+            frame[len++] = skip;
+        }
+        for (uint8_t i = start; i < end; ++i) {
+            frame[len++] = source[i] ^ base[i];
+        }
+        runs++;
+    }
+    if (runs == 0) {
+        return 0;
+    }
+
+    uint16_t checksum = split_delta_checksum(source, length);
+    frame[0]          = id | (runs - 1) << 5;
+    frame[1]          = checksum & 0xFF;
+    frame[2]          = checksum >> 8;
+    return len;
+}
+
+static bool split_delta_write(int8_t id, const void *data, size_t length) {
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+    uint8_t                  *base  = split_trans_initiator2target_buffer(trans);
+    if (length != trans->initiator2target_buffer_size || trans->slave_callback || memcmp(data, base, length) == 0) {
+        // Partial writes, writes with side effects on the slave, and the periodic forced resend all go out whole
+        return split_link_exchange(id, data, length, NULL, 0);
+    }
+
+    uint8_t frame[SPLIT_TRANSPORT_DELTA_SIZE];
+    uint8_t len = split_delta_encode(frame, id, data, base, length);
+    if (len == 0 || SPLIT_DELTA_WIRE_SIZE(len) + sizeof(split_shmem->delta_applied) >= length) {
+        return split_link_exchange(id, data, length, NULL, 0);
+    }
+
+    bool applied = false;
+    if (split_link_exchange(PUT_DELTA, frame, len, &applied, sizeof(applied)) && applied) {
+        memcpy(base, data, length);
+        return true;
+    }
+    return split_link_exchange(id, data, length, NULL, 0);
+}
+
+static void split_delta_slave_callback(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer) {
+    const uint8_t *frame   = initiator2target_buffer;
+    bool          *applied = target2initiator_buffer;
+    *applied               = false;
+
+    uint8_t id   = frame[0] & 0x1F;
+    uint8_t runs = (frame[0] >> 5) + 1;
+    if (id >= NUM_TOTAL_TRANSACTIONS) return;
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+    if (trans->slave_callback || trans->initiator2target_buffer_size == 0) return;
+
+    uint8_t section[UINT8_MAX];
+    uint8_t length = trans->initiator2target_buffer_size;
+    memcpy(section, split_trans_initiator2target_buffer(trans), length);
+
+    uint16_t pos = 0;
+    uint8_t  len = SPLIT_DELTA_HEADER_SIZE;
+    for (uint8_t run = 0; run < runs; ++run) {
+        if (len >= initiator2target_buffer_size) return;
+        uint8_t skip  = frame[len] >> 4;
+        uint8_t count = (frame[len++] & 0x0F) + 1;
+        if (skip == SPLIT_DELTA_LONG_SKIP) {
+            if (len >= initiator2target_buffer_size) return;
+            skip = frame[len++];
+        }
+        pos += skip;
+        if (pos + count > length || len + count > initiator2target_buffer_size) return;
+        for (uint8_t i = 0; i < count; ++i) {
+            section[pos++] ^= frame[len++];
+        }
+    }
+    if (split_delta_checksum(section, length) != (frame[1] | frame[2] << 8)) return;
+
+    memcpy(split_trans_initiator2target_buffer(trans), section, length);
+    *applied = true;
+}
+
+// clang-format off
+#    define TRANSACTIONS_DELTA_REGISTRATIONS \
+    [PUT_DELTA] = { \
+        sizeof_member(split_shared_memory_t, delta_m2s), offsetof(split_shared_memory_t, delta_m2s), \
+        sizeof_member(split_shared_memory_t, delta_applied), offsetof(split_shared_memory_t, delta_applied), \
+        split_delta_slave_callback \
+    },
+// clang-format on
+
+#else // SPLIT_TRANSPORT_DELTA
+
+#    define TRANSACTIONS_DELTA_REGISTRATIONS
+
+#endif // SPLIT_TRANSPORT_DELTA
+
 ////////////////////////////////////////////////////
 // Helpers
 
+////////////////////////////////////////////////////
+// Link quality
+
+/*
+ * Every handler attempt feeds a moving average of the error rate. On a clean
+ * link a failure is most likely a one-off, so it is retried straight away, up
+ * to SPLIT_TRANSACTION_RETRIES times. The worse the link gets, the fewer
+ * attempts a handler gets before giving up until the next scan, so a flaky
+ * cable lowers the sync rate instead of stalling the scan on timeouts.
+ */
+
+#ifndef SPLIT_TRANSACTION_RETRIES
+#    define SPLIT_TRANSACTION_RETRIES 10
+#endif // SPLIT_TRANSACTION_RETRIES
+
+#ifndef SPLIT_LINK_STATS_INTERVAL
+#    define SPLIT_LINK_STATS_INTERVAL 10000
+#endif // SPLIT_LINK_STATS_INTERVAL
+
+_Static_assert(SPLIT_TRANSACTION_RETRIES > 0, "SPLIT_TRANSACTION_RETRIES must be at least 1");
+_Static_assert(SPLIT_LINK_RETRY_BUCKETS > 0, "SPLIT_LINK_RETRY_BUCKETS must be at least 1");
+
+static split_link_stats_t split_link_stats = {0};
+static uint16_t           split_link_error = 0; // moving average of failed attempts, out of 65535
+static uint32_t           split_link_rtt   = 0; // moving average of the round trip in microseconds, times 16
+
+const split_link_stats_t *split_link_stats_get(void) {
+    return &split_link_stats;
+}
+
+uint8_t split_link_stats_pack(uint8_t *buffer, uint8_t length) {
+    if (length < 3) return 0;
+
+    uint32_t counters[3 + SPLIT_LINK_RETRY_BUCKETS];
+    counters[0] = split_link_stats.attempts;
+    counters[1] = split_link_stats.failures;
+    counters[2] = split_link_stats.give_ups;
+    memcpy(&counters[3], split_link_stats.retries, sizeof(split_link_stats.retries));
+
+    uint8_t i   = 0;
+    buffer[i++] = split_link_stats.error_rate;
+    buffer[i++] = (split_link_stats.round_trip_us >> 8) & 0xFF;
+    buffer[i++] = split_link_stats.round_trip_us & 0xFF;
+    for (uint8_t n = 0; n < ARRAY_SIZE(counters) && i + 4 <= length; n++) {
+        buffer[i++] = (counters[n] >> 24) & 0xFF;
+        buffer[i++] = (counters[n] >> 16) & 0xFF;
+        buffer[i++] = (counters[n] >> 8) & 0xFF;
+        buffer[i++] = counters[n] & 0xFF;
+    }
+    return i;
+}
+
+void split_link_stats_clear(void) {
+    memset(&split_link_stats, 0, sizeof(split_link_stats));
+    split_link_error = 0;
+    split_link_rtt   = 0;
+}
+
+static void split_link_record_attempt(bool okay) {
+    split_link_stats.attempts++;
+    if (okay) {
+        split_link_error -= split_link_error >> 4;
+    } else {
+        split_link_stats.failures++;
+        split_link_error += (UINT16_MAX - split_link_error) >> 4;
+    }
+    split_link_stats.error_rate = split_link_error >> 8;
+}
+
+static void split_link_record_round_trip(uint32_t elapsed_ms) {
+    // Millisecond timer, but averaging many scans still resolves well below that
+    split_link_rtt += elapsed_ms * 1000 - (split_link_rtt >> 4);
+    split_link_stats.round_trip_us = (split_link_rtt >> 4) < UINT16_MAX ? (split_link_rtt >> 4) : UINT16_MAX;
+}
+
+static void split_link_stats_task(void) {
+#if SPLIT_LINK_STATS_INTERVAL > 0
+    static uint32_t last_print = 0;
+    if (timer_elapsed32(last_print) >= SPLIT_LINK_STATS_INTERVAL) {
+        last_print = timer_read32();
+        dprintf("SPLIT: link errors %u/255, round trip %luus, %lu of %lu attempts failed, %lu gave up\n", split_link_error >> 8, split_link_rtt >> 4, split_link_stats.failures, split_link_stats.attempts, split_link_stats.give_ups);
+    }
+#endif // SPLIT_LINK_STATS_INTERVAL > 0
+}
+
 static bool transaction_handler_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[], const char *prefix, bool (*handler)(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])) {
-    int num_retries = is_transport_connected() ? 10 : 1;
-    for (int iter = 1; iter <= num_retries; ++iter) {
-        if (iter > 1) {
-            for (int i = 0; i < iter * iter; ++i) {
-                wait_us(10);
-            }
+    int num_attempts = is_transport_connected() ? 1 + (SPLIT_TRANSACTION_RETRIES - 1) * (uint32_t)(UINT16_MAX - split_link_error) / UINT16_MAX : 1;
+    for (int retries = 0; retries < num_attempts; ++retries) {
+        uint32_t exchanges = split_link_exchanges;
+        bool     this_okay = handler(master_matrix, slave_matrix);
+        if (split_link_exchanges == exchanges) {
+            return this_okay;
+        }
+        split_link_record_attempt(this_okay);
+        if (this_okay) {
+            split_link_stats.retries[retries < SPLIT_LINK_RETRY_BUCKETS ? retries : SPLIT_LINK_RETRY_BUCKETS - 1]++;
+            return true;
         }
-        bool this_okay = true;
-        this_okay      = handler(master_matrix, slave_matrix);
-        if (this_okay) return true;
     }
-    dprintf("Failed to execute %s\n", prefix);
+    split_link_stats.give_ups++;
+    dprintf("Failed to execute %s after %d attempts, link errors %u/255\n", prefix, num_attempts, split_link_error >> 8);
     return false;
 }
 
@@ -136,6 +576,97 @@ inline static bool send_if_data_mismatch(int8_t trans_id, uint32_t *last_update,
 ////////////////////////////////////////////////////
 // Slave matrix
 
+#ifdef SPLIT_MATRIX_EVENTS_ENABLE
+
+_Static_assert((SPLIT_MATRIX_EVENTS_MAX & (SPLIT_MATRIX_EVENTS_MAX - 1)) == 0, "SPLIT_MATRIX_EVENTS_MAX must be a power of two");
+
+static bool slave_events_read(split_slave_events_sync_t *events) {
+    bool okay = transport_read(GET_SLAVE_EVENTS, events, sizeof(split_slave_events_sync_t));
+    return okay && events->checksum == crc8(&events->head, sizeof(split_slave_events_sync_t) - offsetof(split_slave_events_sync_t, head));
+}
+
+static bool slave_matrix_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    static bool               in_sync                        = false;
+    static uint8_t            next_seq                       = 0;
+    static matrix_row_t       last_matrix[(MATRIX_ROWS) / 2] = {0}; // matrix rebuilt from the event stream
+    split_slave_events_sync_t events;
+
+    bool okay = slave_events_read(&events);
+    if (okay && (!in_sync || (uint8_t)(events.head - next_seq) > SPLIT_MATRIX_EVENTS_MAX)) {
+        // Lost our place in the stream, so fall back to reading the whole matrix. It only
+        // counts if no events were added while it was being read.
+        matrix_row_t temp_matrix[(MATRIX_ROWS) / 2];
+        uint8_t      head = events.head;
+        okay &= transport_read(GET_SLAVE_MATRIX_DATA, temp_matrix, sizeof(temp_matrix));
+        okay &= slave_events_read(&events);
+        if (okay && events.head == head && crc8(temp_matrix, sizeof(temp_matrix)) == events.matrix_checksum) {
+            memcpy(last_matrix, temp_matrix, sizeof(temp_matrix));
+            next_seq = head;
+            in_sync  = true;
+        }
+    } else if (okay) {
+        matrix_row_t changed[(MATRIX_ROWS) / 2] = {0};
+        while (next_seq != events.head) {
+            split_matrix_event_t event = events.events[next_seq % SPLIT_MATRIX_EVENTS_MAX];
+            matrix_row_t         mask  = MATRIX_ROW_SHIFTER << event.col;
+            if (event.row >= (MATRIX_ROWS) / 2) {
+                in_sync = false;
+                break;
+            }
+            // A second change to the same key waits for the next scan, so quick taps are not lost
+            if (changed[event.row] & mask) {
+                break;
+            }
+            changed[event.row] |= mask;
+            if (event.pressed) {
+                last_matrix[event.row] |= mask;
+            } else {
+                last_matrix[event.row] &= ~mask;
+            }
+            next_seq++;
+        }
+        if (next_seq == events.head && crc8(last_matrix, sizeof(last_matrix)) != events.matrix_checksum) {
+            in_sync = false;
+        }
+    }
+    memcpy(slave_matrix, last_matrix, sizeof(last_matrix));
+    return okay;
+}
+
+static void slave_matrix_handlers_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    static matrix_row_t        last_matrix[(MATRIX_ROWS) / 2] = {0};
+    split_slave_events_sync_t *events                         = &split_shmem->slave_events;
+
+    for (uint8_t row = 0; row < (MATRIX_ROWS) / 2; row++) {
+        matrix_row_t diff = last_matrix[row] ^ slave_matrix[row];
+        for (uint8_t col = 0; diff && col < MATRIX_COLS; col++) {
+            matrix_row_t mask = MATRIX_ROW_SHIFTER << col;
+            if (diff & mask) {
+                events->events[events->head % SPLIT_MATRIX_EVENTS_MAX] = (split_matrix_event_t){.row = row, .col = col, .pressed = (slave_matrix[row] & mask) != 0};
+                events->head++;
+                diff &= ~mask;
+            }
+        }
+    }
+    memcpy(last_matrix, slave_matrix, sizeof(last_matrix));
+
+    memcpy(split_shmem->smatrix.matrix, slave_matrix, sizeof(split_shmem->smatrix.matrix));
+    split_shmem->smatrix.checksum = crc8(split_shmem->smatrix.matrix, sizeof(split_shmem->smatrix.matrix));
+    events->matrix_checksum       = split_shmem->smatrix.checksum;
+    events->checksum              = crc8(&events->head, sizeof(split_slave_events_sync_t) - offsetof(split_slave_events_sync_t, head));
+}
+
+// clang-format off
+#    define TRANSACTIONS_SLAVE_MATRIX_MASTER() TRANSACTION_HANDLER_MASTER(slave_matrix)
+#    define TRANSACTIONS_SLAVE_MATRIX_SLAVE() TRANSACTION_HANDLER_SLAVE_AUTOLOCK(slave_matrix)
+#    define TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS \
+    [GET_SLAVE_MATRIX_CHECKSUM] = trans_target2initiator_initializer(smatrix.checksum), \
+    [GET_SLAVE_MATRIX_DATA]     = trans_target2initiator_initializer(smatrix.matrix), \
+    [GET_SLAVE_EVENTS]          = trans_target2initiator_initializer(slave_events),
+// clang-format on
+
+#else // SPLIT_MATRIX_EVENTS_ENABLE
+
 static bool slave_matrix_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
     static uint32_t     last_update                    = 0;
     static matrix_row_t last_matrix[(MATRIX_ROWS) / 2] = {0}; // last successfully-read matrix, so we can replicate if there are checksum errors
@@ -157,13 +688,15 @@ static void slave_matrix_handlers_slave(matrix_row_t master_matrix[], matrix_row
 }
 
 // clang-format off
-#define TRANSACTIONS_SLAVE_MATRIX_MASTER() TRANSACTION_HANDLER_MASTER(slave_matrix)
-#define TRANSACTIONS_SLAVE_MATRIX_SLAVE() TRANSACTION_HANDLER_SLAVE_AUTOLOCK(slave_matrix)
-#define TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS \
+#    define TRANSACTIONS_SLAVE_MATRIX_MASTER() TRANSACTION_HANDLER_MASTER(slave_matrix)
+#    define TRANSACTIONS_SLAVE_MATRIX_SLAVE() TRANSACTION_HANDLER_SLAVE_AUTOLOCK(slave_matrix)
+#    define TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS \
     [GET_SLAVE_MATRIX_CHECKSUM] = trans_target2initiator_initializer(smatrix.checksum), \
     [GET_SLAVE_MATRIX_DATA]     = trans_target2initiator_initializer(smatrix.matrix),
 // clang-format on
 
+#endif // SPLIT_MATRIX_EVENTS_ENABLE
+
 ////////////////////////////////////////////////////
 // Master matrix
 
@@ -432,15 +965,30 @@ static void backlight_handlers_slave(matrix_row_t master_matrix[], matrix_row_t
 
 #if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
 
+#    ifndef RGBLIGHT_SPLIT_RESYNC_MS
+#        define RGBLIGHT_SPLIT_RESYNC_MS 5000
+#    endif // RGBLIGHT_SPLIT_RESYNC_MS
+
 static bool rgblight_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
-    static uint32_t     last_update = 0;
+    static uint32_t last_update  = 0;
+    uint8_t         change_flags = rgblight_get_change_flags();
+    // Only deltas go out; the full state is resent occasionally so a slave
+    // that has reset or missed a write still converges
+    if (timer_elapsed32(last_update) >= RGBLIGHT_SPLIT_RESYNC_MS) {
+        change_flags |= RGBLIGHT_STATUS_CHANGE_ALL;
+    }
+    if (change_flags == 0) {
+        return true;
+    }
+
     rgblight_syncinfo_t rgblight_sync;
     rgblight_get_syncinfo(&rgblight_sync);
-    if (send_if_condition(PUT_RGBLIGHT, &last_update, (rgblight_sync.status.change_flags != 0), &rgblight_sync, sizeof(rgblight_sync))) {
-        rgblight_clear_change_flags();
-    } else {
+    rgblight_sync.change_flags = change_flags;
+    if (!transport_write(PUT_RGBLIGHT, &rgblight_sync, sizeof(rgblight_sync))) {
         return false;
     }
+    last_update = timer_read32();
+    rgblight_clear_change_flags();
     return true;
 }
 
@@ -449,10 +997,10 @@ static void rgblight_handlers_slave(matrix_row_t master_matrix[], matrix_row_t s
     // Update the RGB with the new data
     rgblight_syncinfo_t rgblight_sync;
     memcpy(&rgblight_sync, &split_shmem->rgblight_sync, sizeof(rgblight_syncinfo_t));
-    split_shmem->rgblight_sync.status.change_flags = 0;
+    split_shmem->rgblight_sync.change_flags = 0;
     split_shared_memory_unlock();
 
-    if (rgblight_sync.status.change_flags != 0) {
+    if (rgblight_sync.change_flags != 0) {
         rgblight_update_sync(&rgblight_sync, false);
     }
 }
@@ -634,6 +1182,89 @@ static void st7565_handlers_slave(matrix_row_t master_matrix[], matrix_row_t sla
 
 #endif // defined(ST7565_ENABLE) && defined(SPLIT_ST7565_ENABLE)
 
+////////////////////////////////////////////////////
+// Caps Word
+
+#if defined(CAPS_WORD_ENABLE) && defined(SPLIT_CAPS_WORD_ENABLE)
+
+static bool caps_word_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    static uint32_t last_update     = 0;
+    bool            caps_word_state = is_caps_word_on();
+    return send_if_condition(PUT_CAPS_WORD, &last_update, (caps_word_state != split_shmem->caps_word_state), &caps_word_state, sizeof(caps_word_state));
+}
+
+static void caps_word_handlers_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    split_shared_memory_lock();
+    bool caps_word_state = split_shmem->caps_word_state;
+    split_shared_memory_unlock();
+
+    // Only act on changes, so caps_word_set_user() fires once per transition on both halves
+    if (caps_word_state != is_caps_word_on()) {
+        if (caps_word_state) {
+            caps_word_on();
+        } else {
+            caps_word_off();
+        }
+    }
+#    if CAPS_WORD_IDLE_TIMEOUT > 0
+    // The master owns the idle timeout, so the slave's own only ends Caps Word once the link goes quiet
+    if (caps_word_state) {
+        caps_word_reset_idle_timer();
+    }
+#    endif // CAPS_WORD_IDLE_TIMEOUT > 0
+}
+
+#    define TRANSACTIONS_CAPS_WORD_MASTER() TRANSACTION_HANDLER_MASTER(caps_word)
+#    define TRANSACTIONS_CAPS_WORD_SLAVE() TRANSACTION_HANDLER_SLAVE(caps_word)
+#    define TRANSACTIONS_CAPS_WORD_REGISTRATIONS [PUT_CAPS_WORD] = trans_initiator2target_initializer(caps_word_state),
+
+#else // defined(CAPS_WORD_ENABLE) && defined(SPLIT_CAPS_WORD_ENABLE)
+
+#    define TRANSACTIONS_CAPS_WORD_MASTER()
+#    define TRANSACTIONS_CAPS_WORD_SLAVE()
+#    define TRANSACTIONS_CAPS_WORD_REGISTRATIONS
+
+#endif // defined(CAPS_WORD_ENABLE) && defined(SPLIT_CAPS_WORD_ENABLE)
+
+////////////////////////////////////////////////////
+// User state
+
+#ifdef SPLIT_USER_STATE_SIZE
+
+// The state both halves render from, set by the master and replicated to the slave
+static uint8_t split_user_state[SPLIT_USER_STATE_SIZE] = {0};
+
+void split_user_state_set(const void *state, size_t size) {
+    if (size > sizeof(split_user_state)) size = sizeof(split_user_state);
+    memcpy(split_user_state, state, size);
+    memset(&split_user_state[size], 0, sizeof(split_user_state) - size);
+}
+
+const void *split_user_state_get(void) {
+    return split_user_state;
+}
+
+static bool user_state_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    static uint32_t last_update = 0;
+    return send_if_data_mismatch(PUT_USER_STATE, &last_update, split_user_state, split_shmem->user_state, sizeof(split_user_state));
+}
+
+static void user_state_handlers_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    memcpy(split_user_state, split_shmem->user_state, sizeof(split_user_state));
+}
+
+#    define TRANSACTIONS_USER_STATE_MASTER() TRANSACTION_HANDLER_MASTER(user_state)
+#    define TRANSACTIONS_USER_STATE_SLAVE() TRANSACTION_HANDLER_SLAVE_AUTOLOCK(user_state)
+#    define TRANSACTIONS_USER_STATE_REGISTRATIONS [PUT_USER_STATE] = trans_initiator2target_initializer(user_state),
+
+#else // SPLIT_USER_STATE_SIZE
+
+#    define TRANSACTIONS_USER_STATE_MASTER()
+#    define TRANSACTIONS_USER_STATE_SLAVE()
+#    define TRANSACTIONS_USER_STATE_REGISTRATIONS
+
+#endif // SPLIT_USER_STATE_SIZE
+
 ////////////////////////////////////////////////////
 // POINTING
 
@@ -801,6 +1432,8 @@ split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS] = {
 #endif // USE_I2C
 
     // clang-format off
+    TRANSACTIONS_BATCH_REGISTRATIONS
+    TRANSACTIONS_DELTA_REGISTRATIONS
     TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS
     TRANSACTIONS_MASTER_MATRIX_REGISTRATIONS
     TRANSACTIONS_ENCODERS_REGISTRATIONS
@@ -815,6 +1448,8 @@ split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS] = {
     TRANSACTIONS_WPM_REGISTRATIONS
     TRANSACTIONS_OLED_REGISTRATIONS
     TRANSACTIONS_ST7565_REGISTRATIONS
+    TRANSACTIONS_CAPS_WORD_REGISTRATIONS
+    TRANSACTIONS_USER_STATE_REGISTRATIONS
     TRANSACTIONS_POINTING_REGISTRATIONS
     TRANSACTIONS_WATCHDOG_REGISTRATIONS
     TRANSACTIONS_HAPTIC_REGISTRATIONS
@@ -825,10 +1460,16 @@ split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS] = {
     [PUT_RPC_REQ_DATA]  = trans_initiator2target_initializer(rpc_m2s_buffer),
     [EXECUTE_RPC]       = trans_initiator2target_initializer_cb(rpc_info.payload.transaction_id, slave_rpc_exec_callback),
     [GET_RPC_RESP_DATA] = trans_target2initiator_initializer(rpc_s2m_buffer),
+    [PUT_GET_RPC_STREAM] = {
+        sizeof_member(split_shared_memory_t, rpc_stream_m2s), offsetof(split_shared_memory_t, rpc_stream_m2s),
+        sizeof_member(split_shared_memory_t, rpc_stream_s2m), offsetof(split_shared_memory_t, rpc_stream_s2m),
+        slave_rpc_stream_callback
+    },
 #endif // defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 };
 
-bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+static bool transactions_master_handlers(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    TRANSACTIONS_BATCH_MASTER();
     TRANSACTIONS_SLAVE_MATRIX_MASTER();
     TRANSACTIONS_MASTER_MATRIX_MASTER();
     TRANSACTIONS_ENCODERS_MASTER();
@@ -843,12 +1484,24 @@ bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix
     TRANSACTIONS_WPM_MASTER();
     TRANSACTIONS_OLED_MASTER();
     TRANSACTIONS_ST7565_MASTER();
+    TRANSACTIONS_CAPS_WORD_MASTER();
+    TRANSACTIONS_USER_STATE_MASTER();
     TRANSACTIONS_POINTING_MASTER();
     TRANSACTIONS_WATCHDOG_MASTER();
     TRANSACTIONS_HAPTIC_MASTER();
     return true;
 }
 
+bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    uint32_t start = timer_read32();
+    bool     okay  = transactions_master_handlers(master_matrix, slave_matrix);
+    if (okay) {
+        split_link_record_round_trip(timer_elapsed32(start));
+    }
+    split_link_stats_task();
+    return okay;
+}
+
 void transactions_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
     TRANSACTIONS_SLAVE_MATRIX_SLAVE();
     TRANSACTIONS_MASTER_MATRIX_SLAVE();
@@ -864,6 +1517,8 @@ void transactions_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[
     TRANSACTIONS_WPM_SLAVE();
     TRANSACTIONS_OLED_SLAVE();
     TRANSACTIONS_ST7565_SLAVE();
+    TRANSACTIONS_CAPS_WORD_SLAVE();
+    TRANSACTIONS_USER_STATE_SLAVE();
     TRANSACTIONS_POINTING_SLAVE();
     TRANSACTIONS_WATCHDOG_SLAVE();
     TRANSACTIONS_HAPTIC_SLAVE();
@@ -873,7 +1528,7 @@ void transactions_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[
 
 void transaction_register_rpc(int8_t transaction_id, slave_callback_t callback) {
     // Prevent invoking RPC on QMK core sync data
-    if (transaction_id <= GET_RPC_RESP_DATA) return;
+    if (transaction_id <= PUT_GET_RPC_STREAM) return;
 
     // Set the callback
     split_transaction_table[transaction_id].slave_callback          = callback;
@@ -887,7 +1542,7 @@ bool transaction_rpc_exec(int8_t transaction_id, uint8_t initiator2target_buffer
         return false;
     }
     // Prevent invoking RPC on QMK core sync data
-    if (transaction_id <= GET_RPC_RESP_DATA) return false;
+    if (transaction_id <= PUT_GET_RPC_STREAM) return false;
     // Prevent sizing issues
     if (initiator2target_buffer_size > RPC_M2S_BUFFER_SIZE) return false;
     if (target2initiator_buffer_size > RPC_S2M_BUFFER_SIZE) return false;
@@ -946,4 +1601,113 @@ void slave_rpc_exec_callback(uint8_t initiator2target_buffer_size, const void *i
     }
 }
 
+
+////////////////////////////////////////////////////
+// Streaming RPC
+
+/*
+ * Payloads larger than the RPC buffers are split into chunks of
+ * RPC_STREAM_CHUNK_SIZE, each sent in a single PUT_GET_RPC_STREAM exchange
+ * whose reply acknowledges every chunk delivered so far. Chunk 0 always starts
+ * a stream, later chunks are only delivered in order. If an exchange fails, the
+ * master carries on with the next chunk while fewer than RPC_STREAM_WINDOW are
+ * unacknowledged, so a lost reply does not cost a resend. Whenever a reply
+ * shows the slave is behind, the master goes back to the first missing chunk.
+ */
+
+#ifndef RPC_STREAM_WINDOW
+#    define RPC_STREAM_WINDOW 4
+#endif // RPC_STREAM_WINDOW
+
+#ifndef RPC_STREAM_MAX_FAILURES
+#    define RPC_STREAM_MAX_FAILURES 10
+#endif // RPC_STREAM_MAX_FAILURES
+
+static slave_stream_callback_t rpc_stream_callbacks[NUM_TOTAL_TRANSACTIONS - PUT_GET_RPC_STREAM - 1] = {0};
+
+static uint8_t rpc_stream_chunk_length(uint16_t seq, uint16_t total_length) {
+    uint32_t offset = (uint32_t)seq * RPC_STREAM_CHUNK_SIZE;
+    if (offset >= total_length) return 0;
+    return total_length - offset < RPC_STREAM_CHUNK_SIZE ? total_length - offset : RPC_STREAM_CHUNK_SIZE;
+}
+
+void transaction_register_rpc_stream(int8_t transaction_id, slave_stream_callback_t callback) {
+    // Prevent invoking RPC on QMK core sync data
+    if (transaction_id <= PUT_GET_RPC_STREAM || transaction_id >= NUM_TOTAL_TRANSACTIONS) return;
+
+    rpc_stream_callbacks[transaction_id - PUT_GET_RPC_STREAM - 1] = callback;
+}
+
+// Acks carry the identity of the stream the slave is working on, so one left over from an earlier stream -- such as the
+// reply to a corrupted first chunk of a new one -- isn't mistaken for progress on this one
+static bool rpc_stream_ack_matches(const rpc_stream_ack_t *ack, const rpc_stream_chunk_t *chunk, uint16_t chunks) {
+    return ack->checksum == crc8(&ack->payload, sizeof(ack->payload)) && ack->payload.stream_id == chunk->payload.stream_id && ack->payload.transaction_id == chunk->payload.transaction_id && ack->payload.total_length == chunk->payload.total_length && ack->payload.next_seq <= chunks;
+}
+
+bool transaction_rpc_stream(int8_t transaction_id, uint16_t length, const void *data) {
+    // Prevent transaction attempts while transport is disconnected
+    if (!is_transport_connected()) {
+        return false;
+    }
+    // Prevent invoking RPC on QMK core sync data
+    if (transaction_id <= PUT_GET_RPC_STREAM || transaction_id >= NUM_TOTAL_TRANSACTIONS) return false;
+
+    static uint8_t stream_id = 0;
+    stream_id++;
+
+    // An empty stream is still one (empty) chunk, so the slave gets to see it
+    uint16_t chunks   = length ? (length + RPC_STREAM_CHUNK_SIZE - 1) / RPC_STREAM_CHUNK_SIZE : 1;
+    uint16_t acked    = 0;
+    uint16_t next     = 0;
+    uint8_t  failures = 0;
+    while (acked < chunks) {
+        rpc_stream_chunk_t chunk = {.payload = {.stream_id = stream_id, .transaction_id = transaction_id, .seq = next, .total_length = length}};
+        uint8_t            len   = rpc_stream_chunk_length(next, length);
+        memcpy(chunk.payload.data, (const uint8_t *)data + (uint32_t)next * RPC_STREAM_CHUNK_SIZE, len);
+        chunk.checksum = crc8(&chunk.payload, offsetof(rpc_stream_chunk_t, payload.data) - offsetof(rpc_stream_chunk_t, payload) + len);
+
+        rpc_stream_ack_t ack;
+        if (split_link_exchange(PUT_GET_RPC_STREAM, &chunk, offsetof(rpc_stream_chunk_t, payload.data) + len, &ack, sizeof(ack)) && rpc_stream_ack_matches(&ack, &chunk, chunks)) {
+            acked    = ack.payload.next_seq;
+            next     = acked;
+            failures = 0;
+        } else if (++failures >= RPC_STREAM_MAX_FAILURES) {
+            return false;
+        } else if (next + 1 < chunks && next + 1 - acked < RPC_STREAM_WINDOW) {
+            next++;
+        } else {
+            next = acked;
+        }
+    }
+    return true;
+}
+
+void slave_rpc_stream_callback(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer) {
+    // Progress through the current stream, which is sent back as the ack
+    static rpc_stream_ack_t   progress = {0};
+    const rpc_stream_chunk_t *chunk    = (const rpc_stream_chunk_t *)initiator2target_buffer;
+
+    uint8_t len = rpc_stream_chunk_length(chunk->payload.seq, chunk->payload.total_length);
+    if (crc8(&chunk->payload, offsetof(rpc_stream_chunk_t, payload.data) - offsetof(rpc_stream_chunk_t, payload) + len) == chunk->checksum && chunk->payload.transaction_id > PUT_GET_RPC_STREAM && chunk->payload.transaction_id < NUM_TOTAL_TRANSACTIONS) {
+        bool same_stream = chunk->payload.stream_id == progress.payload.stream_id && chunk->payload.transaction_id == progress.payload.transaction_id && chunk->payload.total_length == progress.payload.total_length;
+        if (chunk->payload.seq == 0 || !same_stream) {
+            // A chunk of a stream we missed the start of asks the master to go back to its first chunk
+            progress.payload.stream_id      = chunk->payload.stream_id;
+            progress.payload.transaction_id = chunk->payload.transaction_id;
+            progress.payload.total_length   = chunk->payload.total_length;
+            progress.payload.next_seq       = 0;
+        }
+        if (chunk->payload.seq == progress.payload.next_seq) {
+            slave_stream_callback_t callback = rpc_stream_callbacks[chunk->payload.transaction_id - PUT_GET_RPC_STREAM - 1];
+            if (callback) {
+                callback((uint32_t)chunk->payload.seq * RPC_STREAM_CHUNK_SIZE, len, chunk->payload.data, chunk->payload.total_length);
+            }
+            progress.payload.next_seq++;
+        }
+    }
+
+    progress.checksum = crc8(&progress.payload, sizeof(progress.payload));
+    memcpy(target2initiator_buffer, &progress, sizeof(progress));
+}
+
 #endif // defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
@@ -23,7 +23,12 @@
 #include "transaction_id_define.h"
 #include "transport.h"
 
+#ifndef SPLIT_LINK_RETRY_BUCKETS
+#    define SPLIT_LINK_RETRY_BUCKETS 4
+#endif // SPLIT_LINK_RETRY_BUCKETS
+
 typedef void (*slave_callback_t)(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer);
+typedef void (*slave_stream_callback_t)(uint16_t offset, uint8_t length, const void *data, uint16_t total_length);
 
 // Split transaction Descriptor
 typedef struct _split_transaction_desc_t {
@@ -51,3 +56,23 @@ bool transaction_rpc_exec(int8_t transaction_id, uint8_t initiator2target_buffer
 
 #define transaction_rpc_send(transaction_id, initiator2target_buffer_size, initiator2target_buffer) transaction_rpc_exec(transaction_id, initiator2target_buffer_size, initiator2target_buffer, 0, NULL)
 #define transaction_rpc_recv(transaction_id, target2initiator_buffer_size, target2initiator_buffer) transaction_rpc_exec(transaction_id, 0, NULL, target2initiator_buffer_size, target2initiator_buffer)
+
+void transaction_register_rpc_stream(int8_t transaction_id, slave_stream_callback_t callback);
+
+bool transaction_rpc_stream(int8_t transaction_id, uint16_t length, const void *data);
+
+// Link quality, as seen by the master
+typedef struct _split_link_stats_t {
+    uint32_t attempts;                          // transaction handler attempts
+    uint32_t failures;                          // attempts which failed
+    uint32_t give_ups;                          // handlers which ran out of attempts
+    uint32_t retries[SPLIT_LINK_RETRY_BUCKETS]; // handlers which succeeded after n retries, the last bucket holds n or more
+    uint16_t round_trip_us;                     // moving average of a full sync with the slave
+    uint8_t  error_rate;                        // moving average of failed attempts, out of 255
+} split_link_stats_t;
+
+const split_link_stats_t *split_link_stats_get(void);
+void                      split_link_stats_clear(void);
+
+// Packs the stats for a host, such as from via_custom_value_command_kb(), returning the bytes written
+uint8_t split_link_stats_pack(uint8_t *buffer, uint8_t length);
@@ -21,6 +21,7 @@
 #include "transport.h"
 #include "transaction_id_define.h"
 #include "atomic_util.h"
+#include "synchronization_util.h"
 
 #ifdef USE_I2C
 
@@ -113,7 +114,10 @@ bool transport_execute_transaction(int8_t id, const void *initiator2target_buf,
 
     if (target2initiator_length > 0) {
         size_t len = trans->target2initiator_buffer_size < target2initiator_length ? trans->target2initiator_buffer_size : target2initiator_length;
+        // Streaming drivers update these buffers from a thread of their own
+        split_shared_memory_lock();
         memcpy(target2initiator_buf, split_trans_target2initiator_buffer(trans), len);
+        split_shared_memory_unlock();
     }
 
     return true;
@@ -127,4 +131,7 @@ bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])
 
 void transport_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
     transactions_slave(master_matrix, slave_matrix);
+#if defined(SERIAL_STREAMING) && !defined(USE_I2C)
+    soft_serial_target_publish();
+#endif
 }
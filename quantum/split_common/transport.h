@@ -31,6 +31,24 @@
 #    define RPC_S2M_BUFFER_SIZE 32
 #endif // RPC_S2M_BUFFER_SIZE
 
+#ifndef RPC_STREAM_CHUNK_SIZE
+#    define RPC_STREAM_CHUNK_SIZE 32
+#endif // RPC_STREAM_CHUNK_SIZE
+
+#ifndef SPLIT_TRANSPORT_BATCH_SIZE
+#    define SPLIT_TRANSPORT_BATCH_SIZE 48
+#endif // SPLIT_TRANSPORT_BATCH_SIZE
+
+#ifndef SPLIT_TRANSPORT_DELTA_SIZE
+#    ifdef USE_I2C
+// Only the bytes used go over I2C, so room for larger deltas costs nothing on the wire
+#        define SPLIT_TRANSPORT_DELTA_SIZE 16
+#    else
+// Serial always sends the whole buffer, so keep it small enough for short sections to benefit
+#        define SPLIT_TRANSPORT_DELTA_SIZE 6
+#    endif
+#endif // SPLIT_TRANSPORT_DELTA_SIZE
+
 void transport_master_init(void);
 void transport_slave_init(void);
 
@@ -57,6 +75,26 @@ typedef struct _split_slave_matrix_sync_t {
     matrix_row_t matrix[(MATRIX_ROWS) / 2];
 } split_slave_matrix_sync_t;
 
+#ifdef SPLIT_MATRIX_EVENTS_ENABLE
+#    ifndef SPLIT_MATRIX_EVENTS_MAX
+#        define SPLIT_MATRIX_EVENTS_MAX 8
+#    endif // SPLIT_MATRIX_EVENTS_MAX
+
+typedef struct _split_matrix_event_t {
+    uint8_t row;
+    uint8_t col : 7;
+    bool    pressed : 1;
+} split_matrix_event_t;
+
+// Ring of the most recent key changes on the slave, event n is at index n % SPLIT_MATRIX_EVENTS_MAX
+typedef struct _split_slave_events_sync_t {
+    uint8_t              checksum;
+    uint8_t              head;            // sequence number of the next event to be written
+    uint8_t              matrix_checksum; // of the slave matrix after the last event
+    split_matrix_event_t events[SPLIT_MATRIX_EVENTS_MAX];
+} split_slave_events_sync_t;
+#endif // SPLIT_MATRIX_EVENTS_ENABLE
+
 #ifdef SPLIT_TRANSPORT_MIRROR
 typedef struct _split_master_matrix_sync_t {
     matrix_row_t matrix[(MATRIX_ROWS) / 2];
@@ -131,6 +169,27 @@ typedef struct _rpc_sync_info_t {
         uint8_t s2m_length;
     } payload;
 } rpc_sync_info_t;
+
+typedef struct _rpc_stream_chunk_t {
+    uint8_t checksum;
+    struct {
+        uint8_t  stream_id;    // changes with every stream the master sends
+        int8_t   transaction_id;
+        uint16_t seq;          // chunk number, offset is seq * RPC_STREAM_CHUNK_SIZE
+        uint16_t total_length; // of the whole stream
+        uint8_t  data[RPC_STREAM_CHUNK_SIZE];
+    } payload;
+} rpc_stream_chunk_t;
+
+typedef struct _rpc_stream_ack_t {
+    uint8_t checksum;
+    struct {
+        uint8_t  stream_id; // identity of the stream being acknowledged, copied from its chunks
+        int8_t   transaction_id;
+        uint16_t total_length;
+        uint16_t next_seq; // every chunk before this one has been delivered
+    } payload;
+} rpc_stream_ack_t;
 #endif // defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 
 typedef struct _split_shared_memory_t {
@@ -140,6 +199,10 @@ typedef struct _split_shared_memory_t {
 
     split_slave_matrix_sync_t smatrix;
 
+#ifdef SPLIT_MATRIX_EVENTS_ENABLE
+    split_slave_events_sync_t slave_events;
+#endif // SPLIT_MATRIX_EVENTS_ENABLE
+
 #ifdef SPLIT_TRANSPORT_MIRROR
     split_master_matrix_sync_t mmatrix;
 #endif // SPLIT_TRANSPORT_MIRROR
@@ -192,6 +255,14 @@ typedef struct _split_shared_memory_t {
     uint8_t current_st7565_state;
 #endif // ST7565_ENABLE(OLED_ENABLE) && defined(SPLIT_ST7565_ENABLE)
 
+#if defined(CAPS_WORD_ENABLE) && defined(SPLIT_CAPS_WORD_ENABLE)
+    bool caps_word_state;
+#endif // defined(CAPS_WORD_ENABLE) && defined(SPLIT_CAPS_WORD_ENABLE)
+
+#ifdef SPLIT_USER_STATE_SIZE
+    uint8_t user_state[SPLIT_USER_STATE_SIZE];
+#endif // SPLIT_USER_STATE_SIZE
+
 #if defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
     split_slave_pointing_sync_t pointing;
 #endif // defined(POINTING_DEVICE_ENABLE) && defined(SPLIT_POINTING_ENABLE)
@@ -204,10 +275,22 @@ typedef struct _split_shared_memory_t {
     split_slave_haptic_sync_t haptic_sync;
 #endif // defined(HAPTIC_ENABLE)
 
+#ifdef SPLIT_TRANSPORT_BATCH
+    uint8_t batch_m2s[SPLIT_TRANSPORT_BATCH_SIZE];
+    uint8_t batch_s2m[SPLIT_TRANSPORT_BATCH_SIZE];
+#endif // SPLIT_TRANSPORT_BATCH
+
+#ifdef SPLIT_TRANSPORT_DELTA
+    uint8_t delta_m2s[SPLIT_TRANSPORT_DELTA_SIZE];
+    bool    delta_applied;
+#endif // SPLIT_TRANSPORT_DELTA
+
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
-    rpc_sync_info_t rpc_info;
-    uint8_t         rpc_m2s_buffer[RPC_M2S_BUFFER_SIZE];
-    uint8_t         rpc_s2m_buffer[RPC_S2M_BUFFER_SIZE];
+    rpc_sync_info_t    rpc_info;
+    uint8_t            rpc_m2s_buffer[RPC_M2S_BUFFER_SIZE];
+    uint8_t            rpc_s2m_buffer[RPC_S2M_BUFFER_SIZE];
+    rpc_stream_chunk_t rpc_stream_m2s;
+    rpc_stream_ack_t   rpc_stream_s2m;
 #endif // defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 } split_shared_memory_t;
 